@@ -0,0 +1,1223 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#endif
+
+#include "../include/cast.hpp"
+#include "../include/cell_store.hpp"
+#include "../include/cells.hpp"
+#include "../include/charset.hpp"
+#include "../include/export.hpp"
+#include "../include/image.hpp"
+#include "../include/kernels.hpp"
+#include "../include/kitty.hpp"
+#include "../include/png.hpp"
+#include "../include/pyramid.hpp"
+#include "../include/sixel.hpp"
+#include "../include/source.hpp"
+#include "../include/summed_area.hpp"
+
+using namespace std;
+
+// Deterministic 8-bit test image: gradients, a hard-edged checkerboard and some noise
+vector<uint8_t> make_test_pixels(size_t width, size_t height, size_t channels) {
+    vector<uint8_t> data(width * height * channels);
+    uint32_t seed = 12345;
+    for (size_t y = 0; y < height; y++) {
+        for (size_t x = 0; x < width; x++) {
+            seed = seed * 1664525u + 1013904223u;
+            double noise = (seed >> 24) / 255.0 * 0.1;
+            double checker = ((x / 97 + y / 89) % 2) ? 0.8 : 0.1;
+            uint8_t* pixel = &data[(y * width + x) * channels];
+            for (size_t c = 0; c < channels; c++) {
+                double gradient = c % 2 ? static_cast<double>(x) / width : static_cast<double>(y) / height;
+                pixel[c] = static_cast<uint8_t>(255 * min(1.0, 0.5 * gradient + 0.4 * checker + noise));
+            }
+        }
+    }
+    return data;
+}
+
+// Same pixels as load_image would produce them
+Image make_test_image(size_t width, size_t height, size_t channels) {
+    vector<uint8_t> pixels = make_test_pixels(width, height, channels);
+    vector<double> data(pixels.size());
+    for (size_t i = 0; i < pixels.size(); i++) {
+        data[i] = pixels[i] / 255.0;
+    }
+    return Image(width, height, channels, move(data));
+}
+
+ByteImage make_test_byte_image(size_t width, size_t height, size_t channels) {
+    auto pixels = make_shared<vector<uint8_t>>(make_test_pixels(width, height, channels));
+    return ByteImage(width, height, channels, pixels->data(), pixels);
+}
+
+// Reference QOI encoder, for decoder round trips
+vector<uint8_t> encode_qoi(const vector<uint8_t>& pixels, size_t width, size_t height, size_t channels) {
+    vector<uint8_t> out = {'q', 'o', 'i', 'f'};
+    for (uint32_t value : {static_cast<uint32_t>(width), static_cast<uint32_t>(height)}) {
+        out.insert(out.end(), {uint8_t(value >> 24), uint8_t(value >> 16), uint8_t(value >> 8), uint8_t(value)});
+    }
+    out.insert(out.end(), {uint8_t(channels), 0});
+
+    uint8_t index[64][4] = {};
+    uint8_t previous[4] = {0, 0, 0, 255};
+    size_t run = 0;
+    for (size_t i = 0; i < width * height; i++) {
+        uint8_t pixel[4] = {0, 0, 0, 255};
+        memcpy(pixel, &pixels[i * channels], channels);
+        if (memcmp(pixel, previous, 4) == 0) {
+            if (++run == 62 || i == width * height - 1) {
+                out.push_back(uint8_t(0xc0 | (run - 1)));
+                run = 0;
+            }
+            continue;
+        }
+        if (run > 0) {
+            out.push_back(uint8_t(0xc0 | (run - 1)));
+            run = 0;
+        }
+
+        size_t hash = (pixel[0] * 3 + pixel[1] * 5 + pixel[2] * 7 + pixel[3] * 11) % 64;
+        int8_t dr = int8_t(pixel[0] - previous[0]), dg = int8_t(pixel[1] - previous[1]), db = int8_t(pixel[2] - previous[2]);
+        if (memcmp(index[hash], pixel, 4) == 0) {
+            out.push_back(uint8_t(hash));
+        } else if (pixel[3] != previous[3]) {
+            out.insert(out.end(), {0xff, pixel[0], pixel[1], pixel[2], pixel[3]});
+        } else if (dr >= -2 && dr <= 1 && dg >= -2 && dg <= 1 && db >= -2 && db <= 1) {
+            out.push_back(uint8_t(0x40 | (dr + 2) << 4 | (dg + 2) << 2 | (db + 2)));
+        } else if (dg >= -32 && dg <= 31 && dr - dg >= -8 && dr - dg <= 7 && db - dg >= -8 && db - dg <= 7) {
+            out.insert(out.end(), {uint8_t(0x80 | (dg + 32)), uint8_t((dr - dg + 8) << 4 | (db - dg + 8))});
+        } else {
+            out.insert(out.end(), {0xfe, pixel[0], pixel[1], pixel[2]});
+        }
+        memcpy(index[hash], pixel, 4);
+        memcpy(previous, pixel, 4);
+    }
+    out.insert(out.end(), {0, 0, 0, 0, 0, 0, 0, 1});
+    return out;
+}
+
+template <typename F>
+double time_ms(size_t iterations, F run) {
+    auto start = chrono::steady_clock::now();
+    for (size_t i = 0; i < iterations; i++) {
+        run();
+    }
+    chrono::duration<double, milli> elapsed = chrono::steady_clock::now() - start;
+    return elapsed.count() / iterations;
+}
+
+bool same_cells(const CellGrid& a, const CellGrid& b) {
+    return a.cells.size() == b.cells.size() && memcmp(a.cells.data(), b.cells.data(), a.cells.size() * sizeof(Cell)) == 0;
+}
+
+// Mean absolute difference of the colors of two grids averaged over 4x4 blocks of cells,
+// roughly the color the eye sees from a distance, out of 255
+double get_block_error(const CellGrid& a, const CellGrid& b) {
+    double total = 0.0;
+    size_t n_blocks = 0;
+    for (size_t y = 0; y + 4 <= a.height; y += 4) {
+        for (size_t x = 0; x + 4 <= a.width; x += 4) {
+            int difference[3] = {0, 0, 0};
+            for (size_t j = y; j < y + 4; j++) {
+                for (size_t i = x; i < x + 4; i++) {
+                    difference[0] += a.at(i, j).r - b.at(i, j).r;
+                    difference[1] += a.at(i, j).g - b.at(i, j).g;
+                    difference[2] += a.at(i, j).b - b.at(i, j).b;
+                }
+            }
+            total += (abs(difference[0]) + abs(difference[1]) + abs(difference[2])) / 48.0;
+            n_blocks++;
+        }
+    }
+    return n_blocks ? total / n_blocks : 0.0;
+}
+
+// Minimal sixel decoder for round trips: RGB pixels of the image, and how many times
+// each was drawn, which must be exactly once. Palette entries are in percent.
+vector<uint8_t> decode_sixel(const string& sixel, size_t& width, size_t& height, vector<uint8_t>& draws) {
+    size_t i = sixel.find('"');
+    unsigned w = 0, h = 0;
+    if (i == string::npos || sscanf(sixel.c_str() + i, "\"1;1;%u;%u", &w, &h) != 2) {
+        return {};
+    }
+    width = w;
+    height = h;
+    vector<uint8_t> pixels(width * height * 3, 0);
+    draws.assign(width * height, 0);
+
+    vector<uint8_t> palette(256 * 3, 0);
+    size_t entry = 0, x = 0, y = 0;
+    auto read_number = [&] {
+        size_t value = 0;
+        while (i < sixel.size() && isdigit(static_cast<unsigned char>(sixel[i]))) {
+            value = value * 10 + (sixel[i++] - '0');
+        }
+        return value;
+    };
+    auto draw = [&](int bits, size_t n) {
+        for (size_t k = 0; k < n; k++, x++) {
+            for (size_t r = 0; r < 6; r++) {
+                if ((bits >> r & 1) && x < width && y + r < height) {
+                    size_t p = (y + r) * width + x;
+                    copy_n(&palette[entry * 3], 3, &pixels[p * 3]);
+                    draws[p]++;
+                }
+            }
+        }
+    };
+    for (i = sixel.find('#'); i < sixel.size() && sixel[i] != '\x1b';) {
+        char c = sixel[i++];
+        if (c == '#') {
+            entry = read_number() & 255;
+            if (sixel.compare(i, 3, ";2;") == 0) {
+                i += 3;
+                for (size_t k = 0; k < 3; k++) {
+                    palette[entry * 3 + k] = static_cast<uint8_t>((read_number() * 255 + 50) / 100);
+                    i += k < 2 ? 1 : 0;
+                }
+            }
+        } else if (c == '!') {
+            size_t n = read_number();
+            draw(sixel[i++] - '?', n);
+        } else if (c == '$') {
+            x = 0;
+        } else if (c == '-') {
+            x = 0;
+            y += 6;
+        } else if (c >= '?' && c <= '~') {
+            draw(c - '?', 1);
+        }
+    }
+    return pixels;
+}
+
+// Payloads of the kitty graphics escapes in `escapes`, base64 decoded and joined
+vector<uint8_t> decode_kitty_payload(const string& escapes) {
+    static const string digits = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    vector<uint8_t> bytes;
+    for (size_t start = escapes.find("\x1b_G"); start != string::npos; start = escapes.find("\x1b_G", start + 1)) {
+        size_t i = escapes.find(';', start) + 1;
+        size_t end = escapes.find('\x1b', i);
+        uint32_t group = 0;
+        size_t n_bits = 0;
+        for (; i < end && escapes[i] != '='; i++) {
+            group = (group << 6) | static_cast<uint32_t>(digits.find(escapes[i]));
+            n_bits += 6;
+            if (n_bits >= 8) {
+                n_bits -= 8;
+                bytes.push_back(static_cast<uint8_t>(group >> n_bits));
+            }
+        }
+    }
+    return bytes;
+}
+
+int main(int argc, char* argv[]) {
+    size_t iterations = argc > 1 ? static_cast<size_t>(atoi(argv[1])) : 5;
+    bool ok = true;
+
+    struct Case {
+        const char* name;
+        size_t width, height, channels;
+        double edge_threshold;
+        ColorMode color_mode;
+    };
+    const Case cases[] = {
+        {"rgb 4000x3000", 4000, 3000, 3, 4.0, COLOR_TRUECOLOR},
+        {"rgb 4000x3000 edges", 4000, 3000, 3, 1.0, COLOR_TRUECOLOR},
+        {"rgb 4000x3000 retro", 4000, 3000, 3, 4.0, COLOR_RETRO},
+        {"gray 4000x3000 edges", 4000, 3000, 1, 1.0, COLOR_TRUECOLOR},
+    };
+
+    cout << "analyze_cells by isa, 200x100 cells, " << iterations << " iterations (detected isa: " << get_isa_name(detect_isa()) << ")\n";
+    for (const Case& test : cases) {
+        Image image = make_test_image(test.width, test.height, test.channels);
+
+        AnalysisOptions options;
+        options.edge_threshold = test.edge_threshold;
+        options.color_mode = test.color_mode;
+
+        // Scalar reference for cross-checking
+        options.isa = ISA_SCALAR;
+        CellGrid reference = analyze_cells(image, 200, 100, options);
+        double scalar_ms = time_ms(iterations, [&] { analyze_cells(image, 200, 100, options); });
+
+        for (Isa isa : {ISA_SCALAR, ISA_SSE2, ISA_AVX2, ISA_AVX512}) {
+            if (!is_isa_supported(isa)) {
+                continue;
+            }
+            options.isa = isa;
+            CellGrid grid = analyze_cells(image, 200, 100, options);
+            double ms = isa == ISA_SCALAR ? scalar_ms : time_ms(iterations, [&] { analyze_cells(image, 200, 100, options); });
+            bool match = same_cells(grid, reference);
+            ok = ok && match;
+
+            cout << "  " << left << setw(24) << test.name << setw(8) << get_isa_name(isa) << right << fixed << setprecision(2) << setw(9) << ms << " ms  x" << setw(5)
+                 << scalar_ms / ms << (match ? "" : "  MISMATCH") << "\n";
+        }
+    }
+
+    // Every compile-time variant of the row loop: channel layout x color mode x edges
+    const char* layout_names[] = {"gray", "gray+alpha", "rgb", "rgba"};
+    const char* color_names[] = {"truecolor", "retro"};
+
+    cout << "\nanalyze_cells variants, 1600x1200 -> 200x100 cells, isa " << get_isa_name(detect_isa()) << "\n";
+    for (size_t channels = 1; channels <= MAX_CHANNELS; channels++) {
+        Image image = make_test_image(1600, 1200, channels);
+        for (int color_mode = 0; color_mode < N_COLOR_MODES; color_mode++) {
+            for (bool edges : {false, true}) {
+                AnalysisOptions options;
+                options.edge_threshold = edges ? 1.0 : 4.0;
+                options.color_mode = static_cast<ColorMode>(color_mode);
+
+                options.isa = ISA_SCALAR;
+                CellGrid reference = analyze_cells(image, 200, 100, options);
+                options.isa = ISA_AUTO;
+                CellGrid grid = analyze_cells(image, 200, 100, options);
+                double ms = time_ms(iterations, [&] { analyze_cells(image, 200, 100, options); });
+                bool match = same_cells(grid, reference);
+                ok = ok && match;
+
+                string name = string(layout_names[channels - 1]) + " " + color_names[color_mode] + (edges ? " edges" : "");
+                cout << "  " << left << setw(32) << name << right << fixed << setprecision(2) << setw(9) << ms << " ms" << (match ? "" : "  MISMATCH") << "\n";
+            }
+        }
+    }
+
+    // Fixed-point against double: glyphs may only differ on exact bucket ties, where
+    // the double path lands on either side, and colors must stay within +-1
+    cout << "\nfixed-point vs double, 4000x3000 -> 200x100 cells, isa " << get_isa_name(detect_isa()) << "\n";
+    for (size_t channels = 1; channels <= MAX_CHANNELS; channels++) {
+        Image image = make_test_image(4000, 3000, channels);
+        ByteImage bytes = make_test_byte_image(4000, 3000, channels);
+        for (int color_mode = 0; color_mode < N_COLOR_MODES; color_mode++) {
+            AnalysisOptions options;
+            options.edge_threshold = 1.0;
+            options.color_mode = static_cast<ColorMode>(color_mode);
+
+            CellGrid reference = analyze_cells(image, 200, 100, options);
+            CellGrid grid = analyze_cells(bytes, 200, 100, options);
+            double double_ms = time_ms(iterations, [&] { analyze_cells(image, 200, 100, options); });
+            double fixed_ms = time_ms(iterations, [&] { analyze_cells(bytes, 200, 100, options); });
+
+            size_t glyph_mismatches = 0, edge_mismatches = 0;
+            int max_color_diff = 0, max_glyph_diff = 0;
+            for (size_t i = 0; i < grid.cells.size(); i++) {
+                const Cell& a = reference.cells[i];
+                const Cell& b = grid.cells[i];
+                glyph_mismatches += a.glyph_class != b.glyph_class;
+                max_glyph_diff = max(max_glyph_diff, abs(int(a.glyph_class) - b.glyph_class));
+                edge_mismatches += a.edge_dir != b.edge_dir;
+                max_color_diff = max({max_color_diff, abs(int(a.r) - b.r), abs(int(a.g) - b.g), abs(int(a.b) - b.b)});
+            }
+            bool match = max_glyph_diff <= 1 && max_color_diff <= 1;
+            ok = ok && match;
+
+            string name = string(layout_names[channels - 1]) + " " + color_names[color_mode] + " edges";
+            cout << "  " << left << setw(32) << name << right << fixed << setprecision(2) << setw(9) << double_ms << " ms double" << setw(9) << fixed_ms
+                 << " ms fixed  x" << setw(5) << double_ms / fixed_ms << "  glyph ties " << glyph_mismatches << ", edges " << edge_mismatches << ", color +-"
+                 << max_color_diff << (match ? "" : "  MISMATCH") << "\n";
+        }
+    }
+
+    // Tiled fixed-point analysis of a streamed PPM: every thread count and memory budget
+    // must reproduce the single-threaded in-memory grid exactly
+    cout << "\ntiled fixed-point, streamed 4000x3000 ppm -> 200x100 cells, isa " << get_isa_name(detect_isa()) << "\n";
+    {
+        const char* ppm_path = "bench_tiles.ppm";
+        vector<uint8_t> pixels = make_test_pixels(4000, 3000, 3);
+        FILE* file = fopen(ppm_path, "wb");
+        if (!file) {
+            cerr << "Error: Cannot write " << ppm_path << endl;
+            return 1;
+        }
+        fprintf(file, "P6\n4000 3000\n255\n");
+        fwrite(pixels.data(), 1, pixels.size(), file);
+        fclose(file);
+
+        AnalysisOptions options;
+        options.edge_threshold = 1.0;
+        options.threads = 1;
+        CellGrid reference = analyze_cells(make_test_byte_image(4000, 3000, 3), 200, 100, options);
+
+        for (size_t budget : {0, 64 << 20, 4 << 20}) {
+            for (size_t threads : {1, 2, 4}) {
+                options.threads = threads;
+                options.memory_budget = budget;
+
+                CellGrid grid;
+                double ms = time_ms(iterations, [&] {
+                    unique_ptr<RowSource> source = open_row_source(ppm_path);
+                    grid = analyze_cells(*source, 200, 100, options);
+                });
+                bool match = same_cells(grid, reference);
+                ok = ok && match;
+
+                string name = (budget ? "budget " + to_string(budget >> 20) + "M" : string("unlimited")) + ", " + to_string(threads) + " threads";
+                cout << "  " << left << setw(32) << name << right << fixed << setprecision(2) << setw(9) << ms << " ms" << (match ? "" : "  MISMATCH") << "\n";
+            }
+        }
+        remove(ppm_path);
+    }
+
+    // Live view re-renders from a summed-area table: cost follows the cell count, and
+    // the cells must equal a full pass over the pixels
+    cout << "\nsummed-area re-render, 4000x3000 rgb, isa " << get_isa_name(detect_isa()) << "\n";
+    {
+        ByteImage image = make_test_byte_image(4000, 3000, 3);
+        ImageRowSource source(image);
+        AnalysisOptions options;
+        options.edge_threshold = 1.0;
+
+        SummedAreaTable table;
+        double build_ms = time_ms(1, [&] { table = build_summed_area_table(source, options); });
+        cout << "  " << left << setw(32) << "build table" << right << fixed << setprecision(2) << setw(9) << build_ms << " ms\n";
+
+        for (size_t columns : {80, 200, 400}) {
+            size_t rows = columns / 2;
+            CellGrid reference = analyze_cells(image, columns, rows, options);
+            CellGrid grid = analyze_cells(table, columns, rows, options);
+            double full_ms = time_ms(iterations, [&] { analyze_cells(image, columns, rows, options); });
+            double table_ms = time_ms(iterations, [&] { analyze_cells(table, columns, rows, options); });
+            bool match = same_cells(grid, reference);
+            ok = ok && match;
+
+            string name = to_string(columns) + "x" + to_string(rows) + " cells";
+            cout << "  " << left << setw(32) << name << right << fixed << setprecision(2) << setw(9) << full_ms << " ms full" << setw(9) << table_ms << " ms table  x"
+                 << setw(6) << full_ms / table_ms << (match ? "" : "  MISMATCH") << "\n";
+        }
+    }
+
+    // Viewer: pyramid build, then tiles of a cell lattice. A lattice that divides the image
+    // evenly must match a whole-image pass, and tiles must join without seams.
+    cout << "\nviewer pyramid and tiles, 4000x3000 rgb, isa " << get_isa_name(detect_isa()) << "\n";
+    {
+        ByteImage image = make_test_byte_image(4000, 3000, 3);
+        double build_ms = time_ms(1, [&] {
+            Pyramid pyramid(image);
+            pyramid.wait();
+        });
+        cout << "  " << left << setw(32) << "build pyramid" << right << fixed << setprecision(2) << setw(9) << build_ms << " ms\n";
+
+        AnalysisOptions options;
+        options.edge_threshold = 1.0;
+        CellWindow window;
+        window.width = 200;
+        window.height = 100;
+        window.cell_width = 20;
+        window.cell_height = 30;
+        CellGrid whole = analyze_window(image, window, options);
+        bool match = same_cells(whole, analyze_cells(image, 200, 100, options));
+
+        // Same cells again as 32x16 tiles
+        window.width = 32;
+        window.height = 16;
+        double tile_ms = time_ms(iterations, [&] { analyze_window(image, window, options); });
+        for (window.y = 0; window.y < 100; window.y += window.height) {
+            for (window.x = 0; window.x < 200; window.x += window.width) {
+                CellGrid tile = analyze_window(image, window, options);
+                for (size_t j = 0; j < window.height && window.y + j < 100; j++) {
+                    for (size_t i = 0; i < window.width && window.x + i < 200; i++) {
+                        match = match && memcmp(&tile.at(i, j), &whole.at(window.x + i, window.y + j), sizeof(Cell)) == 0;
+                    }
+                }
+            }
+        }
+        ok = ok && match;
+
+        cout << "  " << left << setw(32) << "32x16 tile of 20x30 cells" << right << fixed << setprecision(2) << setw(9) << tile_ms << " ms" << (match ? "" : "  MISMATCH") << "\n";
+    }
+
+    // EXIF orientation: folded into the box sums (and the summed-area lookups) it must match
+    // analyzing an upright copy exactly, at no cost over the stored orientation
+    cout << "\norientation, 4000x3000 rgb -> 200x100 cells, isa " << get_isa_name(detect_isa()) << "\n";
+    {
+        ByteImage image = make_test_byte_image(4000, 3000, 3);
+        AnalysisOptions options;
+        options.edge_threshold = 1.0;
+
+        for (int orientation = 1; orientation <= 8; orientation++) {
+            ImageRowSource source(image, orientation);
+            ByteImage upright;
+            double copy_ms = time_ms(iterations, [&] { upright = make_oriented(image, orientation); });
+            CellGrid reference = analyze_cells(upright, 200, 100, options);
+
+            CellGrid grid = analyze_cells(source, 200, 100, options);
+            double folded_ms = time_ms(iterations, [&] { analyze_cells(source, 200, 100, options); });
+            SummedAreaTable table = build_summed_area_table(source, options);
+            bool match = same_cells(grid, reference) && same_cells(analyze_cells(table, 200, 100, options), reference);
+            ok = ok && match;
+
+            string name = "orientation " + to_string(orientation);
+            cout << "  " << left << setw(32) << name << right << fixed << setprecision(2) << setw(9) << folded_ms << " ms folded" << setw(9) << copy_ms
+                 << " ms upright copy" << (match ? "" : "  MISMATCH") << "\n";
+        }
+    }
+
+    // Alpha: compositing is fused into every fixed-point path, so each must match analyzing
+    // an opaque copy composited up front, without paying for that full-resolution copy
+    for (size_t channels : {2, 4}) {
+        string layout = channels == 2 ? "gray+alpha" : "rgba";
+        cout << "\nalpha over a background, 4000x3000 " << layout << " -> 200x100 cells, isa " << get_isa_name(detect_isa()) << "\n";
+        ByteImage image = make_test_byte_image(4000, 3000, channels);
+        AnalysisOptions options;
+        options.edge_threshold = 1.0;
+        options.background[0] = 18;
+        options.background[1] = 52;
+        options.background[2] = 86;
+
+        for (Isa isa : {ISA_SCALAR, ISA_SSE2, ISA_AVX2, ISA_AVX512}) {
+            if (!is_isa_supported(isa)) {
+                continue;
+            }
+            options.isa = isa;
+            ByteImage opaque = make_composited(image, options);
+            CellGrid reference = analyze_cells(opaque, 200, 100, options);
+
+            ImageRowSource source(image);
+            CellGrid grid = analyze_cells(image, 200, 100, options);
+            bool match = same_cells(grid, reference) && same_cells(analyze_cells(build_summed_area_table(source, options), 200, 100, options), reference);
+
+            CellWindow window;
+            window.width = 200;
+            window.height = 100;
+            window.cell_width = 20;
+            window.cell_height = 30;
+            match = match && same_cells(analyze_window(image, window, options), reference);
+            ok = ok && match;
+
+            double composited_ms = time_ms(iterations, [&] { analyze_cells(image, 200, 100, options); });
+            double copy_ms = time_ms(iterations, [&] { analyze_cells(make_composited(image, options), 200, 100, options); });
+            cout << "  " << left << setw(32) << get_isa_name(isa) << right << fixed << setprecision(2) << setw(9) << composited_ms << " ms fused" << setw(9) << copy_ms
+                 << " ms composited copy" << (match ? "" : "  MISMATCH") << "\n";
+        }
+    }
+
+    // Linear light: the lookup tables fold into the accumulate and shade phases, which must
+    // cost under 10% more than sRGB averaging and agree with the double path and every ISA
+    cout << "\nlinear light vs sRGB, 4000x3000 -> 200x100 cells, isa " << get_isa_name(detect_isa()) << "\n";
+    for (size_t channels : {1, 3}) {
+        Image image = make_test_image(4000, 3000, channels);
+        ByteImage bytes = make_test_byte_image(4000, 3000, channels);
+        AnalysisOptions options;
+        options.edge_threshold = 1.0;
+
+        double srgb_ms = time_ms(iterations, [&] { analyze_cells(bytes, 200, 100, options); });
+        options.linear_light = true;
+        options.isa = ISA_SCALAR;
+        CellGrid reference = analyze_cells(bytes, 200, 100, options);
+        options.isa = ISA_AUTO;
+        CellGrid grid = analyze_cells(bytes, 200, 100, options);
+        double linear_ms = time_ms(iterations, [&] { analyze_cells(bytes, 200, 100, options); });
+
+        CellWindow window;
+        window.width = 200;
+        window.height = 100;
+        window.cell_width = 20;
+        window.cell_height = 30;
+        ImageRowSource source(bytes);
+        bool match = same_cells(grid, reference) && same_cells(analyze_cells(build_summed_area_table(source, options), 200, 100, options), reference) &&
+                     same_cells(analyze_window(bytes, window, options), reference);
+
+        // The double path converts exactly, the fixed one through 12-bit linear light
+        CellGrid exact = analyze_cells(image, 200, 100, options);
+        int max_color_diff = 0, max_glyph_diff = 0;
+        for (size_t i = 0; i < grid.cells.size(); i++) {
+            const Cell& a = exact.cells[i];
+            const Cell& b = grid.cells[i];
+            max_glyph_diff = max(max_glyph_diff, abs(int(a.glyph_class) - b.glyph_class));
+            max_color_diff = max({max_color_diff, abs(int(a.r) - b.r), abs(int(a.g) - b.g), abs(int(a.b) - b.b)});
+        }
+        match = match && max_glyph_diff <= 1 && max_color_diff <= 1;
+        ok = ok && match;
+
+        cout << "  " << left << setw(32) << layout_names[channels - 1] << right << fixed << setprecision(2) << setw(9) << linear_ms << " ms linear" << setw(9) << srgb_ms
+             << " ms sRGB  " << showpos << setprecision(1) << setw(6) << 100.0 * (linear_ms / srgb_ms - 1.0) << noshowpos << "%  vs double: glyph +-" << max_glyph_diff << ", color +-"
+             << max_color_diff << (match ? "" : "  MISMATCH") << "\n";
+    }
+
+    // Native decoders feed rows straight into the analysis: raw 8-bit rows are used in
+    // place from the mapped file, so their cost should approach an in-memory image
+    cout << "\nnative decoders, 4000x3000 rgb -> 200x100 cells, isa " << get_isa_name(detect_isa()) << "\n";
+    {
+        const size_t width = 4000, height = 3000;
+        vector<uint8_t> pixels = make_test_pixels(width, height, 3);
+        ByteImage bytes = make_test_byte_image(width, height, 3);
+        AnalysisOptions options;
+        options.edge_threshold = 1.0;
+        CellGrid reference = analyze_cells(bytes, 200, 100, options);
+        double memory_ms = time_ms(iterations, [&] { analyze_cells(bytes, 200, 100, options); });
+        cout << "  " << left << setw(32) << "in memory" << right << fixed << setprecision(2) << setw(9) << memory_ms << " ms" << setprecision(0) << setw(7)
+             << pixels.size() / 1e3 / memory_ms << " MB/s of pixels\n";
+
+        // Same pixels in each format; Farbfeld adds an opaque alpha channel
+        string header = "P6\n" + to_string(width) + " " + to_string(height) + "\n";
+        vector<uint8_t> ppm(header.begin(), header.end()), ppm16(ppm), farbfeld = {'f', 'a', 'r', 'b', 'f', 'e', 'l', 'd'};
+        ppm.insert(ppm.end(), {'2', '5', '5', '\n'});
+        ppm.insert(ppm.end(), pixels.begin(), pixels.end());
+        ppm16.insert(ppm16.end(), {'6', '5', '5', '3', '5', '\n'});
+        for (uint32_t value : {static_cast<uint32_t>(width), static_cast<uint32_t>(height)}) {
+            farbfeld.insert(farbfeld.end(), {uint8_t(value >> 24), uint8_t(value >> 16), uint8_t(value >> 8), uint8_t(value)});
+        }
+        for (size_t i = 0; i < pixels.size(); i++) {
+            ppm16.insert(ppm16.end(), {pixels[i], pixels[i]});
+            farbfeld.insert(farbfeld.end(), {pixels[i], pixels[i]});
+            if (i % 3 == 2) {
+                farbfeld.insert(farbfeld.end(), {0xff, 0xff});
+            }
+        }
+
+        struct Format {
+            const char* name;
+            const char* path;
+            vector<uint8_t> file;
+        };
+        Format formats[] = {
+            {"ppm, mapped in place", "bench_decode.ppm", move(ppm)},
+            {"ppm 16-bit", "bench_decode16.ppm", move(ppm16)},
+            {"farbfeld", "bench_decode.ff", move(farbfeld)},
+            {"qoi", "bench_decode.qoi", encode_qoi(pixels, width, height, 3)},
+        };
+        for (const Format& format : formats) {
+            FILE* file = fopen(format.path, "wb");
+            if (!file) {
+                cerr << "Error: Cannot write " << format.path << endl;
+                return 1;
+            }
+            fwrite(format.file.data(), 1, format.file.size(), file);
+            fclose(file);
+
+            CellGrid grid;
+            double ms = time_ms(iterations, [&] {
+                unique_ptr<RowSource> source = open_row_source(format.path);
+                grid = source ? analyze_cells(*source, 200, 100, options) : CellGrid();
+            });
+            bool match = same_cells(grid, reference) && same_cells(analyze_cells(read_byte_image(open_row_source(format.path)), 200, 100, options), reference);
+            ok = ok && match;
+
+            cout << "  " << left << setw(32) << format.name << right << fixed << setprecision(2) << setw(9) << ms << " ms" << setprecision(0) << setw(7)
+                 << pixels.size() / 1e3 / ms << " MB/s of pixels, file " << setw(4) << (format.file.size() >> 20) << "M" << (match ? "" : "  MISMATCH") << "\n";
+            remove(format.path);
+        }
+
+        // Headers whose sizes overflow, or pass the formats' limits, open no source at all
+        string huge_ppm = "P6\n6148914691236517206 1\n255\nab", huge_pgm = "P5\n9223372036854775809 2\n255\nab";
+        vector<uint8_t> huge_farbfeld = {'f', 'a', 'r', 'b', 'f', 'e', 'l', 'd', 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 'a', 'b'};
+        vector<uint8_t> huge_qoi = encode_qoi(vector<uint8_t>(4, 0), 1, 1, 4), large_qoi = huge_qoi;
+        huge_qoi[4] = huge_qoi[8] = 0x80;  // 0x80000000 x 0x80000000
+        large_qoi[5] = large_qoi[9] = 0x01;  // 65537 x 65537, past 400M pixels
+        Format malformed[] = {
+            {"ppm", "bench_huge.ppm", vector<uint8_t>(huge_ppm.begin(), huge_ppm.end())},
+            {"pgm", "bench_huge.pgm", vector<uint8_t>(huge_pgm.begin(), huge_pgm.end())},
+            {"farbfeld", "bench_huge.ff", huge_farbfeld},
+            {"qoi", "bench_huge.qoi", huge_qoi},
+            {"qoi", "bench_large.qoi", large_qoi},
+        };
+        bool rejected = true;
+        for (const Format& format : malformed) {
+            FILE* file = fopen(format.path, "wb");
+            fwrite(format.file.data(), 1, format.file.size(), file);
+            fclose(file);
+            rejected = !open_row_source(format.path) && rejected;
+            remove(format.path);
+        }
+        ok = ok && rejected;
+        cout << "  " << left << setw(32) << "oversized headers rejected" << right << (rejected ? "" : "  MISMATCH") << "\n";
+    }
+
+    cout << "\ncustom charset, 4000x3000 rgb -> 200x100 cells, isa " << get_isa_name(detect_isa()) << "\n";
+    {
+        // Every printable ASCII character, and the shading blocks
+        string ascii;
+        for (char c = ' '; c <= '~'; c++) {
+            ascii.push_back(c);
+        }
+        const char* sets[] = {ascii.c_str(), " \u2591\u2592\u2593\u2588"};
+
+        Image image = make_test_image(4000, 3000, 3);
+        ByteImage bytes = make_test_byte_image(4000, 3000, 3);
+        for (const char* text : sets) {
+            Charset charset;
+            double build_ms = time_ms(iterations, [&] { make_charset(text, charset); });
+
+            // Levels never step back to a lighter glyph
+            bool match = is_sorted(charset.levels, charset.levels + N_BRIGHTNESS_LEVELS) && charset.levels[N_BRIGHTNESS_LEVELS - 1] + 1u == charset.glyphs.size();
+
+            AnalysisOptions options;
+            options.edge_threshold = 1.0;
+            options.charset = &charset;
+            options.isa = ISA_SCALAR;
+            CellGrid reference = analyze_cells(image, 200, 100, options);
+            options.isa = ISA_AUTO;
+            match = match && same_cells(analyze_cells(image, 200, 100, options), reference);
+
+            // Fixed-point lands on the same level except at exact ties, so glyphs may only
+            // differ by one step of the ramp the levels reach; glyphs of equal coverage are skipped
+            vector<int> step(charset.glyphs.size(), 0);
+            for (size_t level = 1; level < N_BRIGHTNESS_LEVELS; level++) {
+                step[charset.levels[level]] = step[charset.levels[level - 1]] + (charset.levels[level] != charset.levels[level - 1]);
+            }
+            CellGrid grid = analyze_cells(bytes, 200, 100, options);
+            for (size_t i = 0; i < grid.cells.size(); i++) {
+                match = match && abs(step[reference.cells[i].glyph_class] - step[grid.cells[i].glyph_class]) <= 1;
+            }
+            double fixed_ms = time_ms(iterations, [&] { analyze_cells(bytes, 200, 100, options); });
+            ok = ok && match;
+
+            cout << "  " << left << setw(32) << (to_string(charset.glyphs.size()) + " glyphs") << right << fixed << setprecision(4) << setw(9) << build_ms << " ms to build"
+                 << setprecision(2) << setw(9) << fixed_ms << " ms fixed-point" << (match ? "" : "  MISMATCH") << "\n";
+        }
+    }
+
+    cout << "\nshape matching, 95 printable ASCII glyphs\n";
+    {
+        string ascii;
+        for (char c = ' '; c <= '~'; c++) {
+            ascii.push_back(c);
+        }
+        Charset charset;
+        make_charset(ascii, charset);
+
+        // Matching alone, over masks that are half glyphs, half noise
+        const size_t n_masks = 100000;
+        vector<uint64_t> masks(2 * n_masks);
+        uint64_t seed = 12345;
+        for (size_t i = 0; i < n_masks; i++) {
+            for (size_t w = 0; w < 2; w++) {
+                seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+                masks[2 * i + w] = i % 2 ? seed : charset.shapes[w * charset.glyphs.size() + i % charset.glyphs.size()] ^ (seed & (seed >> 7) & (seed >> 13));
+            }
+        }
+        vector<uint8_t> reference(n_masks), glyphs(n_masks);
+        get_kernels(ISA_SCALAR).match_glyphs(masks.data(), n_masks, charset.shapes.data(), charset.glyphs.size(), reference.data());
+        for (Isa isa : {ISA_SCALAR, ISA_SSE2, ISA_AVX2, ISA_AVX512}) {
+            if (!is_isa_supported(isa)) {
+                continue;
+            }
+            const Kernels& kernels = get_kernels(isa);
+            double ms = time_ms(iterations, [&] { kernels.match_glyphs(masks.data(), n_masks, charset.shapes.data(), charset.glyphs.size(), glyphs.data()); });
+            bool match = glyphs == reference;
+            ok = ok && match;
+            cout << "  " << left << setw(32) << (string("match_glyphs ") + get_isa_name(isa)) << right << fixed << setprecision(2) << setw(9) << ms << " ms" << setprecision(1) << setw(7)
+                 << n_masks / 1e3 / ms << " M cells/s" << (match ? "" : "  MISMATCH") << "\n";
+        }
+
+        // Sampling, thresholding and matching from the pixels, on top of the analysis
+        struct Frame {
+            const char* name;
+            size_t width, height, columns, rows;
+        };
+        const Frame frames[] = {{"1920x1080 -> 240x68 cells", 1920, 1080, 240, 68}, {"4000x3000 -> 200x100 cells", 4000, 3000, 200, 100}};
+        for (const Frame& frame : frames) {
+            ByteImage bytes = make_test_byte_image(frame.width, frame.height, 3);
+            AnalysisOptions options;
+            options.charset = &charset;
+            options.isa = ISA_SCALAR;
+            CellGrid reference_cells = analyze_cells(bytes, frame.columns, frame.rows, options);
+            match_shapes(bytes, options, reference_cells);
+            options.isa = ISA_AUTO;
+            CellGrid cells = analyze_cells(bytes, frame.columns, frame.rows, options);
+            double ms = time_ms(iterations, [&] { match_shapes(bytes, options, cells); });
+            bool match = same_cells(cells, reference_cells);
+            ok = ok && match;
+            cout << "  " << left << setw(32) << frame.name << right << fixed << setprecision(2) << setw(9) << ms << " ms" << setprecision(1) << setw(7)
+                 << frame.columns * frame.rows / 1e3 / ms << " M cells/s" << (match ? "" : "  MISMATCH") << "\n";
+        }
+    }
+
+    cout << "\ndithering, 1920x1080 RGB -> 480x135 cells\n";
+    {
+        // Every palette color must map back to itself, or printing would change it
+        for (Palette palette : {PALETTE_8, PALETTE_16, PALETTE_256}) {
+            for (size_t index = palette == PALETTE_256 ? 16 : 0; index < get_palette_size(palette); index++) {
+                uint8_t rgb[3], nearest[3];
+                get_palette_rgb(palette, static_cast<uint8_t>(index), rgb);
+                get_palette_rgb(palette, get_nearest_palette_index(palette, rgb[0], rgb[1], rgb[2]), nearest);
+                if (memcmp(rgb, nearest, 3) != 0) {
+                    cout << "  palette of " << get_palette_size(palette) << " colors, entry " << index << "  MISMATCH\n";
+                    ok = false;
+                }
+            }
+        }
+
+        AnalysisOptions options;
+        const CellGrid truecolor = analyze_cells(make_test_byte_image(1920, 1080, 3), 480, 135, options);
+        const char* dither_names[] = {"nearest", "bayer", "floyd-steinberg"};
+        for (Palette palette : {PALETTE_8, PALETTE_16, PALETTE_256}) {
+            for (Dither dither : {DITHER_NONE, DITHER_BAYER, DITHER_FLOYD_STEINBERG}) {
+                options.palette = palette;
+                options.dither = dither;
+                options.threads = 1;
+                CellGrid reference = truecolor;
+                dither_cells(options, reference);
+                CellGrid cells;
+                double ms = time_ms(iterations, [&] {
+                    cells = truecolor;
+                    dither_cells(options, cells);
+                });
+
+                // Workers must not change the result
+                options.threads = 4;
+                CellGrid threaded = truecolor;
+                dither_cells(options, threaded);
+                bool match = same_cells(cells, reference) && same_cells(threaded, reference);
+                ok = ok && match;
+
+                string name = to_string(get_palette_size(palette)) + " colors " + dither_names[dither];
+                cout << "  " << left << setw(32) << name << right << fixed << setprecision(2) << setw(9) << ms << " ms" << setprecision(1) << setw(7)
+                     << get_block_error(reference, truecolor) << " block error" << (match ? "" : "  MISMATCH") << "\n";
+            }
+        }
+    }
+
+    cout << "\nexport, 1600x800 RGB -> 400x200 cells\n";
+    {
+        AnalysisOptions options;
+        CellGrid truecolor = analyze_cells(make_test_byte_image(1600, 800, 3), 400, 200, options);
+        options.palette = PALETTE_256;
+        CellGrid palette = truecolor;
+        dither_cells(options, palette);
+
+        // Flat 100x100 areas of one color each, like the backgrounds of screenshots and diagrams.
+        // Truecolor runs only join cells of exactly one color, so the gradients above barely coalesce.
+        auto pixels = make_shared<vector<uint8_t>>(1600 * 800 * 3);
+        for (size_t i = 0; i < 1600 * 800; i++) {
+            size_t area = (i % 1600) / 100 + (i / 1600) / 100 * 16;
+            for (size_t c = 0; c < 3; c++) {
+                (*pixels)[i * 3 + c] = static_cast<uint8_t>(area * (37 + 50 * c) % 256);
+            }
+        }
+        options.palette = PALETTE_TRUECOLOR;
+        CellGrid flat = analyze_cells(ByteImage(1600, 800, 3, pixels->data(), pixels), 400, 200, options);
+
+        const char* format_names[] = {"ans", "txt", "html", "svg"};
+        for (const CellGrid* grid : {&truecolor, &flat, &palette}) {
+            for (OutputFormat format : {FORMAT_ANSI, FORMAT_TEXT, FORMAT_HTML, FORMAT_SVG}) {
+                FILE* file = tmpfile();
+                if (!file) {
+                    cout << "  cannot create a temporary file\n";
+                    ok = false;
+                    break;
+                }
+                double ms = time_ms(iterations, [&] {
+                    rewind(file);
+                    OutputBuffer out(file);
+                    write_cells(*grid, format, out);
+                });
+                long bytes = ftell(file);
+                fclose(file);
+
+                string name = string(format_names[format]) + (grid == &truecolor ? " truecolor" : grid == &flat ? " truecolor, flat areas" : " 256 colors");
+                cout << "  " << left << setw(32) << name << right << fixed << setprecision(2) << setw(9) << ms << " ms" << setw(9) << bytes / 1024 << " KiB";
+
+                // Against rows of one-glyph cells, each with its own color escape, span or tspan
+                if (format != FORMAT_TEXT) {
+                    double naive_bytes = grid->height * (format == FORMAT_SVG ? 64.0 : 1.0);
+                    for (const Cell& cell : grid->cells) {
+                        char escape[MAX_COLOR_ESCAPE];
+                        naive_bytes += 1 + (format == FORMAT_ANSI ? format_color_escape(cell, grid->palette, escape) : format == FORMAT_HTML ? 35 : 30);
+                    }
+                    cout << setprecision(1) << setw(6) << naive_bytes / bytes << "x smaller than per cell";
+                }
+                cout << "\n";
+            }
+        }
+    }
+
+    cout << "\nall four formats from one analysis, 400x200 cells\n";
+    {
+        AnalysisOptions options;
+        CellGrid cells = analyze_cells(make_test_byte_image(1600, 800, 3), 400, 200, options);
+        vector<OutputTarget> targets;
+        for (const char* target : {"ans:bench_output.ans", "txt:bench_output.txt", "html:bench_output.html", "svg:bench_output.svg"}) {
+            targets.emplace_back();
+            parse_output_target(target, targets.back());
+        }
+
+        double sequential_ms = time_ms(iterations, [&] {
+            for (const OutputTarget& target : targets) {
+                write_outputs(cells, ByteImage(), {target});
+            }
+        });
+        double concurrent_ms = time_ms(iterations, [&] { write_outputs(cells, ByteImage(), targets); });
+
+        // Each file must hold exactly what its writer produces alone
+        bool match = write_outputs(cells, ByteImage(), targets).empty();
+        for (const OutputTarget& target : targets) {
+            FILE* expected = tmpfile();
+            FILE* file = fopen(target.path.c_str(), "rb");
+            if (expected && file) {
+                {
+                    OutputBuffer out(expected);
+                    write_cells(cells, target.format, out);
+                }
+                rewind(expected);
+                int a, b;
+                do {
+                    a = fgetc(expected);
+                    b = fgetc(file);
+                } while (a == b && a != EOF);
+                match = match && a == b;
+            } else {
+                match = false;
+            }
+            if (expected) {
+                fclose(expected);
+            }
+            if (file) {
+                fclose(file);
+            }
+            remove(target.path.c_str());
+        }
+        ok = ok && match;
+
+        cout << "  " << left << setw(32) << "one after another" << right << fixed << setprecision(2) << setw(9) << sequential_ms << " ms\n";
+        cout << "  " << left << setw(32) << "one thread per output" << right << fixed << setprecision(2) << setw(9) << concurrent_ms << " ms" << (match ? "" : "  MISMATCH") << "\n";
+    }
+
+    cout << "\npng rendering\n";
+    {
+        struct Render {
+            const char* name;
+            size_t columns, rows;
+        };
+        const Render renders[] = {{"80x40 cells -> 640x640 px", 80, 40}, {"400x200 cells -> 3200x3200 px", 400, 200}};
+        for (const Render& render : renders) {
+            AnalysisOptions options;
+            CellGrid cells = analyze_cells(make_test_byte_image(render.columns * 4, render.rows * 8, 3), render.columns, render.rows, options);
+
+            ByteImage pixels;
+            vector<uint8_t> png;
+            double raster_ms = time_ms(iterations, [&] { pixels = rasterize_cells(cells); });
+            double encode_ms = time_ms(iterations, [&] { png = encode_png(pixels); });
+
+            // Both encodings must decode back to the rasterized pixels
+            bool match = true;
+            for (PngCompression compression : {PNG_FAST, PNG_STORED}) {
+                vector<uint8_t> encoded = compression == PNG_FAST ? png : encode_png(pixels, compression);
+                ByteImage decoded = load_byte_image_from_memory(encoded.data(), encoded.size());
+                match = match && decoded.width == pixels.width && decoded.height == pixels.height && decoded.channels == 3 &&
+                        memcmp(decoded.data, pixels.data, pixels.width * pixels.height * 3) == 0;
+            }
+            ok = ok && match;
+
+            cout << "  " << left << setw(32) << render.name << right << fixed << setprecision(2) << setw(9) << raster_ms << " ms raster" << setw(8) << encode_ms << " ms encode"
+                 << setprecision(0) << setw(7) << 1000.0 / (raster_ms + encode_ms) << " renders/s" << setw(8) << png.size() / 1024 << " KiB" << (match ? "" : "  MISMATCH") << "\n";
+        }
+    }
+
+    cout << "\nsixel encoding\n";
+    {
+        struct Render {
+            const char* name;
+            size_t width, height;
+        };
+        const Render renders[] = {{"640x640 px", 640, 640}, {"3200x3200 px", 3200, 3200}};
+        for (const Render& render : renders) {
+            ByteImage pixels = make_box_resized(make_test_byte_image(render.width * 2, render.height * 2, 3), render.width, render.height);
+
+            string sixel;
+            double palette_ms = time_ms(iterations, [&] { make_sixel_palette(pixels); });
+            double one_ms = time_ms(iterations, [&] { sixel = encode_sixel(pixels, 1); });
+            double all_ms = time_ms(iterations, [&] { encode_sixel(pixels); });
+
+            // Bands encoded on any number of threads join into the same bytes
+            bool match = encode_sixel(pixels, 3) == sixel;
+
+            // Every pixel is drawn once, in a color close to its own
+            size_t width = 0, height = 0;
+            vector<uint8_t> draws;
+            vector<uint8_t> decoded = decode_sixel(sixel, width, height, draws);
+            match = match && width == pixels.width && height == pixels.height && all_of(draws.begin(), draws.end(), [](uint8_t n) { return n == 1; });
+            double error = 0.0;
+            if (match) {
+                for (size_t p = 0; p < decoded.size(); p++) {
+                    error += abs(decoded[p] - pixels.data[p]);
+                }
+                error /= decoded.size();
+                match = error < 8.0;
+            }
+            ok = ok && match;
+
+            cout << "  " << left << setw(32) << render.name << right << fixed << setprecision(2) << setw(9) << palette_ms << " ms palette" << setw(9) << one_ms << " ms 1 thread"
+                 << setw(9) << all_ms << " ms all" << setw(7) << error << " mean error" << setw(8) << sixel.size() / 1024 << " KiB" << (match ? "" : "  MISMATCH") << "\n";
+        }
+    }
+
+    cout << "\nkitty graphics frames\n";
+    {
+        const size_t sizes[][2] = {{640, 640}, {3200, 3200}};
+        for (const auto& size : sizes) {
+            ByteImage pixels = make_box_resized(make_test_byte_image(size[0], size[1], 3), size[0], size[1]);
+            KittyImage direct(1, KITTY_DIRECT), shared(2, KITTY_SHARED_MEMORY);
+
+            string escapes, shared_escape;
+            double direct_ms = time_ms(iterations, [&] { escapes = direct.encode_frame(pixels, size[0] / 8, size[1] / 16); });
+            double shared_ms = time_ms(iterations, [&] {
+                shared_escape = shared.encode_frame(pixels, size[0] / 8, size[1] / 16);
+#ifndef _WIN32
+                // No terminal reads the object here, so unlink it as one would
+                vector<uint8_t> name = decode_kitty_payload(shared_escape);
+                if (shared_escape.find("t=s") != string::npos) {
+                    shm_unlink(string(name.begin(), name.end()).c_str());
+                }
+#endif
+            });
+
+            // Direct chunks decode back to the pixels with opaque alpha
+            vector<uint8_t> rgba = decode_kitty_payload(escapes);
+            bool match = rgba.size() == size[0] * size[1] * 4;
+            for (size_t p = 0; match && p < size[0] * size[1]; p++) {
+                match = memcmp(&rgba[p * 4], pixels.data + p * 3, 3) == 0 && rgba[p * 4 + 3] == 255;
+            }
+            ok = ok && match;
+
+            cout << "  " << left << setw(32) << (to_string(size[0]) + "x" + to_string(size[1]) + " px") << right << fixed << setprecision(2) << setw(9) << direct_ms << " ms base64"
+                 << setw(9) << escapes.size() / 1024 << " KiB" << setw(9) << shared_ms << " ms shared memory" << setw(6) << shared_escape.size() << " B" << (match ? "" : "  MISMATCH") << "\n";
+        }
+    }
+
+    cout << "\nasciicast recording\n";
+    {
+        // Escaping matches a byte-at-a-time reference over every byte value
+        string all_bytes, escaped, expected;
+        for (int c = 0; c < 256; c++) {
+            all_bytes += static_cast<char>(c);
+        }
+        append_json_string(escaped, all_bytes.data(), all_bytes.size());
+        for (unsigned char c : all_bytes) {
+            char unicode[8];
+            const char* named = c == '"' ? "\\\"" : c == '\\' ? "\\\\" : c == '\n' ? "\\n" : c == '\r' ? "\\r" : c == '\t' ? "\\t" : c == '\b' ? "\\b" : c == '\f' ? "\\f" : nullptr;
+            if (named) {
+                expected += named;
+            } else if (c < 0x20 || c == 0x7f) {
+                snprintf(unicode, sizeof(unicode), "\\u%04x", c);
+                expected += unicode;
+            } else {
+                expected += static_cast<char>(c);
+            }
+        }
+        bool match = escaped == expected;
+
+        // A frame of ANSI output to escape
+        AnalysisOptions options;
+        CellGrid cells = analyze_cells(make_test_byte_image(800, 800, 3), 200, 100, options);
+        FILE* file = tmpfile();
+        OutputBuffer buffer(file);
+        write_cells(cells, FORMAT_ANSI, buffer);
+        buffer.flush();
+        string payload(static_cast<size_t>(ftell(file)), '\0');
+        rewind(file);
+        match = fread(&payload[0], 1, payload.size(), file) == payload.size() && match;
+        fclose(file);
+        double escape_ms = time_ms(iterations, [&] {
+            escaped.clear();
+            append_json_string(escaped, payload.data(), payload.size());
+        });
+
+        // Frames where a 20x10 block moves across still cells: later ones record only what changed
+        const size_t n_frames = 30;
+        vector<CellGrid> frames(n_frames, cells);
+        for (size_t f = 0; f < n_frames; f++) {
+            for (size_t y = 40; y < 50; y++) {
+                for (size_t x = f * 5; x < f * 5 + 20; x++) {
+                    frames[f].cells[y * cells.width + x].r ^= 0x80;
+                }
+            }
+        }
+        CastRecorder recorder;
+        double record_ms = time_ms(1, [&] {
+            recorder.open("bench_output.cast", cells.width, cells.height);
+            for (const CellGrid& frame : frames) {
+                recorder.record_frame(frame);
+            }
+            match = recorder.close() && match;
+        });
+        FILE* cast = fopen("bench_output.cast", "rb");
+        fseek(cast, 0, SEEK_END);
+        long cast_size = ftell(cast);
+        fclose(cast);
+        remove("bench_output.cast");
+        ok = ok && match;
+
+        cout << "  " << left << setw(32) << "escape one 200x100 frame" << right << fixed << setprecision(2) << setw(9) << escape_ms << " ms" << setw(9)
+             << payload.size() / 1e3 / escape_ms << " MB/s" << (match ? "" : "  MISMATCH") << "\n";
+        cout << "  " << left << setw(32) << "30 frames, 20x10 cells moving" << right << setw(9) << record_ms << " ms" << setw(9) << cast_size / 1024 << " KiB"
+             << setw(8) << setprecision(1) << static_cast<double>(payload.size()) * n_frames / cast_size << "x smaller than whole frames\n";
+    }
+
+    cout << "\n.acells frame store, 200x100 cells\n";
+    {
+        // A 20x10 block bouncing over still cells, with a size change halfway
+        AnalysisOptions options;
+        CellGrid still = analyze_cells(make_test_byte_image(800, 800, 3), 200, 100, options);
+        CellGrid smaller = analyze_cells(make_test_byte_image(800, 800, 3), 160, 80, options);
+        const size_t n_frames = 300;
+        vector<CellGrid> frames;
+        for (size_t f = 0; f < n_frames; f++) {
+            frames.push_back(f < n_frames / 2 ? still : smaller);
+            CellGrid& frame = frames.back();
+            size_t x0 = f * 3 % (frame.width - 20), y0 = f % (frame.height - 10);
+            for (size_t y = y0; y < y0 + 10; y++) {
+                for (size_t x = x0; x < x0 + 20; x++) {
+                    frame.cells[y * frame.width + x].g ^= 0x80;
+                }
+            }
+        }
+
+        bool match = true;
+        double write_ms = time_ms(1, [&] {
+            CellStoreWriter writer;
+            match = writer.open("bench_output.acells");
+            for (const CellGrid& frame : frames) {
+                writer.record_frame(frame);
+            }
+            match = writer.close() && match;
+        });
+
+        CellStore store;
+        match = store.open("bench_output.acells") && store.size() == n_frames && match;
+
+        // Every frame seeks back exactly, and playing in order rebuilds each one too
+        size_t raw_size = 0;
+        for (size_t f = 0; match && f < n_frames; f++) {
+            match = same_cells(store.get_frame(f), frames[f]) && store.get_frame(f).width == frames[f].width;
+            raw_size += frames[f].cells.size() * sizeof(Cell);
+        }
+        CellGrid played;
+        double play_ms = time_ms(iterations, [&] {
+            for (size_t f = 0; f < store.size(); f++) {
+                store.apply_frame(f, played);
+            }
+        });
+        match = match && same_cells(played, frames.back());
+        double seek_ms = time_ms(iterations, [&] {
+            for (size_t f = 0; f < n_frames; f += 7) {
+                store.get_frame((f * 37) % n_frames);
+            }
+        }) / ((n_frames + 6) / 7);
+
+        FILE* file = fopen("bench_output.acells", "rb");
+        fseek(file, 0, SEEK_END);
+        long file_size = ftell(file);
+        vector<uint8_t> bytes(static_cast<size_t>(file_size));
+        rewind(file);
+        bytes.resize(fread(bytes.data(), 1, bytes.size(), file));
+        fclose(file);
+        remove("bench_output.acells");
+        ok = ok && match;
+
+        // Damaged files: each is refused when opened, or its frame when read, never read out of bounds
+        auto put_u64 = [](vector<uint8_t>& data, size_t at, uint64_t value) {
+            for (size_t b = 0; b < 8; b++) {
+                data[at + b] = static_cast<uint8_t>(value >> (8 * b));
+            }
+        };
+        size_t index_offset = 0, glyphs_end = 36;
+        for (size_t b = 0; b < 8; b++) {
+            index_offset |= static_cast<size_t>(bytes[16 + b]) << (8 * b);
+        }
+        for (size_t g = 0; g < bytes[32]; g++) {
+            glyphs_end += 1 + bytes[glyphs_end];
+        }
+        vector<uint8_t> wrapping_offset = bytes, delta_keyframe = bytes, late_time = bytes, earlier_time = bytes, bad_glyph = bytes;
+        put_u64(wrapping_offset, index_offset, 0xfffffffffffffff0ull);
+        delta_keyframe[index_offset + 24 + 16] = 1;  // Frame 1 as its own keyframe, though only its changes are stored
+        put_u64(late_time, index_offset + 24 + 8, UINT64_MAX);
+        put_u64(earlier_time, index_offset + 8, MAX_CELL_STORE_TIME_US);
+        bad_glyph[glyphs_end + 24 + 8] = 200;  // First cell of frame 0, past the charset
+        bool refused = true;
+        for (const vector<uint8_t>* damaged : {&wrapping_offset, &delta_keyframe, &late_time, &earlier_time, &bad_glyph}) {
+            file = fopen("bench_damaged.acells", "wb");
+            fwrite(damaged->data(), 1, damaged->size(), file);
+            fclose(file);
+            CellStore damaged_store;
+            bool opened = damaged_store.open("bench_damaged.acells");
+            if (opened && damaged == &bad_glyph) {
+                try {
+                    damaged_store.get_frame(0);
+                } catch (const runtime_error&) {
+                    opened = false;
+                }
+            }
+            refused = refused && !opened;
+            remove("bench_damaged.acells");
+        }
+        ok = ok && refused;
+
+        cout << "  " << left << setw(32) << "write 300 frames" << right << fixed << setprecision(2) << setw(9) << write_ms << " ms" << setw(9) << file_size / 1024 << " KiB"
+             << setw(8) << setprecision(1) << static_cast<double>(raw_size) / file_size << "x smaller than whole frames" << (match ? "" : "  MISMATCH") << "\n";
+        cout << "  " << left << setw(32) << "play all in order" << right << setprecision(2) << setw(9) << play_ms << " ms" << setw(9) << play_ms * 1000 / n_frames << " us/frame\n";
+        cout << "  " << left << setw(32) << "seek to any frame" << right << setw(9) << seek_ms * 1000 << " us\n";
+        cout << "  " << left << setw(32) << "damaged files refused" << right << (refused ? "" : "  MISMATCH") << "\n";
+    }
+
+    cout << "\nVideo frames, 1280x720 to 160x90 cells, 60 frames\n";
+    {
+        // A 40x30 block sliding over a still picture, the way most of a screen recording stays put
+        const size_t n_frames = 60;
+        struct VideoTest {
+            const char* name;
+            size_t channels;
+            double edge_threshold;
+            bool linear_light;
+        } tests[] = {{"rgb", 3, 4.0, false}, {"rgb, edges", 3, 1.0, false}, {"rgba, edges, linear", 4, 0.5, true}};
+
+        for (const VideoTest& test : tests) {
+            AnalysisOptions options;
+            options.edge_threshold = test.edge_threshold;
+            options.linear_light = test.linear_light;
+            vector<uint8_t> still = make_test_pixels(1280, 720, test.channels);
+            vector<ByteImage> frames;
+            for (size_t f = 0; f < n_frames; f++) {
+                auto pixels = make_shared<vector<uint8_t>>(still);
+                size_t x0 = 20 * f % (1280 - 40), y0 = 7 * f % (720 - 30);
+                for (size_t y = y0; y < y0 + 30; y++) {
+                    for (size_t x = x0; x < x0 + 40; x++) {
+                        for (size_t c = 0; c < test.channels; c++) {
+                            (*pixels)[(y * 1280 + x) * test.channels + c] = static_cast<uint8_t>(255 - c * 60 - f);
+                        }
+                    }
+                }
+                frames.push_back(ByteImage(1280, 720, test.channels, pixels->data(), pixels));
+            }
+
+            vector<CellGrid> full(n_frames);
+            double full_ms = time_ms(1, [&] {
+                for (size_t f = 0; f < n_frames; f++) {
+                    full[f] = analyze_cells(frames[f], 160, 90, options);
+                }
+            });
+
+            // Every frame must come out as the full analysis gives it
+            bool match = true;
+            size_t changed = 0;
+            double changed_ms = time_ms(1, [&] {
+                FrameAnalyzer analyzer(160, 90, options);
+                for (size_t f = 0; f < n_frames; f++) {
+                    match = same_cells(analyzer.analyze(frames[f]), full[f]) && match;
+                    changed += f > 0 ? analyzer.get_changed_cells() : 0;
+                }
+            });
+            ok = ok && match;
+
+            cout << "  " << left << setw(24) << test.name << right << fixed << setprecision(2) << setw(9) << full_ms / n_frames << " ms/frame full" << setw(9) << changed_ms / n_frames
+                 << " ms/frame changed  x" << setw(5) << full_ms / changed_ms << setw(8) << changed / (n_frames - 1) << " cells/frame" << (match ? "" : "  MISMATCH") << "\n";
+        }
+    }
+
+    return ok ? 0 : 1;
+}
\ No newline at end of file
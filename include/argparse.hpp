@@ -1,7 +1,13 @@
 #ifndef MY_ARGPARSE
 #define MY_ARGPARSE
 
+#include <cstdint>
 #include <string>
+#include <vector>
+
+#include "color.hpp"
+#include "export.hpp"
+#include "kernels.hpp"
 
 struct Args {
     std::string file_path;
@@ -10,11 +16,38 @@ struct Args {
     double character_ratio;
     double edge_threshold;
     bool use_retro_colors;
+    bool use_fixed_point;
+    Isa isa;
+    size_t threads;
+    size_t memory_budget;
+    bool live_view;
+    bool viewer;
+    bool progressive;
+    bool profile;
+    bool use_thumbnail;
+    uint8_t background[3];
+    bool linear_light;
+    std::string charset;        // Custom glyph ramp, empty for VALUE_CHARS
+    std::string charset_cache;  // File the charset's lookup table is cached in
+    bool shapes;
+    Palette palette;
+    Dither dither;
+    OutputFormat format;
+    std::vector<OutputTarget> outputs;  // Files to write instead of stdout
+    std::string record_path;            // Asciicast or .acells the frames are recorded to, empty for none
+    long frame;                         // Frame of a .acells recording to show, -1 to play them all
+    bool video;                         // Input is a stream of PGM/PPM frames
 
     // Constructor with default values
-    Args() : file_path(""), max_width(0), max_height(0), character_ratio(2.0), edge_threshold(4.0), use_retro_colors(false) {}
+    Args() : file_path(""), max_width(0), max_height(0), character_ratio(2.0), edge_threshold(4.0), use_retro_colors(false), use_fixed_point(true), isa(ISA_AUTO), threads(0), memory_budget(0), live_view(false), viewer(false), progressive(false), profile(false), use_thumbnail(true), background{0, 0, 0}, linear_light(false), charset(""), charset_cache(""), shapes(false), palette(PALETTE_TRUECOLOR), dither(DITHER_NONE), format(FORMAT_ANSI), outputs(), record_path(""), frame(-1), video(false) {}
 };
 
 Args parse_args(int argc, char* argv[]);
 
+// Size of the terminal on stdin in characters, false if it is not a terminal
+bool try_get_terminal_size(size_t& width, size_t& height);
+
+// Whether stdout is a terminal that can take cursor movement
+bool is_output_terminal();
+
 #endif  // MY_ARGPARSE
\ No newline at end of file
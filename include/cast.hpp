@@ -0,0 +1,52 @@
+#ifndef MY_CAST
+#define MY_CAST
+
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <string>
+
+#include "cells.hpp"
+#include "export.hpp"
+#include "recorder.hpp"
+
+// Appends `n` bytes as the contents of a JSON string: quotes, backslashes and control
+// characters are escaped, and the runs between them copied whole
+void append_json_string(std::string& out, const char* data, size_t n);
+
+// Records frames as an asciinema v2 cast: a JSON header line, then one [time, "o", data]
+// line per frame, written through to the file as they come. A frame of the same size as the
+// one before is recorded as only the cells that changed, positioned absolutely.
+class CastRecorder : public FrameRecorder {
+   public:
+    CastRecorder() : file(nullptr), columns(0), rows(0), header_written(false), failed(false) {}
+    ~CastRecorder() override { close(); }
+
+    // Disallow copying
+    CastRecorder(const CastRecorder&) = delete;
+    CastRecorder& operator=(const CastRecorder&) = delete;
+
+    // Starts a recording of a `columns` x `rows` screen; zero takes the size of the first frame
+    bool open(const std::string& path, size_t columns = 0, size_t rows = 0);
+    bool is_open() const { return file != nullptr; }
+
+    // A resize event, after which the next frame is recorded whole
+    void resize(size_t columns, size_t rows) override;
+    void record_frame(const CellGrid& frame) override;
+    bool close() override;
+
+   private:
+    FILE* file;
+    std::unique_ptr<OutputBuffer> out;
+    std::chrono::steady_clock::time_point start;
+    size_t columns, rows;
+    bool header_written;
+    bool failed;
+    CellGrid previous;  // Last recorded frame, empty before the first
+    std::string event;  // Reused for each frame's output
+
+    void write_header(size_t width, size_t height);
+    void write_event(const char* type, const std::string& data);
+};
+
+#endif  // MY_CAST
\ No newline at end of file
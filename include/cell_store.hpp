@@ -0,0 +1,96 @@
+#ifndef MY_CELL_STORE
+#define MY_CELL_STORE
+
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "cells.hpp"
+#include "export.hpp"
+#include "recorder.hpp"
+#include "source.hpp"
+
+// Every this many frames one is stored whole, so seeking decodes at most this many records
+constexpr size_t CELL_STORE_KEYFRAME_INTERVAL = 32;
+
+// Latest time a frame may be stored at, a year into the recording, in microseconds
+constexpr uint64_t MAX_CELL_STORE_TIME_US = 365ull * 24 * 3600 * 1000000;
+
+// Where a frame's record starts, when it was drawn, and the keyframe it is decoded from
+struct CellStoreEntry {
+    uint64_t offset;
+    uint64_t time_us;
+    uint32_t keyframe;
+
+    // Constructor with default values
+    CellStoreEntry() : offset(0), time_us(0), keyframe(0) {}
+};
+
+// Whether the path names a .acells file
+bool is_cell_store_path(const std::string& path);
+
+// Writes frames to a .acells file as they come: a header, the charset's glyphs, a record per
+// frame holding only the runs of cells that changed since the frame before (or all of them,
+// for keyframes and frames of a new size), and on close the index of every record.
+class CellStoreWriter : public FrameRecorder {
+   public:
+    CellStoreWriter() : file(nullptr), offset(0), failed(false) {}
+    ~CellStoreWriter() override { close(); }
+
+    // Disallow copying
+    CellStoreWriter(const CellStoreWriter&) = delete;
+    CellStoreWriter& operator=(const CellStoreWriter&) = delete;
+
+    bool open(const std::string& path);
+    bool is_open() const { return file != nullptr; }
+
+    // Frames carry their own size
+    void resize(size_t, size_t) override {}
+    void record_frame(const CellGrid& frame) override;
+    bool close() override;
+
+   private:
+    FILE* file;
+    std::unique_ptr<OutputBuffer> out;
+    std::chrono::steady_clock::time_point start;
+    uint64_t offset;  // Bytes written so far
+    bool failed;
+    CellGrid previous;
+    std::vector<CellStoreEntry> index;
+    std::string record;  // Reused for each frame's record
+};
+
+// A .acells file mapped into memory. Frames are read straight out of the mapping: any one
+// is the nearest keyframe before it plus the changes after, and playing them in order only
+// applies each record's changes.
+class CellStore {
+   public:
+    // False if the file is not a cell store or is damaged: records outside the file, keyframes
+    // that are not stored whole, or times that go back or past MAX_CELL_STORE_TIME_US. A file
+    // whose recording was cut short has no index; its records are then walked once to rebuild it.
+    bool open(const std::string& path);
+
+    size_t size() const { return index.size(); }
+    bool empty() const { return index.empty(); }
+
+    // Time from the start of the recording at which the frame was drawn
+    std::chrono::microseconds get_time(size_t frame) const { return std::chrono::microseconds(index[frame].time_us); }
+
+    CellGrid get_frame(size_t frame) const;
+
+    // Turns `grid`, holding the frame before `frame` unless `frame` is a keyframe, into `frame`
+    void apply_frame(size_t frame, CellGrid& grid) const;
+
+   private:
+    std::shared_ptr<const MappedFile> file;
+    Charset charset;
+    std::vector<CellStoreEntry> index;
+};
+
+// Plays the frames on stdout at the pace they were recorded, repainting only the cells that
+// change, and hands each to `recorder` when it is given
+void play_cell_store(const CellStore& store, FrameRecorder* recorder = nullptr);
+
+#endif  // MY_CELL_STORE
\ No newline at end of file
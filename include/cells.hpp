@@ -0,0 +1,165 @@
+#ifndef MY_CELLS
+#define MY_CELLS
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "charset.hpp"
+#include "color.hpp"
+#include "image.hpp"
+#include "kernels.hpp"
+
+// Edge direction of a cell, bucketed from the Sobel angle
+enum EdgeDir : uint8_t {
+    EDGE_NONE = 0,
+    EDGE_VERTICAL,    // '|'
+    EDGE_BACKSLASH,   // '\'
+    EDGE_HORIZONTAL,  // '_'
+    EDGE_SLASH        // '/'
+};
+
+// Analyzed character cell, consumed by every output backend
+struct Cell {
+    uint8_t glyph_class;  // Index into the charset's glyphs
+    uint8_t r, g, b;      // Brightness-normalized color
+    uint8_t edge_dir;     // EdgeDir, overrides glyph_class when set
+};
+
+static_assert(sizeof(Cell) == 5, "Cell must stay packed");
+
+struct CellGrid {
+    size_t width;
+    size_t height;
+    bool has_edges;          // Whether edge detection ran, i.e. edge_dir may be set
+    const Charset* charset;  // Glyphs the glyph classes index, owned elsewhere
+    Palette palette;         // Palette the colors were quantized to, printed as its indices
+    std::vector<Cell> cells;
+
+    CellGrid() : width(0), height(0), has_edges(false), charset(&get_default_charset()), palette(PALETTE_TRUECOLOR) {}
+
+    bool empty() const { return cells.empty(); }
+    const Cell& at(size_t x, size_t y) const { return cells[y * width + x]; }
+};
+
+struct AnalysisOptions {
+    double edge_threshold;
+    ColorMode color_mode;
+    Isa isa;
+    size_t threads;          // Fixed-point workers, 0 = one per core
+    size_t memory_budget;    // Fixed-point peak working set in bytes, 0 = unlimited
+    uint8_t background[3];   // RGB that images with alpha are composited over
+    bool linear_light;       // Average pixels in linear light rather than sRGB
+    const Charset* charset;  // Glyph ramp; must outlive the grids analyzed with it
+    bool shape_matching;     // Whether callers follow the analysis with match_shapes
+    Palette palette;         // Palette dither_cells quantizes to
+    Dither dither;
+
+    // Constructor with default values
+    AnalysisOptions() : edge_threshold(4.0), color_mode(COLOR_TRUECOLOR), isa(ISA_AUTO), threads(0), memory_budget(0), background{0, 0, 0}, linear_light(false), charset(&get_default_charset()), shape_matching(false), palette(PALETTE_TRUECOLOR), dither(DITHER_NONE) {}
+};
+
+// Whether the last of `channels` interleaved channels is alpha (gray + alpha or RGBA)
+constexpr bool has_alpha(size_t channels) { return channels == 2 || channels == 4; }
+
+// The background as one pixel of `channels` channels: gray takes its BT.709 luminance
+void get_background_pixel(const AnalysisOptions& options, size_t channels, uint8_t* pixel);
+
+// Opaque copy of an image with alpha, composited over the background. Images without
+// alpha are returned as they are. The analysis overloads composite on their own.
+ByteImage make_composited(const ByteImage& image, const AnalysisOptions& options);
+
+// Characters of the default charset, from darkest to brightest
+extern const std::string VALUE_CHARS;
+
+// Glyph a cell prints as: its edge character, or its glyph class in `charset`
+const std::string& get_cell_glyph(const Cell& cell, const Charset& charset);
+
+// Single pass over the original image: box-averages each cell, then derives
+// luminance, Sobel edges and color while the cell rows are still hot in cache.
+// The row loop is instantiated per channel layout and edge mode, and the color
+// mode is picked once through the kernel table, so the hot loop has no mode branches.
+CellGrid analyze_cells(const Image& original, size_t width, size_t height, const AnalysisOptions& options);
+
+class RowSource;
+class SummedAreaTable;
+
+// Integer fixed-point equivalent over 8-bit pixels. Glyphs match the double
+// path except at exact bucket ties, and color components are within +-1.
+CellGrid analyze_cells(const ByteImage& original, size_t width, size_t height, const AnalysisOptions& options);
+
+// Nearest-neighbour resize of an analyzed grid, for showing a coarse grid at full size
+CellGrid make_scaled_cells(const CellGrid& grid, size_t width, size_t height);
+
+// Fixed-point analysis of streamed rows. The source is split into chunks of rows that
+// worker threads sum in parallel, sized so the working set stays in options.memory_budget.
+CellGrid analyze_cells(RowSource& source, size_t width, size_t height, const AnalysisOptions& options);
+
+// Fixed-point analysis from a summed-area table, in time proportional to the cell count
+// rather than the image size. Gives the same cells as the other fixed-point overloads.
+CellGrid analyze_cells(const SummedAreaTable& table, size_t width, size_t height, const AnalysisOptions& options);
+
+// A block of cells on a lattice of fixed-size cells anchored at the image's top-left
+// corner: lattice cell (i, j) covers pixels [i, i + 1) * cell_width x [j, j + 1) * cell_height
+struct CellWindow {
+    size_t x, y;                     // First lattice cell
+    size_t width, height;            // Cells in the window
+    size_t cell_width, cell_height;  // Pixels per cell
+
+    // Constructor with default values
+    CellWindow() : x(0), y(0), width(0), height(0), cell_width(1), cell_height(1) {}
+};
+
+// Fixed-point analysis of one window of a cell lattice; cells past the image stay blank.
+// Edges look at the lattice cells around the window, so adjacent windows tile seamlessly.
+CellGrid analyze_window(const ByteImage& image, const CellWindow& window, const AnalysisOptions& options);
+
+// Fixed-point analysis of successive video frames of one size, redoing only what changed.
+// Each cell's pixels are compared with the previous frame's; cells that changed are summed
+// and shaded again, and edges are redone for them and the ring of cells their Sobel reaches.
+// The rest keep their cells, so every frame gives the same cells as analyze_cells would.
+class FrameAnalyzer {
+   public:
+    // Cells of `width` x `height`; options.charset must outlive the analyzer
+    FrameAnalyzer(size_t width, size_t height, const AnalysisOptions& options);
+
+    // Cells of the next frame, which must have the size and channels of the first
+    const CellGrid& analyze(const ByteImage& frame);
+
+    // Cells the last frame changed
+    size_t get_changed_cells() const { return changed_cells; }
+
+   private:
+    template <size_t Channels, ColorMode Mode>
+    void analyze_frame(const ByteImage& frame, const Kernels& kernels, bool first);
+    template <size_t Channels>
+    void analyze_frame(const ByteImage& frame, const Kernels& kernels, bool first);
+
+    AnalysisOptions options;
+    CellGrid grid;
+    size_t frame_width, frame_height, frame_channels;
+    std::vector<size_t> column_edges, row_edges;  // Pixel bounds of the cell columns and rows
+    std::vector<uint8_t> previous;                // Pixels of the last frame, to compare with
+    std::vector<int32_t> luminance;               // Of every cell, for the Sobel around changed ones
+    std::vector<uint8_t> changed;                 // Per cell, for the last frame
+    size_t changed_cells;
+};
+
+// Shape matching: re-picks the glyph of every cell with enough contrast as the charset glyph
+// nearest to it in shape. The cell is sampled at FONT_WIDTH x FONT_HEIGHT points, which are
+// thresholded halfway between the darkest and brightest one into a 128-bit mask and compared
+// against every glyph bitmap by Hamming distance. `image` is the upright image `grid` was
+// analyzed from; the streamed overloads leave it to callers that keep the image around.
+void match_shapes(const ByteImage& image, const AnalysisOptions& options, CellGrid& grid);
+
+// Same for a grid from analyze_window
+void match_shapes(const ByteImage& image, const CellWindow& window, const AnalysisOptions& options, CellGrid& grid);
+
+// Quantizes every cell's color to options.palette with options.dither, which print_image then
+// writes as palette indices; does nothing for truecolor. Bayer thresholds depend on the cell's
+// position only, so rows are split between workers. Floyd-Steinberg runs in a wavefront: workers
+// take rows in turn, each following just behind the row above, and bands of rows alternate
+// direction. Either way the cells do not depend on the number of workers.
+void dither_cells(const AnalysisOptions& options, CellGrid& grid);
+
+#endif  // MY_CELLS
\ No newline at end of file
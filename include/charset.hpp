@@ -0,0 +1,33 @@
+#ifndef MY_CHARSET
+#define MY_CHARSET
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Number of brightness levels the analysis quantizes a cell to
+constexpr size_t N_BRIGHTNESS_LEVELS = 256;
+
+// Glyphs that draw a cell's brightness. The analysis reads a cell's glyph class straight
+// out of `levels` by its 8-bit brightness, so every ramp costs one table lookup.
+struct Charset {
+    std::vector<std::string> glyphs;        // UTF-8 encoded, from darkest to brightest
+    uint8_t levels[N_BRIGHTNESS_LEVELS];    // Brightness level -> index into glyphs
+    std::vector<uint64_t> shapes;           // Bitmaps for shape matching: rows 0-7 of every glyph, then rows 8-15
+
+    // Constructor with default values
+    Charset() : levels{} {}
+};
+
+// VALUE_CHARS in its hand-tuned order, split into equal brightness buckets
+const Charset& get_default_charset();
+
+// Glyphs of `text` sorted by their ink coverage in the built-in font, with each brightness
+// level mapped to the glyph of nearest coverage. Glyphs the font lacks are left out.
+bool make_charset(const std::string& text, Charset& charset);
+
+// make_charset through a cache file: reuses the table stored there when it was built from
+// the same text and font version, otherwise builds it and rewrites the file
+bool load_charset(const std::string& text, const std::string& cache_path, Charset& charset);
+
+#endif  // MY_CHARSET
\ No newline at end of file
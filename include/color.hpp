@@ -0,0 +1,64 @@
+#ifndef MY_COLOR
+#define MY_COLOR
+
+#include <cstdint>
+
+struct HSV {
+    double hue;
+    double saturation;
+    double value;
+};
+
+HSV rgb_to_hsv(double red, double green, double blue);
+void hsv_to_rgb(const HSV& hsv, double& r, double& g, double& b);
+
+// 3-bit palette: quantizes hue to 60 degrees and saturation to 0% or 100%
+void get_retro_rgb(const HSV& hsv, int& out_r, int& out_g, int& out_b);
+
+// Terminal palettes cells can be quantized to
+enum Palette {
+    PALETTE_TRUECOLOR = 0,  // 24-bit color, not quantized
+    PALETTE_8,              // ANSI colors, taken as the corners of the RGB cube
+    PALETTE_16,             // ANSI colors and their bright variants, as xterm shows them
+    PALETTE_256             // xterm's 6x6x6 color cube and 24-step gray ramp
+};
+
+// How colors between palette entries are approximated
+enum Dither {
+    DITHER_NONE = 0,        // Nearest entry
+    DITHER_BAYER,           // 8x8 ordered threshold matrix, independent per cell
+    DITHER_FLOYD_STEINBERG  // Error diffusion into the cells not yet quantized
+};
+
+// Number of entries, 0 for truecolor
+size_t get_palette_size(Palette palette);
+
+// RGB of entry `index` of a palette
+void get_palette_rgb(Palette palette, uint8_t index, uint8_t* rgb);
+
+// Entry nearest an RGB color by squared distance, exact for the palette's own colors. The
+// color may lie outside the 8-bit range, as dithering errors can push it there.
+// The 256-color palette picks from the cube and the gray ramp only: its first 16 follow the terminal theme.
+uint8_t get_nearest_palette_index(Palette palette, int r, int g, int b);
+
+// Typical step between the levels a palette has per channel, which ordered dithering spreads its thresholds over
+int get_palette_spread(Palette palette);
+
+double calculate_grayscale_from_hsv(const HSV& hsv);
+
+// Linear light is kept in 12 bits, so 16 rows of it still fit in 16-bit column sums
+constexpr uint32_t LINEAR_MAX = 4095;
+
+// sRGB transfer function and its inverse, both on [0, 1]
+double srgb_to_linear(double value);
+double linear_to_srgb(double value);
+
+// Lookup tables built once on first use:
+// 8-bit sRGB to linear light scaled to LINEAR_MAX, 256 entries
+const uint16_t* get_linear_table();
+// 8-bit sRGB to linear light on [0, 1], 256 entries
+const double* get_linear_values();
+// Linear light scaled to LINEAR_MAX back to sRGB scaled to 255 << 8, LINEAR_MAX + 1 entries
+const uint16_t* get_srgb_table();
+
+#endif  // MY_COLOR
\ No newline at end of file
@@ -0,0 +1,92 @@
+#ifndef MY_EXPORT
+#define MY_EXPORT
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "cells.hpp"
+#include "kitty.hpp"
+
+// Formats analyzed cells can be written in
+enum OutputFormat {
+    FORMAT_ANSI = 0,  // Text with ANSI color escapes, for terminals
+    FORMAT_TEXT,      // Glyphs only
+    FORMAT_HTML,      // Standalone page: a <pre> of colored spans
+    FORMAT_SVG,       // Standalone image: a <text> of colored tspans per cell row
+    FORMAT_PNG,       // The cells drawn with the built-in font by rasterize_cells
+    FORMAT_SIXEL,     // The image itself, resized to the cells, as sixel graphics
+    FORMAT_KITTY      // The same, as RGBA for the kitty graphics protocol
+};
+
+// Format by its name on the command line: ans, txt, html, svg, png, sixel or kitty
+bool parse_output_format(const std::string& name, OutputFormat& format);
+
+// Whether the format is written from the resized pixels instead of the cells
+constexpr bool is_pixel_format(OutputFormat format) { return format == FORMAT_SIXEL || format == FORMAT_KITTY; }
+
+// A file to write the cells to, in a format
+struct OutputTarget {
+    OutputFormat format;
+    std::string path;  // "-" for stdout
+
+    // Constructor with default values
+    OutputTarget() : format(FORMAT_ANSI), path("") {}
+};
+
+// Target from "<format>:<path>", e.g. "html:art.html"
+bool parse_output_target(const std::string& text, OutputTarget& target);
+
+// Collects output in a large buffer and hands it to the file in few big writes
+class OutputBuffer {
+   public:
+    explicit OutputBuffer(FILE* file, size_t capacity = 1 << 18);
+    ~OutputBuffer();
+
+    // Disallow copying
+    OutputBuffer(const OutputBuffer&) = delete;
+    OutputBuffer& operator=(const OutputBuffer&) = delete;
+
+    void write(const char* data, size_t n);
+    void write(const std::string& text) { write(text.data(), text.size()); }
+
+    // Hands the buffered output to the file; false if any write so far failed
+    bool flush();
+
+   private:
+    FILE* file;
+    std::vector<char> buffer;
+    size_t used;
+    bool failed;
+};
+
+// Longest ANSI foreground color escape, "\x1b[38;2;255;255;255m"
+constexpr size_t MAX_COLOR_ESCAPE = 19;
+
+// Writes the foreground color escape of a cell into `out`: the index of its color in
+// `palette`, or truecolor RGB. Returns its length.
+size_t format_color_escape(const Cell& cell, Palette palette, char* out);
+
+// Pixels of the grid drawn with the built-in font, FONT_WIDTH x FONT_HEIGHT per cell, in
+// RGB over black. Each glyph's rows are expanded once into byte masks, which every cell
+// of it ANDs with its color repeated across a row, a few machine words per pixel row.
+ByteImage rasterize_cells(const CellGrid& grid);
+
+// Writes the cells in `format` straight from the grid. Adjacent cells of one color share a
+// single color escape, span or tspan, and blank glyphs join any run, as their color never shows.
+// Colors are matched exactly, so truecolor gradients, where neighbours differ by a level or two,
+// keep most of their escapes; flat areas and palette colors collapse into long runs.
+// Pixel formats are not drawn from cells and throw.
+void write_cells(const CellGrid& grid, OutputFormat format, OutputBuffer& out);
+
+// Writes the pixels, resized to the grid, in a pixel format: a sixel image, or a kitty frame
+// sent with `transfer` over the grid's cells, then as many lines so the cursor ends below it
+void write_pixels(const CellGrid& grid, const ByteImage& pixels, OutputFormat format, OutputBuffer& out, size_t threads = 0, KittyTransfer transfer = KITTY_DIRECT);
+
+// Writes the grid to every target at once, each from its own thread through its own buffer.
+// Pixel formats are written from `pixels` instead, with `threads` workers of their own;
+// kitty frames go through shared memory when stdout is a local terminal.
+// Returns the paths of the targets that could not be opened or written, in order.
+std::vector<std::string> write_outputs(const CellGrid& grid, const ByteImage& pixels, const std::vector<OutputTarget>& targets, size_t threads = 0);
+
+#endif  // MY_EXPORT
\ No newline at end of file
@@ -0,0 +1,29 @@
+#ifndef MY_FONT
+#define MY_FONT
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Built-in 8x16 bitmap font: one byte per row, most significant bit leftmost.
+// Covers Basic Latin, Latin-1, box drawing, block elements and geometric shapes.
+constexpr size_t FONT_WIDTH = 8;
+constexpr size_t FONT_HEIGHT = 16;
+
+// Bumped whenever a bitmap changes, so anything derived from the font can be invalidated
+constexpr uint32_t FONT_VERSION = 1;
+
+// Rows of `codepoint`, or nullptr when the font has no such glyph
+const uint8_t* get_glyph_bitmap(uint32_t codepoint);
+
+// Inked pixels of a glyph, out of FONT_WIDTH * FONT_HEIGHT
+size_t get_glyph_coverage(const uint8_t* bitmap);
+
+// Splits UTF-8 text into one string per codepoint, false if it is not valid UTF-8
+bool split_utf8(const std::string& text, std::vector<std::string>& characters);
+
+// Codepoint of a single UTF-8 encoded character
+uint32_t decode_utf8(const std::string& character);
+
+#endif  // MY_FONT
\ No newline at end of file
@@ -1,6 +1,8 @@
 #ifndef MY_IMAGE_LIB
 #define MY_IMAGE_LIB
 
+#include <cstdint>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -28,20 +30,59 @@ class Image {
     bool empty() const { return data.empty(); }
 };
 
+// 8-bit interleaved image as decoded, used by the fixed-point pipeline.
+// Pixels are not copied out of the decoder: `storage` keeps their buffer alive.
+class ByteImage {
+   public:
+    size_t width;
+    size_t height;
+    size_t channels;
+    const uint8_t* data;
+    std::shared_ptr<const void> storage;
+
+    // Constructors
+    ByteImage() : width(0), height(0), channels(0), data(nullptr) {}
+
+    ByteImage(size_t w, size_t h, size_t c, const uint8_t* d, std::shared_ptr<const void> s) : width(w), height(h), channels(c), data(d), storage(std::move(s)) {}
+
+    // Helper methods
+    bool empty() const { return data == nullptr; }
+    const uint8_t* row(size_t y) const { return data + y * width * channels; }
+};
+
 // Image loading and processing functions
 Image load_image(const std::string& file_path);
+ByteImage load_byte_image(const std::string& file_path);
+ByteImage load_byte_image_from_memory(const uint8_t* bytes, size_t size);
+// Samples of an 8-bit image as doubles in [0, 1], as load_image produces them
+Image make_double_image(const ByteImage& image);
 
 // Pixel access functions
 double* get_pixel(Image& image, size_t x, size_t y);
 const double* get_pixel(const Image& image, size_t x, size_t y);
 void set_pixel(Image& image, size_t x, size_t y, const std::vector<double>& new_pixel);
 
+// EXIF orientation: 1 upright, 2 mirrored, 3 rotated 180, 4 flipped, 5 transposed,
+// 6 needs 90 clockwise, 7 transversed, 8 needs 90 counter-clockwise
+void get_oriented_dimensions(size_t width, size_t height, int orientation, size_t& oriented_width, size_t& oriented_height);
+void get_source_position(size_t width, size_t height, int orientation, size_t x, size_t y, size_t& source_x, size_t& source_y);
+// Stored pixel box [x1, x2) x [y1, y2) of cell (i, j) when the upright image is split into width x height cells
+void get_oriented_box(size_t stored_width, size_t stored_height, int orientation, size_t width, size_t height, size_t i, size_t j, size_t& x1, size_t& x2, size_t& y1, size_t& y2);
+// Upright copies, for consumers that need whole upright images rather than cells
+ByteImage make_oriented(const ByteImage& image, int orientation);
+Image make_oriented(const Image& image, int orientation);
+
 // Image transformation functions
-Image make_resized(const Image& original, size_t max_width, size_t max_height, double character_ratio);
+void get_resized_dimensions(size_t original_width, size_t original_height, size_t max_width, size_t max_height, double character_ratio, size_t& width, size_t& height);
+Image make_resized(const Image& original, size_t max_width, size_t max_height, double character_ratio, int orientation = 1, bool linear_light = false);
+// Exactly width x height pixels: each the mean of its box of the image when shrinking,
+// the nearest pixel when enlarging. Sums are integer, over per-row column totals.
+ByteImage make_box_resized(const ByteImage& image, size_t width, size_t height);
 Image make_grayscale(const Image& original);
 
-// Region analysis
-void get_average(const Image& image, std::vector<double>& average, size_t x1, size_t x2, size_t y1, size_t y2);
+// Region analysis. Colors of images with alpha are averaged premultiplied, weighted by alpha,
+// and with `linear_light` they are averaged in linear light and converted back to sRGB.
+void get_average(const Image& image, std::vector<double>& average, size_t x1, size_t x2, size_t y1, size_t y2, bool linear_light = false);
 
 // Convolution operations
 void get_convolution(const Image& image, const std::vector<double>& kernel, std::vector<double>& out);
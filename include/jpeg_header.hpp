@@ -0,0 +1,35 @@
+#ifndef MY_JPEG_HEADER
+#define MY_JPEG_HEADER
+
+#include <cstdint>
+#include <string>
+
+#include "image.hpp"
+
+// What the marker segments before a JPEG's scan data say about it
+struct JpegHeader {
+    size_t width;
+    size_t height;
+    size_t components;
+    int orientation;            // EXIF orientation 1-8, 1 (upright) if absent
+    uint64_t thumbnail_offset;  // File offset of the EXIF thumbnail, a JPEG stream itself
+    uint64_t thumbnail_size;    // 0 if there is none
+
+    // Constructor with default values
+    JpegHeader() : width(0), height(0), components(0), orientation(1), thumbnail_offset(0), thumbnail_size(0) {}
+};
+
+// Reads marker segments up to the first scan, never touching the compressed image data.
+// Returns false if the file is not a JPEG or has no frame header.
+bool read_jpeg_header(const std::string& file_path, JpegHeader& header);
+// Same for a whole file already in memory
+bool read_jpeg_header(const uint8_t* bytes, size_t size, JpegHeader& header);
+
+// EXIF orientation of a JPEG, 1 if it has none or is not a JPEG
+int read_jpeg_orientation(const std::string& file_path);
+int read_jpeg_orientation(const uint8_t* bytes, size_t size);
+
+// Decodes only the embedded thumbnail; empty if there is none or it fails to decode
+ByteImage load_jpeg_thumbnail(const std::string& file_path, const JpegHeader& header);
+
+#endif  // MY_JPEG_HEADER
\ No newline at end of file
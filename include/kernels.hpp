@@ -0,0 +1,88 @@
+#ifndef MY_KERNELS
+#define MY_KERNELS
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+struct Cell;
+
+// Instruction set variants of the analysis kernels
+enum Isa {
+    ISA_AUTO = 0,  // Best variant supported by the running CPU
+    ISA_SCALAR,    // Plain C++ reference implementation
+    ISA_SSE2,
+    ISA_AVX2,
+    ISA_AVX512
+};
+
+// Color palettes a cell can be shaded with
+enum ColorMode {
+    COLOR_TRUECOLOR = 0,  // 24-bit color
+    COLOR_RETRO,          // 3-bit palette (8 colors)
+    N_COLOR_MODES
+};
+
+// Largest number of interleaved channels (gray, gray + alpha, RGB, RGBA)
+constexpr size_t MAX_CHANNELS = 4;
+
+typedef void (*LumaRowFn)(const double* pixels, size_t n, double* luminance);
+typedef void (*ShadeRowFn)(const double* pixels, size_t n, const uint8_t* glyph_levels, Cell* cells);
+typedef void (*CompositeRowFn)(uint8_t* out, const uint8_t* row, size_t n, const uint8_t* background);
+
+// Row kernels used by analyze_cells. Kernels that depend on the channel layout or
+// color mode are instantiated for every combination so their loops carry no mode branches.
+struct Kernels {
+    Isa isa;
+    const char* name;
+
+    // Adds a source row to running column sums: sums[k] += row[k]
+    void (*accumulate_row)(double* sums, const double* row, size_t n);
+
+    // Sobel gradients of the middle row. Border columns are zero.
+    void (*sobel_row)(const double* above, const double* row, const double* below, size_t n, double* sx, double* sy);
+
+    // Fixed-point pipeline: adds an 8-bit source row to 16-bit column sums.
+    // Callers flush the sums before they hold 257 rows.
+    void (*accumulate_row_u8)(uint16_t* sums, const uint8_t* row, size_t n);
+
+    // Fixed-point pipeline: moves 16-bit column sums into 32-bit ones and clears them
+    void (*flush_sums)(uint32_t* sums, uint16_t* partial_sums, size_t n);
+
+    // Fixed-point pipeline: adds an 8-bit source row to 16-bit column sums through a lookup
+    // table of 12-bit values, sums[k] += table[row[k]]. Callers flush before 17 rows.
+    void (*accumulate_row_linear)(uint16_t* sums, const uint8_t* row, size_t n, const uint16_t* table);
+
+    // Decoders: rescales n big-endian 16-bit samples to 8 bits, rounded to nearest
+    void (*narrow_row_u16be)(uint8_t* out, const uint8_t* samples, size_t n);
+
+    // Shape matching: the glyph nearest each of n 128-bit masks (two words per mask) by Hamming
+    // distance, the first of equally near ones. `shapes` holds every glyph's first word, then every second word.
+    void (*match_glyphs)(const uint64_t* masks, size_t n, const uint64_t* shapes, size_t n_glyphs, uint8_t* glyph_classes);
+
+    // Fixed-point pipeline: Sobel gradients of luminance scaled to 1 << 16
+    void (*sobel_row_fixed)(const int32_t* above, const int32_t* row, const int32_t* below, size_t n, int32_t* sx, int32_t* sy);
+
+    // Fixed-point pipeline: composites n straight-alpha pixels over `background` (one value per
+    // color channel), rounded to 8 bits, and makes them opaque. Indexed by [channels / 2 - 1].
+    CompositeRowFn composite_row_u8[2];
+
+    // BT.709 luminance of n averaged pixels, indexed by [channels - 1]
+    LumaRowFn luma_row[MAX_CHANNELS];
+
+    // Glyph class and brightness-normalized color of n averaged pixels, indexed by [channels - 1][color mode].
+    // The glyph class is glyph_levels[] of the brightness quantized to 8 bits.
+    ShadeRowFn shade_row[MAX_CHANNELS][N_COLOR_MODES];
+};
+
+// Fastest variant the CPU supports, detected once through cpuid
+Isa detect_isa();
+bool is_isa_supported(Isa isa);
+
+// Kernels for `isa`; ISA_AUTO resolves to detect_isa()
+const Kernels& get_kernels(Isa isa);
+
+const char* get_isa_name(Isa isa);
+bool parse_isa(const std::string& name, Isa& isa);
+
+#endif  // MY_KERNELS
\ No newline at end of file
@@ -0,0 +1,41 @@
+#ifndef MY_KITTY
+#define MY_KITTY
+
+#include <cstdint>
+#include <string>
+
+#include "image.hpp"
+
+// How the pixels of a kitty graphics frame reach the terminal
+enum KittyTransfer {
+    KITTY_DIRECT = 0,     // Base64 inside the escapes, in chunks, through the pty
+    KITTY_SHARED_MEMORY   // Raw RGBA in a POSIX shared memory object, named in the escape
+};
+
+// Shared memory only reaches a terminal on this machine: stdout must be a terminal,
+// and not one of an SSH session, that answers a query for a shared memory frame with OK.
+// Terminals without the protocol would leave every frame's object behind. Queried once per run.
+KittyTransfer get_kitty_transfer();
+
+// Id for the images of this process, so that they replace neither each other's nor
+// those of other programs on the same screen
+uint32_t get_kitty_image_id();
+
+// Frames of one image for a terminal with the kitty graphics protocol. Every frame is sent
+// under the same image and placement id, so the terminal replaces the previous frame in
+// place rather than stacking another image.
+class KittyImage {
+   public:
+    KittyImage(uint32_t id, KittyTransfer transfer) : id(id), transfer(transfer), frames(0) {}
+
+    // Escape drawing the image as RGBA over `columns` x `rows` cells from the cursor, which
+    // stays where it is. Falls back to direct transfer when shared memory is unavailable.
+    std::string encode_frame(const ByteImage& image, size_t columns, size_t rows);
+
+   private:
+    uint32_t id;
+    KittyTransfer transfer;
+    size_t frames;
+};
+
+#endif  // MY_KITTY
\ No newline at end of file
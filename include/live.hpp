@@ -0,0 +1,13 @@
+#ifndef MY_LIVE
+#define MY_LIVE
+
+#include "cells.hpp"
+#include "recorder.hpp"
+#include "summed_area.hpp"
+
+// Interactive view: renders the image to fit the terminal and re-renders from the
+// table on every resize until interrupted. Resizes during a frame coalesce into one.
+// Each frame also goes to `recorder` when it is given.
+void run_live_view(const SummedAreaTable& table, const AnalysisOptions& options, double character_ratio, FrameRecorder* recorder = nullptr);
+
+#endif  // MY_LIVE
\ No newline at end of file
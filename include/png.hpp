@@ -0,0 +1,19 @@
+#ifndef MY_PNG
+#define MY_PNG
+
+#include <cstdint>
+#include <vector>
+
+#include "image.hpp"
+
+// How encode_png compresses the pixels
+enum PngCompression {
+    PNG_FAST = 0,  // Greedy LZ77 with fixed Huffman codes, falling back to stored if that is smaller
+    PNG_STORED     // No compression, only framing
+};
+
+// 8-bit PNG of an image of 1 to 4 channels (gray, gray + alpha, RGB, RGBA).
+// Rows are not filtered: the deflate matcher alone finds the runs and repeats.
+std::vector<uint8_t> encode_png(const ByteImage& image, PngCompression compression = PNG_FAST);
+
+#endif  // MY_PNG
\ No newline at end of file
@@ -1,8 +1,13 @@
 #ifndef MY_PRINT_IMAGE
 #define MY_PRINT_IMAGE
 
-#include "image.hpp"
+#include "cells.hpp"
 
-void print_image(const Image& image, double edge_threshold, bool use_retro_colors);
+// Writes the analyzed cells to stdout as ANSI colored text: 24-bit, or indices of the grid's palette
+void print_image(const CellGrid& grid);
+
+// Updates a frame printed just before by print_image, with the cursor still right below
+// it, by rewriting only the cells that changed. Returns how many were rewritten.
+size_t repaint_image(const CellGrid& previous, const CellGrid& next);
 
 #endif  // MY_PRINT_IMAGE
\ No newline at end of file
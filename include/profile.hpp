@@ -0,0 +1,34 @@
+#ifndef MY_PROFILE
+#define MY_PROFILE
+
+#include <chrono>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Wall-clock timings of the pipeline stages, printed with --profile
+class Profile {
+   public:
+    Profile();
+
+    // Ends the running stage and records it under `name`
+    void end_stage(const std::string& name);
+
+    // Notes the first time the image reaches the terminal; later calls are ignored
+    void mark_first_output();
+
+    void print(std::ostream& out) const;
+
+   private:
+    typedef std::chrono::steady_clock Clock;
+
+    Clock::time_point start;
+    Clock::time_point stage_start;
+    std::vector<std::pair<std::string, double>> stages;
+    double first_output_ms;  // Negative until the first output
+
+    double get_elapsed_ms(Clock::time_point since) const;
+};
+
+#endif  // MY_PROFILE
\ No newline at end of file
@@ -0,0 +1,45 @@
+#ifndef MY_PYRAMID
+#define MY_PYRAMID
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "image.hpp"
+
+// Box-filtered mipmap levels of an image, each half the size of the one before, down to
+// one pixel. Level 0 is the image itself; the others are built on a background thread
+// and become visible through get_level as they finish. With `linear_light` the boxes
+// are averaged in linear light.
+class Pyramid {
+   public:
+    explicit Pyramid(const ByteImage& image, size_t threads = 0, bool linear_light = false);
+    ~Pyramid();
+
+    // Disallow copying
+    Pyramid(const Pyramid&) = delete;
+    Pyramid& operator=(const Pyramid&) = delete;
+
+    size_t levels() const { return images.size(); }
+    size_t levels_ready() const { return ready.load(std::memory_order_acquire); }
+
+    // The requested level, or the coarsest finished one below it
+    const ByteImage& get_level(size_t level, size_t& level_used) const;
+
+    // Blocks until every level is built
+    void wait();
+
+   private:
+    std::vector<ByteImage> images;
+    std::vector<std::vector<uint8_t>> buffers;
+    std::atomic<size_t> ready;
+    std::atomic<bool> cancelled;
+    size_t threads;
+    bool linear_light;
+    std::thread builder;
+
+    void build();
+};
+
+#endif  // MY_PYRAMID
\ No newline at end of file
@@ -0,0 +1,27 @@
+#ifndef MY_RECORDER
+#define MY_RECORDER
+
+#include <memory>
+#include <string>
+
+#include "cells.hpp"
+
+// Takes the frames the progressive and interactive modes draw, as they are drawn
+class FrameRecorder {
+   public:
+    virtual ~FrameRecorder() = default;
+
+    // The screen changed size
+    virtual void resize(size_t columns, size_t rows) = 0;
+    virtual void record_frame(const CellGrid& frame) = 0;
+
+    // Ends the recording; false if any of it could not be written
+    virtual bool close() = 0;
+};
+
+// Recorder by the file's extension: .acells stores the cells themselves, for instant replay
+// and seeking, anything else is an asciicast. Returns nullptr if the file cannot be created.
+// A `columns` x `rows` screen of zero takes the size of the first frame.
+std::unique_ptr<FrameRecorder> open_frame_recorder(const std::string& path, size_t columns = 0, size_t rows = 0);
+
+#endif  // MY_RECORDER
\ No newline at end of file
@@ -0,0 +1,34 @@
+#ifndef MY_SIXEL
+#define MY_SIXEL
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "image.hpp"
+
+// Most colors a sixel image registers
+constexpr size_t SIXEL_MAX_COLORS = 256;
+
+// Colors of an image reduced by median cut, and the palette entry of every color
+struct SixelPalette {
+    std::vector<uint8_t> colors;  // RGB of each entry
+    std::vector<uint8_t> lut;     // Entry of each 5-bit-per-channel color, indexed r << 10 | g << 5 | b
+
+    // Constructor with default values
+    SixelPalette() : colors(), lut() {}
+
+    size_t size() const { return colors.size() / 3; }
+};
+
+// Median cut over the 5-bit histogram of an image of 1 to 4 channels (alpha is ignored):
+// boxes of occupied colors are split along their longest axis at the median pixel until
+// there are `max_colors`, and each entry is the mean of the pixels in its box
+SixelPalette make_sixel_palette(const ByteImage& image, size_t max_colors = SIXEL_MAX_COLORS);
+
+// Sixel (DEC graphics) escape drawing the image. Pixels are mapped through the palette's
+// table and each six-row band is run-length encoded on its own, on `threads` worker
+// threads (0 for one per core), then the bands are joined in order.
+std::string encode_sixel(const ByteImage& image, size_t threads = 0);
+
+#endif  // MY_SIXEL
\ No newline at end of file
@@ -0,0 +1,174 @@
+#ifndef MY_SOURCE
+#define MY_SOURCE
+
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "image.hpp"
+
+// Read-only view of a whole file, mapped into memory rather than read into a buffer
+class MappedFile {
+   public:
+    const uint8_t* data;
+    size_t size;
+
+    ~MappedFile();
+
+    // Disallow copying
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // Returns nullptr if the file cannot be mapped, e.g. it is empty or not a regular file
+    static std::shared_ptr<const MappedFile> open(const std::string& file_path);
+
+   private:
+    MappedFile() : data(nullptr), size(0) {}
+};
+
+// Supplies 8-bit interleaved source rows to the fixed-point analysis, either
+// from a decoded image in memory or straight from a streaming decoder
+class RowSource {
+   public:
+    size_t width;
+    size_t height;
+    size_t channels;
+    int orientation;  // EXIF orientation of the stored rows; the analysis renders them upright
+
+    RowSource() : width(0), height(0), channels(0), orientation(1) {}
+    virtual ~RowSource() {}
+
+    // Disallow copying
+    RowSource(const RowSource&) = delete;
+    RowSource& operator=(const RowSource&) = delete;
+
+    size_t row_bytes() const { return width * channels; }
+    size_t upright_width() const { return orientation >= 5 ? height : width; }
+    size_t upright_height() const { return orientation >= 5 ? width : height; }
+
+    // Sequential sources must be read top to bottom, one caller at a time
+    virtual bool is_sequential() const = 0;
+
+    // Gets `count` consecutive rows starting at `y`. In-memory sources return a pointer
+    // to their own pixels; sequential ones fill `buffer` (count * row_bytes()) and return it.
+    // Returns nullptr on a read error.
+    virtual const uint8_t* read_rows(size_t y, size_t count, uint8_t* buffer) = 0;
+
+    // Bytes the source itself keeps resident while it is being read
+    virtual size_t resident_bytes() const = 0;
+};
+
+// Rows of an already decoded image
+class ImageRowSource : public RowSource {
+   public:
+    explicit ImageRowSource(const ByteImage& image, int orientation = 1);
+
+    bool is_sequential() const override { return false; }
+    const uint8_t* read_rows(size_t y, size_t count, uint8_t* buffer) override;
+    size_t resident_bytes() const override { return width * height * channels; }
+
+   private:
+    ByteImage image;
+};
+
+// Uncompressed rasters: binary PGM/PPM (P5/P6) and Farbfeld. The file is mapped when possible:
+// 8-bit rows are then handed out in place with no copy, and may be read in any order.
+// Other depths are rescaled to 8 bits into the caller's buffer, and streams such as stdin
+// are read row by row as the bytes arrive; either way no more than the requested rows are held.
+class RawRowSource : public RowSource {
+   public:
+    ~RawRowSource() override;
+
+    // Reads the rest of the header from `stream`, whose first bytes `head` identified the
+    // format, and maps `file_path` unless it is empty. Takes ownership of the stream, which
+    // is closed unless it is stdin. Returns nullptr if the header is invalid.
+    static std::unique_ptr<RawRowSource> open(FILE* stream, const std::vector<uint8_t>& head, const std::string& file_path);
+
+    bool is_sequential() const override { return !mapping || max_value != 255; }
+    const uint8_t* read_rows(size_t y, size_t count, uint8_t* buffer) override;
+    // Mapped pages are backed by the file, so the system can drop them at any time
+    size_t resident_bytes() const override { return 0; }
+
+   private:
+    RawRowSource() : file(nullptr), raster_offset(0), max_value(255), next_row(0) {}
+
+    std::shared_ptr<const MappedFile> mapping;
+    FILE* file;            // Only when the file is not mapped
+    size_t raster_offset;  // Bytes before the first row
+    unsigned max_value;    // Samples above 255 take two big-endian bytes
+    size_t next_row;
+};
+
+// QOI images, decoded straight into the rows being read, from the mapped file or from a
+// window of the stream that is refilled as the decoder reaches its end
+class QoiRowSource : public RowSource {
+   public:
+    ~QoiRowSource() override;
+
+    // Same contract as RawRowSource::open
+    static std::unique_ptr<QoiRowSource> open(FILE* stream, const std::vector<uint8_t>& head, const std::string& file_path);
+
+    bool is_sequential() const override { return true; }
+    const uint8_t* read_rows(size_t y, size_t count, uint8_t* buffer) override;
+    size_t resident_bytes() const override { return window.size(); }
+
+   private:
+    QoiRowSource() : file(nullptr), bytes(nullptr), filled(0), end(0), position(0), pixel(), run(0), next_row(0), index() {}
+
+    template <size_t Channels>
+    bool decode(uint8_t* out, size_t pixels);
+    bool refill(size_t& at);
+
+    std::shared_ptr<const MappedFile> mapping;
+    FILE* file;                   // Only when the file is not mapped
+    std::vector<uint8_t> window;  // Streamed bytes, from the next undecoded one
+    const uint8_t* bytes;         // Mapped file or window
+    size_t filled;                // Bytes in the window
+    size_t end;                   // Chunks starting before `end` have all their bytes loaded
+
+    // Decoder state carried from one read to the next
+    size_t position;
+    uint8_t pixel[4];  // RGBA
+    size_t run;        // Repeats of `pixel` still to be written
+    size_t next_row;
+    uint8_t index[64][4];
+};
+
+// Binary PGM/PPM (P5/P6) frames one after another, as `ffmpeg -f image2pipe -c:v ppm` writes
+// them. Every frame is read whole, at 8 bits, into pixels of its own.
+class FrameStream {
+   public:
+    ~FrameStream();
+
+    // Disallow copying
+    FrameStream(const FrameStream&) = delete;
+    FrameStream& operator=(const FrameStream&) = delete;
+
+    // Reads the file, or stdin for "-". Returns nullptr if it cannot be opened.
+    static std::unique_ptr<FrameStream> open(const std::string& file_path);
+
+    // Next frame; empty at the end of the stream or on a malformed frame
+    ByteImage read_frame();
+
+   private:
+    FrameStream() : file(nullptr) {}
+
+    FILE* file;
+};
+
+// File path that reads the image from stdin
+bool is_stdin_path(const std::string& file_path);
+
+// Streams the image if its format allows it, otherwise decodes it into memory.
+// The source carries the file's EXIF orientation. With the path "-" the image is read from
+// stdin: PGM/PPM, Farbfeld and QOI decode as the bytes arrive, and other formats are
+// collected in a growing buffer that is decoded once the stream ends.
+std::unique_ptr<RowSource> open_row_source(const std::string& file_path);
+
+// Whole stored image of a source, for consumers that need every pixel at once. In-memory
+// and mapped sources are wrapped without a copy; the image keeps the source alive.
+ByteImage read_byte_image(std::unique_ptr<RowSource> source);
+
+#endif  // MY_SOURCE
\ No newline at end of file
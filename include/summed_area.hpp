@@ -0,0 +1,54 @@
+#ifndef MY_SUMMED_AREA
+#define MY_SUMMED_AREA
+
+#include <cstdint>
+#include <vector>
+
+#include "cells.hpp"
+#include "color.hpp"
+#include "source.hpp"
+
+// Per-channel sums of every top-left rectangle of an 8-bit image, kept modulo 2^32.
+// Any box of up to get_max_box_pixels() pixels still differences out exactly, so the
+// cells of any grid size can be summed in O(1) each without the pixels themselves.
+class SummedAreaTable {
+   public:
+    size_t width;
+    size_t height;
+    size_t channels;
+    int orientation;             // Carried over from the source; cells are analyzed upright
+    bool linear_light;           // Whether the sums are of 12-bit linear light rather than sRGB
+    std::vector<uint32_t> sums;  // (height + 1) x (width + 1) x channels, first row and column zero
+
+    // Constructors
+    SummedAreaTable() : width(0), height(0), channels(0), orientation(1), linear_light(false) {}
+
+    // Move constructor and assignment
+    SummedAreaTable(SummedAreaTable&& other) = default;
+    SummedAreaTable& operator=(SummedAreaTable&& other) = default;
+
+    // Disallow copying (use references instead to avoid expensive copies)
+    SummedAreaTable(const SummedAreaTable&) = delete;
+    SummedAreaTable& operator=(const SummedAreaTable&) = delete;
+
+    // Helper methods
+    bool empty() const { return sums.empty(); }
+    uint64_t get_max_box_pixels() const { return UINT32_MAX / (linear_light ? LINEAR_MAX : 255); }
+
+    // Writes the channel sums of the box [x1, x2) x [y1, y2) to `out`
+    void get_box_sums(size_t x1, size_t x2, size_t y1, size_t y2, uint64_t* out) const {
+        size_t stride = (width + 1) * channels;
+        const uint32_t* top = &sums[y1 * stride];
+        const uint32_t* bottom = &sums[y2 * stride];
+        for (size_t c = 0; c < channels; c++) {
+            // Wraps around for large images, but the true box sum fits in 32 bits
+            out[c] = static_cast<uint32_t>(bottom[x2 * channels + c] - bottom[x1 * channels + c] - top[x2 * channels + c] + top[x1 * channels + c]);
+        }
+    }
+};
+
+// Reads every row of the source once, compositing any alpha over options.background and
+// summing linear light if options.linear_light is set. Returns an empty table on a read error.
+SummedAreaTable build_summed_area_table(RowSource& source, const AnalysisOptions& options);
+
+#endif  // MY_SUMMED_AREA
\ No newline at end of file
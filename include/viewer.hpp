@@ -0,0 +1,13 @@
+#ifndef MY_VIEWER
+#define MY_VIEWER
+
+#include "cells.hpp"
+#include "image.hpp"
+#include "recorder.hpp"
+
+// Interactive pan and zoom over the image until q or Ctrl+C. Frames are served from a
+// mipmap pyramid, built in the background, through an LRU cache of rendered cell tiles.
+// Each frame also goes to `recorder` when it is given, without the status line.
+void run_viewer(const ByteImage& image, const AnalysisOptions& options, double character_ratio, FrameRecorder* recorder = nullptr);
+
+#endif  // MY_VIEWER
\ No newline at end of file
@@ -1,3 +1,6 @@
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
 #include <cstdlib>
 #include <cstring>
 #include <iostream>
@@ -14,6 +17,7 @@
 #include <unistd.h>
 
 #include "../include/argparse.hpp"
+#include "../include/cells.hpp"
 
 using namespace std;
 
@@ -27,7 +31,7 @@ void print_help(const string& exec_alias) {
     cout << "\t" << exec_alias << " <path/to/image> [OPTIONS]\n\n";
 
     cout << "ARGUMENTS:\n";
-    cout << "\t<path/to/image>\t\tPath to image file\n\n";
+    cout << "\t<path/to/image>\t\tPath to image file, or - to read it from stdin\n\n";
 
     cout << "OPTIONS:\n";
     cout << "\t-mw <width>\t\tMaximum width in characters (default: terminal width OR " << DEFAULT_MAX_WIDTH << ")\n";
@@ -35,12 +39,33 @@ void print_help(const string& exec_alias) {
     cout << "\t-et <threshold>\t\tEdge detection threshold, range: 0.0 - 4.0 (default: " << DEFAULT_EDGE_THRESHOLD << ", disabled)\n";
     cout << "\t-cr <ratio>\t\tHeight-to-width ratio for characters (default: " << DEFAULT_CHARACTER_RATIO << ")\n";
     cout << "\t--retro-colors\t\tUse 3-bit retro color palette (8 colors) instead of 24-bit truecolor\n";
+    cout << "\t--colors <count>\tWrite palette colors instead of 24-bit truecolor: 8, 16 or 256\n";
+    cout << "\t--dither <method>\tApproximate colors between palette entries: none, bayer or floyd-steinberg (default: none)\n";
+    cout << "\t--precision <mode>\tArithmetic: fixed (integer fixed-point) or double (default: fixed)\n";
+    cout << "\t--isa <name>\t\tKernel variant: auto, scalar, sse2, avx2, avx512 (default: auto, detected: " << get_isa_name(detect_isa()) << ")\n";
+    cout << "\t--threads <count>\tFixed-point worker threads (default: 0, one per core)\n";
+    cout << "\t--memory-budget <size>\tFixed-point working set limit, e.g. 512M or 2G (default: 0, unlimited)\n";
+    cout << "\t--background <color>\tColor transparent pixels are composited over: black, white or RRGGBB hex (default: black)\n";
+    cout << "\t--linear\t\tAverage pixels in linear light instead of sRGB, so downscaled fine detail keeps its brightness\n";
+    cout << "\t--charset <glyphs>\tGlyphs to draw brightness with, in any order, sorted by their ink coverage (default: \"" << VALUE_CHARS << "\")\n";
+    cout << "\t--charset-cache <file>\tKeep the charset's brightness lookup table in <file> and reuse it on later runs\n";
+    cout << "\t--shapes\t\tPick glyphs of high-contrast cells by shape, from every printable ASCII character unless --charset is given\n";
+    cout << "\t--format <format>\tWrite the image as ans (ANSI colored text), txt (plain text), html, svg, png, sixel or kitty (default: ans)\n";
+    cout << "\t--output <fmt>:<file>\tWrite the image to <file> in a format instead, e.g. html:art.html; repeat for more files, - for stdout\n";
+    cout << "\t--live\t\t\tKeep the image loaded and re-render on terminal resize until Ctrl+C (fixed-point)\n";
+    cout << "\t--progressive\t\tShow a coarse frame from the JPEG's EXIF thumbnail first, then repaint what changed\n";
+    cout << "\t--no-thumbnail\t\tAlways decode the full image, even when a JPEG's EXIF thumbnail has enough pixels\n";
+    cout << "\t--profile\t\tPrint stage timings and time to first output to stderr\n";
+    cout << "\t--view\t\t\tInteractive viewer: arrows or hjkl pan, +/- zoom, 0 fit, q quit (fixed-point)\n";
+    cout << "\t--record <file>\t\tRecord the frames drawn, by --progressive, --live and --view too, as an asciinema v2 cast, or as cells if <file> ends in .acells\n";
+    cout << "\t--frame <n>\t\tShow only frame <n> of a .acells recording instead of playing it (default: the last when not on a terminal)\n";
+    cout << "\t--video\t\t\tRead a stream of binary PGM/PPM frames, e.g. from ffmpeg -f image2pipe -c:v ppm, and redraw only the cells that change (fixed-point)\n";
 }
 
 bool try_get_terminal_size(size_t& width, size_t& height) {
 #ifdef _WIN32
-    // Windows implementation
-    if (!_isatty(0)) return false;
+    // Windows implementation; stdin may be carrying the image rather than the console
+    if (!_isatty(0) && !_isatty(1)) return false;
     HANDLE hConsole = GetStdHandle(STD_OUTPUT_HANDLE);
     if (hConsole == INVALID_HANDLE_VALUE) return false;
 
@@ -51,11 +76,12 @@ bool try_get_terminal_size(size_t& width, size_t& height) {
     height = csbi.srWindow.Bottom - csbi.srWindow.Top + 1;
     return true;
 #else
-    // POSIX implementation
-    if (!isatty(0)) return false;
+    // POSIX implementation; stdin may be carrying the image rather than the terminal
+    int terminal = isatty(0) ? 0 : 1;
+    if (!isatty(terminal)) return false;
     struct winsize ws;
 
-    if (ioctl(0, TIOCGWINSZ, &ws) == 0) {
+    if (ioctl(terminal, TIOCGWINSZ, &ws) == 0) {
         width = static_cast<size_t>(ws.ws_col);
         height = static_cast<size_t>(ws.ws_row);
         return true;
@@ -64,6 +90,78 @@ bool try_get_terminal_size(size_t& width, size_t& height) {
     return false;
 }
 
+bool is_output_terminal() {
+#ifdef _WIN32
+    return _isatty(1) != 0;
+#else
+    return isatty(1) != 0;
+#endif
+}
+
+// Parses a frame number: decimal digits only, so signs, blanks and trailing text are rejected
+static bool parse_frame(const char* text, long& frame) {
+    if (!isdigit(static_cast<unsigned char>(*text))) {
+        return false;
+    }
+    char* end;
+    errno = 0;
+    long value = strtol(text, &end, 10);
+    if (*end != '\0' || errno == ERANGE) {
+        return false;
+    }
+    frame = value;
+    return true;
+}
+
+// Parses a byte count with an optional K, M or G suffix
+static bool parse_size(const char* text, size_t& size) {
+    char* end;
+    double value = strtod(text, &end);
+    if (end == text || value < 0) {
+        return false;
+    }
+
+    switch (toupper(*end)) {
+        case 'G':
+            value *= 1024;
+            [[fallthrough]];
+        case 'M':
+            value *= 1024;
+            [[fallthrough]];
+        case 'K':
+            value *= 1024;
+            end++;
+            break;
+    }
+    if (*end == 'B' || *end == 'b') {
+        end++;
+    }
+
+    // Also false for NaN and infinity, which strtod accepts too
+    if (!(value < static_cast<double>(SIZE_MAX))) {
+        return false;
+    }
+    size = static_cast<size_t>(value);
+    return *end == '\0';
+}
+
+// Parses black, white or a hex RRGGBB color, with or without a leading '#'
+static bool parse_color(const string& text, uint8_t* rgb) {
+    if (text == "black" || text == "white") {
+        fill(rgb, rgb + 3, text == "white" ? 255 : 0);
+        return true;
+    }
+
+    string hex = !text.empty() && text[0] == '#' ? text.substr(1) : text;
+    if (hex.size() != 6 || hex.find_first_not_of("0123456789abcdefABCDEF") != string::npos) {
+        return false;
+    }
+    for (size_t c = 0; c < 3; c++) {
+        rgb[c] = static_cast<uint8_t>(stoi(hex.substr(2 * c, 2), nullptr, 16));
+    }
+    return true;
+}
+
 Args parse_args(int argc, char* argv[]) {
     Args args;
 
@@ -105,6 +203,85 @@ Args parse_args(int argc, char* argv[]) {
             args.character_ratio = atof(argv[++i]);
         } else if (arg == "--retro-colors") {
             args.use_retro_colors = true;
+        } else if (arg == "--colors" && i + 1 < argc) {
+            string colors = argv[++i];
+            if (colors == "8" || colors == "16" || colors == "256") {
+                args.palette = colors == "8" ? PALETTE_8 : colors == "16" ? PALETTE_16 : PALETTE_256;
+            } else {
+                cerr << "Warning: Unsupported color count '" << colors << "', using truecolor" << endl;
+            }
+        } else if (arg == "--dither" && i + 1 < argc) {
+            string dither = argv[++i];
+            if (dither == "none" || dither == "bayer" || dither == "floyd-steinberg") {
+                args.dither = dither == "none" ? DITHER_NONE : dither == "bayer" ? DITHER_BAYER : DITHER_FLOYD_STEINBERG;
+            } else {
+                cerr << "Warning: Unknown dither method '" << dither << "', using none" << endl;
+            }
+        } else if (arg == "--format" && i + 1 < argc) {
+            if (!parse_output_format(argv[++i], args.format)) {
+                cerr << "Warning: Unknown output format '" << argv[i] << "', using ans" << endl;
+            }
+        } else if (arg == "--output" && i + 1 < argc) {
+            OutputTarget target;
+            if (parse_output_target(argv[++i], target)) {
+                args.outputs.push_back(target);
+            } else {
+                cerr << "Warning: Output '" << argv[i] << "' is not <format>:<file> with format ans, txt, html, svg, png, sixel or kitty, skipping it" << endl;
+            }
+        } else if (arg == "--precision" && i + 1 < argc) {
+            string precision = argv[++i];
+            if (precision == "fixed" || precision == "double") {
+                args.use_fixed_point = precision == "fixed";
+            } else {
+                cerr << "Warning: Unknown precision '" << precision << "', using fixed" << endl;
+            }
+        } else if (arg == "--isa" && i + 1 < argc) {
+            if (!parse_isa(argv[++i], args.isa)) {
+                cerr << "Warning: Unknown instruction set '" << argv[i] << "', using auto" << endl;
+            } else if (!is_isa_supported(args.isa)) {
+                cerr << "Warning: CPU does not support '" << argv[i] << "', using " << get_isa_name(detect_isa()) << endl;
+                args.isa = ISA_AUTO;
+            }
+        } else if (arg == "--progressive") {
+            args.progressive = true;
+        } else if (arg == "--no-thumbnail") {
+            args.use_thumbnail = false;
+        } else if (arg == "--linear") {
+            args.linear_light = true;
+        } else if (arg == "--charset" && i + 1 < argc) {
+            args.charset = argv[++i];
+        } else if (arg == "--charset-cache" && i + 1 < argc) {
+            args.charset_cache = argv[++i];
+        } else if (arg == "--shapes") {
+            args.shapes = true;
+        } else if (arg == "--profile") {
+            args.profile = true;
+        } else if (arg == "--view") {
+            args.viewer = true;
+        } else if (arg == "--live") {
+            args.live_view = true;
+        } else if (arg == "--record" && i + 1 < argc) {
+            args.record_path = argv[++i];
+        } else if (arg == "--frame" && i + 1 < argc) {
+            if (!parse_frame(argv[++i], args.frame)) {
+                cerr << "Error: Invalid frame number '" << argv[i] << "'!" << endl;
+                args.file_path.clear();
+                return args;
+            }
+        } else if (arg == "--video") {
+            args.video = true;
+        } else if (arg == "--threads" && i + 1 < argc) {
+            args.threads = static_cast<size_t>(atoi(argv[++i]));
+        } else if (arg == "--memory-budget" && i + 1 < argc) {
+            if (!parse_size(argv[++i], args.memory_budget)) {
+                cerr << "Warning: Invalid memory budget '" << argv[i] << "', using unlimited" << endl;
+                args.memory_budget = 0;
+            }
+        } else if (arg == "--background" && i + 1 < argc) {
+            if (!parse_color(argv[++i], args.background)) {
+                cerr << "Warning: Invalid background color '" << argv[i] << "', using black" << endl;
+                fill(args.background, args.background + 3, 0);
+            }
         } else {
             cerr << "Warning: Ignoring invalid or incomplete argument '" << argv[i] << "'" << endl;
         }
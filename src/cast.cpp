@@ -0,0 +1,165 @@
+#include <algorithm>
+#include <cstring>
+#include <ctime>
+
+#include "../include/cast.hpp"
+
+using namespace std;
+
+// Escape of each byte inside a JSON string: 0 for none, 1 for \u00XX, else the letter after the backslash
+static const uint8_t* get_json_escapes() {
+    static const vector<uint8_t> table = [] {
+        vector<uint8_t> entries(256, 0);
+        for (size_t c = 0; c < 0x20; c++) {
+            entries[c] = 1;
+        }
+        entries['\b'] = 'b';
+        entries['\f'] = 'f';
+        entries['\n'] = 'n';
+        entries['\r'] = 'r';
+        entries['\t'] = 't';
+        entries['"'] = '"';
+        entries['\\'] = '\\';
+        entries[0x7f] = 1;
+        return entries;
+    }();
+    return table.data();
+}
+
+void append_json_string(string& out, const char* data, size_t n) {
+    static const char HEX_DIGITS[] = "0123456789abcdef";
+    const uint8_t* escapes = get_json_escapes();
+    size_t run = 0;
+    for (size_t i = 0; i < n; i++) {
+        uint8_t escape = escapes[static_cast<uint8_t>(data[i])];
+        if (escape == 0) {
+            continue;
+        }
+        out.append(data + run, i - run);
+        run = i + 1;
+        if (escape == 1) {
+            char unicode[] = {'\\', 'u', '0', '0', HEX_DIGITS[static_cast<uint8_t>(data[i]) >> 4], HEX_DIGITS[data[i] & 15]};
+            out.append(unicode, sizeof(unicode));
+        } else {
+            out += '\\';
+            out += static_cast<char>(escape);
+        }
+    }
+    out.append(data + run, n - run);
+}
+
+bool CastRecorder::open(const string& path, size_t columns, size_t rows) {
+    close();
+    file = fopen(path.c_str(), "wb");
+    if (!file) {
+        return false;
+    }
+    out = make_unique<OutputBuffer>(file);
+    start = chrono::steady_clock::now();
+    this->columns = columns;
+    this->rows = rows;
+    failed = false;
+    header_written = false;
+    previous = CellGrid();
+    return true;
+}
+
+void CastRecorder::write_header(size_t width, size_t height) {
+    out->write("{\"version\": 2, \"width\": " + to_string(width) + ", \"height\": " + to_string(height) + ", \"timestamp\": " + to_string(time(nullptr)) +
+               ", \"env\": {\"TERM\": \"xterm-256color\"}}\n");
+    columns = width;
+    rows = height;
+    header_written = true;
+}
+
+void CastRecorder::write_event(const char* type, const string& data) {
+    chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+    char stamp[32];
+    string line(stamp, snprintf(stamp, sizeof(stamp), "[%.6f, \"", elapsed.count()));
+    line += type;
+    line += "\", \"";
+    append_json_string(line, data.data(), data.size());
+    line += "\"]\n";
+    out->write(line);
+
+    // Each event reaches the file as it happens, so an interrupted recording keeps its frames
+    failed = !out->flush() || failed;
+}
+
+void CastRecorder::resize(size_t columns, size_t rows) {
+    if (!file || (columns == this->columns && rows == this->rows)) {
+        return;
+    }
+    if (!header_written) {
+        // Nothing recorded yet: the header takes the size
+        this->columns = columns;
+        this->rows = rows;
+        return;
+    }
+    write_event("r", to_string(columns) + "x" + to_string(rows));
+    this->columns = columns;
+    this->rows = rows;
+    previous = CellGrid();
+}
+
+void CastRecorder::record_frame(const CellGrid& frame) {
+    if (!file || frame.empty()) {
+        return;
+    }
+    if (!header_written) {
+        write_header(columns ? columns : frame.width, rows ? rows : frame.height);
+    }
+
+    // Runs of changed cells, each from an absolute position; a color escape only where it changes
+    bool whole = previous.width != frame.width || previous.height != frame.height || previous.charset != frame.charset || previous.palette != frame.palette ||
+                 previous.has_edges != frame.has_edges;
+    event.assign(whole ? "\x1b[H\x1b[2J" : "");
+    char last_escape[MAX_COLOR_ESCAPE];
+    size_t last_length = 0;
+    for (size_t y = 0; y < frame.height; y++) {
+        bool in_run = false;
+        for (size_t x = 0; x < frame.width; x++) {
+            const Cell& cell = frame.at(x, y);
+            if (!whole && memcmp(&cell, &previous.at(x, y), sizeof(Cell)) == 0) {
+                in_run = false;
+                continue;
+            }
+            if (!in_run) {
+                event += "\x1b[" + to_string(y + 1) + ";" + to_string(x + 1) + "H";
+                in_run = true;
+            }
+
+            char escape[MAX_COLOR_ESCAPE];
+            size_t length = format_color_escape(cell, frame.palette, escape);
+            if (length != last_length || memcmp(escape, last_escape, length) != 0) {
+                event.append(escape, length);
+                memcpy(last_escape, escape, length);
+                last_length = length;
+            }
+            event += frame.has_edges ? get_cell_glyph(cell, *frame.charset) : frame.charset->glyphs[cell.glyph_class];
+        }
+    }
+
+    // An unchanged frame leaves nothing to record
+    if (last_length > 0 || whole) {
+        event += "\x1b[0m";
+        write_event("o", event);
+    }
+    previous = frame;
+}
+
+bool CastRecorder::close() {
+    if (!file) {
+        return !failed;
+    }
+    if (!header_written) {
+        // A recording without frames is still a valid cast
+        write_header(max(columns, static_cast<size_t>(1)), max(rows, static_cast<size_t>(1)));
+    }
+    bool written = out->flush() && !failed;
+    out.reset();
+    written = fclose(file) == 0 && written;
+    file = nullptr;
+    failed = !written;
+    return written;
+}
\ No newline at end of file
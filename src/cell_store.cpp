@@ -0,0 +1,312 @@
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+
+#include "../include/cell_store.hpp"
+#include "../include/print_image.hpp"
+
+using namespace std;
+
+// File layout, little-endian throughout:
+//   header   magic, frame count (u32), reserved (u32), index offset (u64, 0 until closed), reserved (u64)
+//   charset  glyph count (u32), then each glyph as its length (u8) and UTF-8 bytes
+//   records  time (u64 us), width, height (u32), has_edges, palette, keyframe, reserved (u8),
+//            run count (u32), then each run as its first cell, cell count (u32) and the cells
+//   index    offset, time (u64), keyframe (u32), reserved (u32) of every record
+static const char CELL_STORE_MAGIC[8] = {'A', 'C', 'E', 'L', 'L', 'S', 0, 1};
+constexpr size_t HEADER_SIZE = 32;
+constexpr size_t RECORD_HEADER_SIZE = 24;
+constexpr size_t RUN_HEADER_SIZE = 8;
+constexpr size_t INDEX_ENTRY_SIZE = 24;
+
+// Unchanged cells a run spans rather than end: one costs less than the next run's header
+constexpr size_t RUN_MERGE_GAP = RUN_HEADER_SIZE / sizeof(Cell);
+
+static void put_u32(string& out, uint32_t value) {
+    char bytes[4] = {char(value), char(value >> 8), char(value >> 16), char(value >> 24)};
+    out.append(bytes, 4);
+}
+
+static void put_u64(string& out, uint64_t value) {
+    put_u32(out, static_cast<uint32_t>(value));
+    put_u32(out, static_cast<uint32_t>(value >> 32));
+}
+
+static uint32_t get_u32(const uint8_t* data) {
+    return uint32_t(data[0]) | (uint32_t(data[1]) << 8) | (uint32_t(data[2]) << 16) | (uint32_t(data[3]) << 24);
+}
+
+static uint64_t get_u64(const uint8_t* data) {
+    return get_u32(data) | (uint64_t(get_u32(data + 4)) << 32);
+}
+
+bool is_cell_store_path(const string& path) {
+    static const string EXTENSION = ".acells";
+    return path.size() > EXTENSION.size() && path.compare(path.size() - EXTENSION.size(), EXTENSION.size(), EXTENSION) == 0;
+}
+
+bool CellStoreWriter::open(const string& path) {
+    close();
+    file = fopen(path.c_str(), "wb");
+    if (!file) {
+        return false;
+    }
+    out = make_unique<OutputBuffer>(file);
+    start = chrono::steady_clock::now();
+    failed = false;
+    previous = CellGrid();
+    index.clear();
+
+    // The frame count and index offset are filled in on close
+    string header(CELL_STORE_MAGIC, sizeof(CELL_STORE_MAGIC));
+    header.resize(HEADER_SIZE, '\0');
+    out->write(header);
+    offset = HEADER_SIZE;
+    return true;
+}
+
+void CellStoreWriter::record_frame(const CellGrid& frame) {
+    if (!file || frame.empty()) {
+        return;
+    }
+
+    record.clear();
+    if (index.empty()) {
+        // Glyphs are stored once: a recording draws with a single charset
+        put_u32(record, static_cast<uint32_t>(frame.charset->glyphs.size()));
+        for (const string& glyph : frame.charset->glyphs) {
+            record += static_cast<char>(min(glyph.size(), static_cast<size_t>(255)));
+            record.append(glyph, 0, 255);
+        }
+    }
+
+    bool keyframe = index.empty() || previous.width != frame.width || previous.height != frame.height || previous.has_edges != frame.has_edges || previous.palette != frame.palette ||
+                    index.size() - index.back().keyframe >= CELL_STORE_KEYFRAME_INTERVAL;
+    CellStoreEntry entry;
+    entry.offset = offset + record.size();
+    entry.time_us = chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - start).count();
+    entry.keyframe = keyframe ? static_cast<uint32_t>(index.size()) : index.back().keyframe;
+
+    put_u64(record, entry.time_us);
+    put_u32(record, static_cast<uint32_t>(frame.width));
+    put_u32(record, static_cast<uint32_t>(frame.height));
+    record += {static_cast<char>(frame.has_edges), static_cast<char>(frame.palette), static_cast<char>(keyframe), 0};
+    size_t runs_at = record.size();
+    put_u32(record, 0);
+
+    // Runs of changed cells; a keyframe is a single run of all of them
+    uint32_t n_runs = 0;
+    size_t n = frame.cells.size();
+    for (size_t i = 0; i < n;) {
+        auto changed = [&](size_t k) { return keyframe || memcmp(&frame.cells[k], &previous.cells[k], sizeof(Cell)) != 0; };
+        if (!changed(i)) {
+            i++;
+            continue;
+        }
+        size_t end = i + 1;
+        for (size_t gap = 0; end + gap < n && gap <= RUN_MERGE_GAP;) {
+            if (changed(end + gap)) {
+                end += gap + 1;
+                gap = 0;
+            } else {
+                gap++;
+            }
+        }
+        put_u32(record, static_cast<uint32_t>(i));
+        put_u32(record, static_cast<uint32_t>(end - i));
+        record.append(reinterpret_cast<const char*>(&frame.cells[i]), (end - i) * sizeof(Cell));
+        n_runs++;
+        i = end;
+    }
+    string count;
+    put_u32(count, n_runs);
+    record.replace(runs_at, 4, count);
+
+    // Each record reaches the file as it is made, so a recording cut short keeps its frames
+    out->write(record);
+    failed = !out->flush() || failed;
+    offset += record.size();
+    index.push_back(entry);
+    previous = frame;
+}
+
+bool CellStoreWriter::close() {
+    if (!file) {
+        return !failed;
+    }
+
+    string tail;
+    if (index.empty()) {
+        put_u32(tail, 0);  // No frames, no glyphs
+    }
+    uint64_t index_offset = offset + tail.size();
+    for (const CellStoreEntry& entry : index) {
+        put_u64(tail, entry.offset);
+        put_u64(tail, entry.time_us);
+        put_u32(tail, entry.keyframe);
+        put_u32(tail, 0);
+    }
+    out->write(tail);
+    bool written = out->flush() && !failed;
+    out.reset();
+
+    // Now that the index is complete, the header points at it
+    string counts;
+    put_u32(counts, static_cast<uint32_t>(index.size()));
+    put_u32(counts, 0);
+    put_u64(counts, index_offset);
+    written = fseek(file, sizeof(CELL_STORE_MAGIC), SEEK_SET) == 0 && fwrite(counts.data(), 1, counts.size(), file) == counts.size() && written;
+    written = fclose(file) == 0 && written;
+    file = nullptr;
+    failed = !written;
+    return written;
+}
+
+bool CellStore::open(const string& path) {
+    file = MappedFile::open(path);
+    index.clear();
+    charset = Charset();
+    if (!file || file->size < HEADER_SIZE + 4 || memcmp(file->data, CELL_STORE_MAGIC, sizeof(CELL_STORE_MAGIC)) != 0) {
+        return false;
+    }
+    const uint8_t* data = file->data;
+    size_t size = file->size;
+
+    size_t position = HEADER_SIZE;
+    uint32_t n_glyphs = get_u32(data + position);
+    position += 4;
+    for (uint32_t g = 0; g < n_glyphs; g++) {
+        if (position >= size || position + 1 + data[position] > size) {
+            return false;
+        }
+        charset.glyphs.emplace_back(reinterpret_cast<const char*>(data + position + 1), data[position]);
+        position += 1 + data[position];
+    }
+
+    uint32_t n_frames = get_u32(data + 8);
+    uint64_t index_offset = get_u64(data + 16);
+    if (index_offset != 0) {
+        if (index_offset < position || index_offset > size || (size - index_offset) / INDEX_ENTRY_SIZE < n_frames) {
+            return false;
+        }
+        index.resize(n_frames);
+        for (size_t i = 0; i < n_frames; i++) {
+            const uint8_t* entry = data + index_offset + i * INDEX_ENTRY_SIZE;
+            index[i].offset = get_u64(entry);
+            index[i].time_us = get_u64(entry + 8);
+            index[i].keyframe = get_u32(entry + 16);
+            // Compared without adding, so that offsets near the top of the range cannot wrap
+            if (index[i].offset < position || index_offset < RECORD_HEADER_SIZE || index[i].offset > index_offset - RECORD_HEADER_SIZE || index[i].keyframe > i) {
+                return false;
+            }
+            if (data[index[index[i].keyframe].offset + 18] == 0) {
+                return false;
+            }
+            if (index[i].time_us > MAX_CELL_STORE_TIME_US || (i > 0 && index[i].time_us < index[i - 1].time_us)) {
+                return false;
+            }
+        }
+        // Every cell has a glyph class, even blank ones, so frames need glyphs
+        return n_glyphs > 0 || index.empty();
+    }
+
+    // No index: the recording was cut short, so walk its whole records
+    while (position + RECORD_HEADER_SIZE <= size) {
+        const uint8_t* record = data + position;
+        size_t end = position + RECORD_HEADER_SIZE;
+        uint32_t n_runs = get_u32(record + 20);
+        for (uint32_t r = 0; r < n_runs && end <= size; r++) {
+            end = end + RUN_HEADER_SIZE > size ? size + 1 : end + RUN_HEADER_SIZE + size_t(get_u32(data + end + 4)) * sizeof(Cell);
+        }
+        bool keyframe = record[18] != 0;
+        uint64_t time_us = get_u64(record);
+        if (end > size || (!keyframe && index.empty()) || time_us > MAX_CELL_STORE_TIME_US || (!index.empty() && time_us < index.back().time_us)) {
+            break;
+        }
+
+        CellStoreEntry entry;
+        entry.offset = position;
+        entry.time_us = time_us;
+        entry.keyframe = keyframe ? static_cast<uint32_t>(index.size()) : index.back().keyframe;
+        index.push_back(entry);
+        position = end;
+    }
+    return n_glyphs > 0 || index.empty();
+}
+
+void CellStore::apply_frame(size_t frame, CellGrid& grid) const {
+    const uint8_t* data = file->data;
+    size_t size = file->size;
+    size_t position = index[frame].offset;
+    const uint8_t* record = data + position;
+    size_t width = get_u32(record + 8), height = get_u32(record + 12);
+
+    if (record[18]) {
+        if (width * height > size / sizeof(Cell) || record[17] > PALETTE_256) {
+            throw runtime_error("Damaged cell store record");
+        }
+        grid.width = width;
+        grid.height = height;
+        grid.has_edges = record[16] != 0;
+        grid.palette = static_cast<Palette>(record[17]);
+        grid.charset = &charset;
+        grid.cells.assign(width * height, Cell());
+    } else if (grid.width != width || grid.height != height) {
+        throw runtime_error("Cell store frame does not follow the one before");
+    }
+
+    uint32_t n_runs = get_u32(record + 20);
+    position += RECORD_HEADER_SIZE;
+    for (uint32_t r = 0; r < n_runs; r++) {
+        if (position + RUN_HEADER_SIZE > size) {
+            throw runtime_error("Damaged cell store record");
+        }
+        size_t first = get_u32(data + position), count = get_u32(data + position + 4);
+        position += RUN_HEADER_SIZE;
+        if (first + count > grid.cells.size() || count * sizeof(Cell) > size - position) {
+            throw runtime_error("Damaged cell store record");
+        }
+        memcpy(&grid.cells[first], data + position, count * sizeof(Cell));
+        position += count * sizeof(Cell);
+
+        // Glyph classes and edges index the charset and EDGE_CHARS when the cells are written
+        for (size_t k = first; k < first + count; k++) {
+            if (grid.cells[k].glyph_class >= charset.glyphs.size() || grid.cells[k].edge_dir > EDGE_SLASH) {
+                throw runtime_error("Damaged cell store record");
+            }
+        }
+    }
+}
+
+CellGrid CellStore::get_frame(size_t frame) const {
+    CellGrid grid;
+    for (size_t i = index[frame].keyframe; i <= frame; i++) {
+        apply_frame(i, grid);
+    }
+    return grid;
+}
+
+void play_cell_store(const CellStore& store, FrameRecorder* recorder) {
+    CellGrid frame, shown;
+    auto start = chrono::steady_clock::now();
+    for (size_t i = 0; i < store.size(); i++) {
+        store.apply_frame(i, frame);
+        this_thread::sleep_until(start + store.get_time(i));
+
+        // Frames of one size repaint their changes; a new size starts over on a clear screen
+        if (!shown.empty() && shown.width == frame.width && shown.height == frame.height) {
+            repaint_image(shown, frame);
+        } else {
+            if (!shown.empty()) {
+                cout << "\x1b[H\x1b[2J";
+            }
+            print_image(frame);
+            cout << flush;
+        }
+        if (recorder) {
+            recorder->record_frame(frame);
+        }
+        shown = frame;
+    }
+}
\ No newline at end of file
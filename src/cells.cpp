@@ -0,0 +1,1429 @@
+#define _USE_MATH_DEFINES
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../include/cells.hpp"
+#include "../include/charset.hpp"
+#include "../include/color.hpp"
+#include "../include/font.hpp"
+#include "../include/kernels.hpp"
+#include "../include/source.hpp"
+#include "../include/summed_area.hpp"
+
+using namespace std;
+
+const string VALUE_CHARS = " .-=+*x#$&X@";
+const string EDGE_CHARS[] = {" ", "|", "\\", "_", "/"};
+
+uint8_t get_sobel_edge_dir(double sobel_angle) {
+    if ((22.5 <= sobel_angle && sobel_angle <= 67.5) || (-157.5 <= sobel_angle && sobel_angle <= -112.5))
+        return EDGE_BACKSLASH;
+    else if ((67.5 <= sobel_angle && sobel_angle <= 112.5) || (-112.5 <= sobel_angle && sobel_angle <= -67.5))
+        return EDGE_HORIZONTAL;
+    else if ((112.5 <= sobel_angle && sobel_angle <= 157.5) || (-67.5 <= sobel_angle && sobel_angle <= -22.5))
+        return EDGE_SLASH;
+    else
+        return EDGE_VERTICAL;
+}
+
+const string& get_cell_glyph(const Cell& cell, const Charset& charset) {
+    if (cell.edge_dir != EDGE_NONE) {
+        return EDGE_CHARS[cell.edge_dir];
+    }
+    return charset.glyphs[cell.glyph_class];
+}
+
+// Double equivalent of the composite_row_u8 kernels, rounded to 8 bits the same way.
+// Composites of 8-bit inputs are never exactly halfway, so the rounding always agrees.
+template <size_t Channels>
+static void composite_row(double* out, const double* row, size_t n, const double* background) {
+    for (size_t k = 0; k < n * Channels; k += Channels) {
+        double alpha = row[k + Channels - 1];
+        for (size_t c = 0; c + 1 < Channels; c++) {
+            out[k + c] = static_cast<int32_t>(255.0 * (row[k + c] * alpha + background[c] * (1.0 - alpha)) + 0.5) / 255.0;
+        }
+        out[k + Channels - 1] = 1.0;
+    }
+}
+
+template <size_t Channels, bool Edges>
+static void analyze_rows(const Image& original, const Kernels& kernels, ShadeRowFn shade_row, double edge_threshold, const double* background, const double* linear_values,
+                         CellGrid& grid) {
+    size_t width = grid.width;
+    size_t height = grid.height;
+    size_t row_size = original.width * Channels;
+    double threshold_squared = edge_threshold * edge_threshold;
+    LumaRowFn luma_row = kernels.luma_row[Channels - 1];
+
+    // Per-column sums of the source rows covered by the current cell row
+    vector<double> column_sums(row_size, 0.0);
+
+    // Rows with alpha are composited over the background, and in linear light converted
+    // through the table, before they are summed
+    vector<double> converted(has_alpha(Channels) || linear_values ? row_size : 0);
+    size_t n_colors = has_alpha(Channels) ? Channels - 1 : Channels;
+
+    // Ring of the last three averaged cell rows and their luminance
+    vector<double> averages(3 * width * Channels, 0.0);
+    vector<double> luminance(3 * width, 0.0);
+    vector<double> sobel_x(width, 0.0);
+    vector<double> sobel_y(width, 0.0);
+
+    // Emits cell row `j` once the luminance of row `j + 1` is known
+    auto emit_row = [&](size_t j) {
+        Cell* cells = &grid.cells[j * width];
+        shade_row(&averages[(j % 3) * width * Channels], width, grid.charset->levels, cells);
+
+        if constexpr (Edges) {
+            if (j > 0 && j + 1 < height) {
+                const double* above = &luminance[((j + 2) % 3) * width];
+                const double* row = &luminance[(j % 3) * width];
+                const double* below = &luminance[((j + 1) % 3) * width];
+                kernels.sobel_row(above, row, below, width, sobel_x.data(), sobel_y.data());
+            } else {
+                fill(sobel_x.begin(), sobel_x.end(), 0.0);
+                fill(sobel_y.begin(), sobel_y.end(), 0.0);
+            }
+
+            for (size_t x = 0; x < width; x++) {
+                double sx = sobel_x[x];
+                double sy = sobel_y[x];
+
+                // If edge
+                if (sx * sx + sy * sy >= threshold_squared) {
+                    cells[x].edge_dir = get_sobel_edge_dir(atan2(sy, sx) * 180.0 / M_PI);
+                }
+            }
+        }
+    };
+
+    for (size_t j = 0; j < height; j++) {
+        size_t y1 = (j * original.height) / height;
+        size_t y2 = ((j + 1) * original.height) / height;
+
+        // Sum the band of source rows covered by this cell row, column by column
+        fill(column_sums.begin(), column_sums.end(), 0.0);
+        for (size_t y = y1; y < y2; y++) {
+            const double* row = &original.data[y * row_size];
+            if constexpr (has_alpha(Channels)) {
+                composite_row<Channels>(converted.data(), row, original.width, background);
+                row = converted.data();
+            }
+            if (linear_values) {
+                // Composited rows are still on the 8-bit grid
+                for (size_t k = 0; k < row_size; k++) {
+                    converted[k] = linear_values[static_cast<int32_t>(row[k] * 255.0 + 0.5)];
+                }
+                row = converted.data();
+            }
+            kernels.accumulate_row(column_sums.data(), row, row_size);
+        }
+
+        // Reduce each box and divide by its number of pixels
+        double* row_average = &averages[(j % 3) * width * Channels];
+        for (size_t i = 0; i < width; i++) {
+            size_t x1 = (i * original.width) / width;
+            size_t x2 = ((i + 1) * original.width) / width;
+            double n_pixels = static_cast<double>((x2 - x1) * (y2 - y1));
+
+            double average[Channels] = {};
+            for (size_t x = x1; x < x2; x++) {
+                for (size_t c = 0; c < Channels; c++) {
+                    average[c] += column_sums[x * Channels + c];
+                }
+            }
+
+            for (size_t c = 0; c < Channels; c++) {
+                row_average[i * Channels + c] = n_pixels > 0 ? average[c] / n_pixels : average[c];
+            }
+            if (linear_values) {
+                for (size_t c = 0; c < n_colors; c++) {
+                    row_average[i * Channels + c] = linear_to_srgb(row_average[i * Channels + c]);
+                }
+            }
+        }
+
+        if constexpr (Edges) {
+            luma_row(row_average, width, &luminance[(j % 3) * width]);
+        }
+
+        if (j > 0) {
+            emit_row(j - 1);
+        }
+    }
+
+    if (height > 0) {
+        emit_row(height - 1);
+    }
+}
+
+template <size_t Channels>
+static void analyze_rows(const Image& original, const Kernels& kernels, const AnalysisOptions& options, CellGrid& grid) {
+    ShadeRowFn shade_row = kernels.shade_row[Channels - 1][options.color_mode];
+    uint8_t pixel[MAX_CHANNELS];
+    double background[MAX_CHANNELS];
+    get_background_pixel(options, Channels, pixel);
+    for (size_t c = 0; c < Channels; c++) {
+        background[c] = pixel[c] / 255.0;
+    }
+    const double* linear_values = options.linear_light ? get_linear_values() : nullptr;
+
+    // Edge detection is disabled at the top of the threshold range
+    if (grid.has_edges) {
+        analyze_rows<Channels, true>(original, kernels, shade_row, options.edge_threshold, background, linear_values, grid);
+    } else {
+        analyze_rows<Channels, false>(original, kernels, shade_row, options.edge_threshold, background, linear_values, grid);
+    }
+}
+
+CellGrid analyze_cells(const Image& original, size_t width, size_t height, const AnalysisOptions& options) {
+    CellGrid grid;
+    grid.width = width;
+    grid.height = height;
+    grid.has_edges = options.edge_threshold < 4.0;
+    grid.charset = options.charset;
+    grid.cells.resize(width * height);
+
+    const Kernels& kernels = get_kernels(options.isa);
+    switch (original.channels) {
+        case 1:
+            analyze_rows<1>(original, kernels, options, grid);
+            break;
+        case 2:
+            analyze_rows<2>(original, kernels, options, grid);
+            break;
+        case 3:
+            analyze_rows<3>(original, kernels, options, grid);
+            break;
+        case 4:
+            analyze_rows<4>(original, kernels, options, grid);
+            break;
+        default:
+            throw invalid_argument("Image must have 1 to 4 channels");
+    }
+
+    return grid;
+}
+
+// ---------------------------------------------------------------------------
+// Fixed-point pipeline. Works on 8-bit sums end to end: glyphs and colors are
+// exact functions of each box's channel sums, and luminance is scaled to 1 << 16.
+
+// BT.709 weights scaled to 1 << 16; they sum to exactly 1 << 16
+constexpr uint64_t LUMA_RED = 13933;
+constexpr uint64_t LUMA_GREEN = 46871;
+constexpr uint64_t LUMA_BLUE = 4732;
+
+// tan(22.5°) and tan(67.5°) scaled to 1 << 32, for bucketing the Sobel angle without atan2
+constexpr uint64_t TAN_22_5 = 1779033704;
+constexpr uint64_t TAN_67_5 = 10368968296;
+
+// Rows of 8-bit samples a 16-bit column sum can hold without overflowing
+constexpr size_t MAX_PARTIAL_ROWS = 257;
+
+// Same for 12-bit linear light samples
+constexpr size_t MAX_PARTIAL_LINEAR_ROWS = 65535 / LINEAR_MAX;
+
+// Brightness level of (numerator / denominator), optionally squared. Exact while the
+// squares fit in 64 bits; boxes beyond 2^26 / 255 pixels fall back to double.
+static uint8_t get_brightness_level_fixed(uint64_t numerator, uint64_t denominator, bool squared) {
+    const uint64_t n_levels = N_BRIGHTNESS_LEVELS;
+    if (denominator == 0) {
+        return 0;
+    }
+
+    uint64_t level;
+    if (!squared) {
+        level = n_levels * numerator / denominator;
+    } else if (denominator < (1ull << 26)) {
+        level = n_levels * numerator * numerator / (denominator * denominator);
+    } else {
+        double ratio = static_cast<double>(numerator) / denominator;
+        level = static_cast<uint64_t>(n_levels * ratio * ratio);
+    }
+
+    return static_cast<uint8_t>(min(level, n_levels - 1));
+}
+
+static uint8_t get_sobel_edge_dir_fixed(int32_t sx, int32_t sy) {
+    if (sx == 0) {
+        return sy == 0 ? EDGE_VERTICAL : EDGE_HORIZONTAL;
+    }
+
+    // Compare |sy| / |sx| against the bucket boundaries
+    uint64_t rise = static_cast<uint64_t>(sy < 0 ? -static_cast<int64_t>(sy) : sy) << 32;
+    uint64_t run = static_cast<uint64_t>(sx < 0 ? -static_cast<int64_t>(sx) : sx);
+
+    if (rise < run * TAN_22_5) {
+        return EDGE_VERTICAL;
+    } else if (rise > run * TAN_67_5) {
+        return EDGE_HORIZONTAL;
+    }
+    return (sx < 0) == (sy < 0) ? EDGE_BACKSLASH : EDGE_SLASH;
+}
+
+// Mean of n_pixels linear light samples that add up to `sum`, back in sRGB scaled to 255 << 8.
+// The table is interpolated in steps of 1 / 256, so the mean keeps its fraction.
+static uint64_t get_srgb_mean(uint64_t sum, uint64_t n_pixels, const uint16_t* srgb_table) {
+    uint64_t mean = (sum << 8) / n_pixels;
+    uint64_t index = mean >> 8;
+    if (index >= LINEAR_MAX) {
+        return srgb_table[LINEAR_MAX];
+    }
+    uint64_t low = srgb_table[index], high = srgb_table[index + 1];
+    return low + (((high - low) * (mean & 255) + 128) >> 8);
+}
+
+// Fixed-point equivalent of shade_row_scalar for one box of n_pixels pixels
+template <size_t Channels, ColorMode Mode>
+static void shade_cell_fixed(const uint64_t* sums, uint64_t n_pixels, const uint8_t* glyph_levels, Cell& cell, int32_t& luminance) {
+    // Sums are compared against the sum of a full-intensity box
+    uint64_t full = 255 * n_pixels;
+    uint64_t r, g, b;
+
+    if constexpr (Channels <= 2) {
+        // Grayscale image
+        cell.glyph_class = glyph_levels[get_brightness_level_fixed(sums[0], full, false)];
+        r = g = b = n_pixels ? sums[0] / n_pixels : 0;
+        luminance = full ? static_cast<int32_t>((sums[0] << 16) / full) : 0;
+    } else {
+        // RGB image
+        uint64_t max_val = max({sums[0], sums[1], sums[2]});
+        uint64_t min_val = min({sums[0], sums[1], sums[2]});
+        uint64_t chroma = max_val - min_val;
+
+        // Value squared for increased contrast
+        cell.glyph_class = glyph_levels[get_brightness_level_fixed(max_val, full, true)];
+        luminance = full ? static_cast<int32_t>((LUMA_RED * sums[0] + LUMA_GREEN * sums[1] + LUMA_BLUE * sums[2]) / full) : 0;
+
+        // Thresholds of rgb_to_hsv: value below 1e-4 has no saturation, chroma below 1e-4 has no hue
+        bool no_saturation = n_pixels == 0 || max_val * 10000 < full;
+        bool no_hue = chroma * 10000 < full;
+
+        if constexpr (Mode == COLOR_RETRO) {
+            // Nearest of the 6 hues at full saturation, or white below 25% saturation
+            static const uint8_t HUES[6][3] = {{1, 0, 0}, {1, 1, 0}, {0, 1, 0}, {0, 1, 1}, {0, 0, 1}, {1, 0, 1}};
+            int hue = 0;
+            if (!no_hue) {
+                // Rounds (60 * sector + 60 * delta / chroma) to a multiple of 60, with 360 wrapping to 0
+                auto nearest = [&](int64_t delta, int sector, int below) {
+                    int64_t twice = 2 * delta, c = static_cast<int64_t>(chroma);
+                    return twice >= c ? (sector + 1) % 6 : (twice >= -c ? sector : below);
+                };
+                if (max_val == sums[0]) {
+                    hue = nearest(static_cast<int64_t>(sums[1]) - static_cast<int64_t>(sums[2]), 0, 5);
+                } else if (max_val == sums[1]) {
+                    hue = nearest(static_cast<int64_t>(sums[2]) - static_cast<int64_t>(sums[0]), 2, 1);
+                } else {
+                    hue = nearest(static_cast<int64_t>(sums[0]) - static_cast<int64_t>(sums[1]), 4, 3);
+                }
+            }
+
+            bool white = no_saturation || 4 * chroma < max_val;
+            r = white ? 255 : 255 * HUES[hue][0];
+            g = white ? 255 : 255 * HUES[hue][1];
+            b = white ? 255 : 255 * HUES[hue][2];
+        } else if (no_saturation) {
+            r = g = b = 255;
+        } else if (no_hue) {
+            // hsv_to_rgb with hue 0: red at full value, the others scaled by min / max
+            r = 255;
+            g = b = 255 * min_val / max_val;
+        } else {
+            // Full value HSV is each channel divided by the maximum
+            r = 255 * sums[0] / max_val;
+            g = 255 * sums[1] / max_val;
+            b = 255 * sums[2] / max_val;
+        }
+    }
+
+    cell.r = static_cast<uint8_t>(r);
+    cell.g = static_cast<uint8_t>(g);
+    cell.b = static_cast<uint8_t>(b);
+    cell.edge_dir = EDGE_NONE;
+}
+
+// shade_cell_fixed of a box whose sums are of linear light when there is an `srgb_table`:
+// the box is then shaded as 256 pixels of its mean converted back to sRGB
+template <size_t Channels, ColorMode Mode>
+static void shade_box_fixed(const uint64_t* sums, uint64_t n_pixels, const uint16_t* srgb_table, const uint8_t* glyph_levels, Cell& cell, int32_t& luminance) {
+    if (!srgb_table || n_pixels == 0) {
+        shade_cell_fixed<Channels, Mode>(sums, n_pixels, glyph_levels, cell, luminance);
+        return;
+    }
+
+    uint64_t srgb_sums[Channels] = {};
+    for (size_t c = 0; c < (has_alpha(Channels) ? Channels - 1 : Channels); c++) {
+        srgb_sums[c] = get_srgb_mean(sums[c], n_pixels, srgb_table);
+    }
+    shade_cell_fixed<Channels, Mode>(srgb_sums, 256, glyph_levels, cell, luminance);
+}
+
+// Runs `work(worker)` on `threads` threads, including the calling one
+template <typename F>
+static void run_workers(size_t threads, F work) {
+    vector<thread> pool;
+    for (size_t worker = 1; worker < threads; worker++) {
+        pool.emplace_back(work, worker);
+    }
+    work(0);
+    for (thread& t : pool) {
+        t.join();
+    }
+}
+
+// Splits cell rows [0, height) into one contiguous tile per worker
+template <typename F>
+static void for_each_tile(size_t threads, size_t height, F work) {
+    threads = max(static_cast<size_t>(1), min(threads, height));
+    run_workers(threads, [&](size_t worker) { work((worker * height) / threads, ((worker + 1) * height) / threads); });
+}
+
+struct TilePlan {
+    size_t threads;     // Workers accumulating source rows
+    size_t chunk_rows;  // Source rows per unit of work
+};
+
+// Picks the worker count and chunk height so that the source, the shared cell buffers and
+// every worker's buffers fit in the memory budget. Workers are dropped before chunks shrink.
+static TilePlan plan_tiles(const RowSource& source, size_t width, size_t height, const AnalysisOptions& options) {
+    size_t row_bytes = source.row_bytes();
+    size_t threads = options.threads ? options.threads : max(1u, thread::hardware_concurrency());
+
+    // Chunks never straddle a cell row, so in-memory sources can hand out whole bands
+    size_t band_rows = (source.height + height - 1) / height;
+    TilePlan plan = {threads, band_rows};
+    if (source.is_sequential()) {
+        plan.chunk_rows = max(static_cast<size_t>(1), min(band_rows, (16u << 20) / row_bytes));
+    }
+    if (options.memory_budget == 0) {
+        return plan;
+    }
+
+    // Box sums, luminance and cells for the whole grid, plus the source's own pixels
+    size_t shared = source.resident_bytes() + width * height * (source.channels * sizeof(uint64_t) + sizeof(int32_t) + sizeof(Cell));
+    // 16 and 32-bit column sums, a composited row if the source has alpha, and a row of box sums per worker
+    size_t per_worker = row_bytes * (sizeof(uint16_t) + sizeof(uint32_t) + (has_alpha(source.channels) ? 1 : 0)) + width * source.channels * sizeof(uint64_t);
+    size_t per_row = source.is_sequential() ? row_bytes : 0;
+
+    size_t available = options.memory_budget > shared ? options.memory_budget - shared : 0;
+    plan.threads = max(static_cast<size_t>(1), min(threads, available / (per_worker + per_row)));
+    if (per_row > 0) {
+        size_t worker_budget = available / plan.threads;
+        size_t rows = worker_budget > per_worker ? (worker_budget - per_worker) / per_row : 0;
+        plan.chunk_rows = max(static_cast<size_t>(1), min(plan.chunk_rows, rows));
+    }
+
+    if (available < per_worker + per_row) {
+        cerr << "Warning: Memory budget of " << options.memory_budget << " bytes is below the minimum of " << shared + per_worker + per_row << " for this image" << endl;
+    }
+    return plan;
+}
+
+// Phase 1: sums every source pixel into its cell, where cell (i, j) spans stored columns
+// [column_edges[i], column_edges[i + 1]) and rows [row_edges[j], row_edges[j + 1]). Workers
+// take chunks of rows in top-to-bottom order; sequential sources are read under the scheduling lock.
+// Pixels with alpha are composited over `background` row by row, just before they are summed,
+// and with a `linear_table` the sums are of linear light.
+template <size_t Channels>
+static void accumulate_boxes(RowSource& source, const Kernels& kernels, const vector<size_t>& column_edges, const vector<size_t>& row_edges, const TilePlan& plan,
+                             const uint8_t* background, const uint16_t* linear_table, vector<uint64_t>& box_sums) {
+    size_t width = column_edges.size() - 1;
+    size_t height = row_edges.size() - 1;
+    size_t row_size = source.width * Channels;
+    bool sequential = source.is_sequential();
+
+    mutex schedule_lock;
+    size_t next_y = 0, next_j = 0;
+    bool failed = false;
+    vector<mutex> row_locks(height);
+
+    run_workers(plan.threads, [&](size_t) {
+        // 16-bit column sums are flushed into 32-bit ones before they can overflow
+        size_t partial_rows = linear_table ? MAX_PARTIAL_LINEAR_ROWS : MAX_PARTIAL_ROWS;
+        vector<uint16_t> partial_sums(row_size);
+        vector<uint32_t> column_sums(row_size);
+        vector<uint64_t> row_boxes(width * Channels);
+        vector<uint8_t> buffer(sequential ? plan.chunk_rows * row_size : 0);
+        vector<uint8_t> composited(has_alpha(Channels) ? row_size : 0);
+
+        auto flush_partial_sums = [&]() { kernels.flush_sums(column_sums.data(), partial_sums.data(), row_size); };
+
+        while (true) {
+            size_t j, y, count;
+            const uint8_t* rows = nullptr;
+            {
+                lock_guard<mutex> lock(schedule_lock);
+
+                // Move on to the next cell row whose band still has rows
+                while (next_j < height && next_y >= row_edges[next_j + 1]) {
+                    next_j++;
+                }
+                if (failed || next_j >= height) {
+                    return;
+                }
+
+                j = next_j;
+                y = next_y;
+                count = min(plan.chunk_rows, row_edges[j + 1] - y);
+                if (sequential) {
+                    rows = source.read_rows(y, count, buffer.data());
+                    failed = rows == nullptr;
+                }
+                next_y += count;
+            }
+
+            if (!sequential) {
+                rows = source.read_rows(y, count, nullptr);
+            }
+            if (!rows) {
+                lock_guard<mutex> lock(schedule_lock);
+                failed = true;
+                return;
+            }
+
+            // Sum the chunk column by column
+            fill(partial_sums.begin(), partial_sums.end(), 0);
+            fill(column_sums.begin(), column_sums.end(), 0);
+            for (size_t r = 0; r < count; r++) {
+                const uint8_t* row = rows + r * row_size;
+                if constexpr (has_alpha(Channels)) {
+                    kernels.composite_row_u8[Channels / 2 - 1](composited.data(), row, source.width, background);
+                    row = composited.data();
+                }
+                if (linear_table) {
+                    kernels.accumulate_row_linear(partial_sums.data(), row, row_size, linear_table);
+                } else {
+                    kernels.accumulate_row_u8(partial_sums.data(), row, row_size);
+                }
+                if ((r + 1) % partial_rows == 0) {
+                    flush_partial_sums();
+                }
+            }
+            flush_partial_sums();
+
+            // Reduce each box and add it to the cell row
+            for (size_t i = 0; i < width; i++) {
+                uint64_t* sums = &row_boxes[i * Channels];
+                fill(sums, sums + Channels, 0);
+                for (size_t x = column_edges[i]; x < column_edges[i + 1]; x++) {
+                    for (size_t c = 0; c < Channels; c++) {
+                        sums[c] += column_sums[x * Channels + c];
+                    }
+                }
+            }
+
+            lock_guard<mutex> lock(row_locks[j]);
+            uint64_t* cell_row = &box_sums[j * width * Channels];
+            for (size_t k = 0; k < width * Channels; k++) {
+                cell_row[k] += row_boxes[k];
+            }
+        }
+    });
+
+    if (failed) {
+        throw runtime_error("Failed to read image rows");
+    }
+}
+
+// Phase 2: glyph, color and luminance of cell rows [j0, j1)
+template <size_t Channels, ColorMode Mode>
+static void shade_rows(size_t source_width, size_t source_height, const vector<uint64_t>& box_sums, const uint16_t* srgb_table, size_t j0, size_t j1, CellGrid& grid,
+                       vector<int32_t>& luminance) {
+    size_t width = grid.width;
+    for (size_t j = j0; j < j1; j++) {
+        size_t rows = ((j + 1) * source_height) / grid.height - (j * source_height) / grid.height;
+        for (size_t i = 0; i < width; i++) {
+            size_t columns = ((i + 1) * source_width) / width - (i * source_width) / width;
+            size_t index = j * width + i;
+            shade_box_fixed<Channels, Mode>(&box_sums[index * Channels], columns * rows, srgb_table, grid.charset->levels, grid.cells[index], luminance[index]);
+        }
+    }
+}
+
+// Phase 3: edges of cell rows [j0, j1). Rows j0 - 1 and j1 are the Sobel halo
+// from neighbouring tiles, complete since phase 2 finished.
+static void mark_edges(const Kernels& kernels, const vector<int32_t>& luminance, uint64_t threshold_squared, size_t j0, size_t j1, CellGrid& grid) {
+    size_t width = grid.width;
+    vector<int32_t> sobel_x(width, 0);
+    vector<int32_t> sobel_y(width, 0);
+
+    for (size_t j = j0; j < j1; j++) {
+        if (j == 0 || j + 1 >= grid.height) {
+            // Border rows have no gradient; only a zero threshold marks them
+            fill(sobel_x.begin(), sobel_x.end(), 0);
+            fill(sobel_y.begin(), sobel_y.end(), 0);
+        } else {
+            const int32_t* row = &luminance[j * width];
+            kernels.sobel_row_fixed(row - width, row, row + width, width, sobel_x.data(), sobel_y.data());
+        }
+
+        for (size_t x = 0; x < width; x++) {
+            int64_t sx = sobel_x[x];
+            int64_t sy = sobel_y[x];
+
+            // If edge
+            if (static_cast<uint64_t>(sx * sx + sy * sy) >= threshold_squared) {
+                grid.cells[j * width + x].edge_dir = get_sobel_edge_dir_fixed(sobel_x[x], sobel_y[x]);
+            }
+        }
+    }
+}
+
+// Phases 2 and 3 over finished box sums
+template <size_t Channels, ColorMode Mode>
+static void shade_cells(size_t source_width, size_t source_height, const vector<uint64_t>& box_sums, const uint16_t* srgb_table, const Kernels& kernels, const AnalysisOptions& options,
+                        size_t threads, CellGrid& grid) {
+    vector<int32_t> luminance(grid.width * grid.height, 0);
+    for_each_tile(threads, grid.height, [&](size_t j0, size_t j1) { shade_rows<Channels, Mode>(source_width, source_height, box_sums, srgb_table, j0, j1, grid, luminance); });
+
+    if (grid.has_edges) {
+        // Squared gradient magnitude threshold in luminance units of 1 << 16
+        double limit = options.edge_threshold * options.edge_threshold * 4294967296.0;
+        uint64_t threshold_squared = limit >= 1.8e19 ? UINT64_MAX : static_cast<uint64_t>(ceil(limit));
+
+        for_each_tile(threads, grid.height, [&](size_t j0, size_t j1) { mark_edges(kernels, luminance, threshold_squared, j0, j1, grid); });
+    }
+}
+
+// Orientation is folded into the boxes: pixels are summed in stored order into the grid
+// that turns into `grid` when upright, and only the finished sums are moved into place
+template <size_t Channels, ColorMode Mode>
+static void analyze_tiles(RowSource& source, const Kernels& kernels, const AnalysisOptions& options, CellGrid& grid) {
+    TilePlan plan = plan_tiles(source, grid.width, grid.height, options);
+
+    size_t stored_width, stored_height;
+    get_oriented_dimensions(grid.width, grid.height, source.orientation, stored_width, stored_height);
+    vector<size_t> column_edges(stored_width + 1), row_edges(stored_height + 1);
+    for (size_t j = 0; j < grid.height; j++) {
+        for (size_t i = 0; i < grid.width; i++) {
+            size_t stored_i, stored_j, x1, x2, y1, y2;
+            get_source_position(stored_width, stored_height, source.orientation, i, j, stored_i, stored_j);
+            get_oriented_box(source.width, source.height, source.orientation, grid.width, grid.height, i, j, x1, x2, y1, y2);
+            column_edges[stored_i] = x1;
+            column_edges[stored_i + 1] = x2;
+            row_edges[stored_j] = y1;
+            row_edges[stored_j + 1] = y2;
+        }
+    }
+
+    uint8_t background[MAX_CHANNELS];
+    get_background_pixel(options, Channels, background);
+
+    const uint16_t* linear_table = options.linear_light ? get_linear_table() : nullptr;
+    const uint16_t* srgb_table = options.linear_light ? get_srgb_table() : nullptr;
+
+    vector<uint64_t> box_sums(grid.width * grid.height * Channels, 0);
+    accumulate_boxes<Channels>(source, kernels, column_edges, row_edges, plan, background, linear_table, box_sums);
+
+    if (source.orientation > 1) {
+        vector<uint64_t> upright_sums(box_sums.size());
+        for (size_t j = 0; j < grid.height; j++) {
+            for (size_t i = 0; i < grid.width; i++) {
+                size_t stored_i, stored_j;
+                get_source_position(stored_width, stored_height, source.orientation, i, j, stored_i, stored_j);
+                copy_n(&box_sums[(stored_j * stored_width + stored_i) * Channels], Channels, &upright_sums[(j * grid.width + i) * Channels]);
+            }
+        }
+        box_sums.swap(upright_sums);
+    }
+
+    size_t upright_width, upright_height;
+    get_oriented_dimensions(source.width, source.height, source.orientation, upright_width, upright_height);
+    shade_cells<Channels, Mode>(upright_width, upright_height, box_sums, srgb_table, kernels, options, plan.threads, grid);
+}
+
+template <size_t Channels>
+static void analyze_tiles(RowSource& source, const Kernels& kernels, const AnalysisOptions& options, CellGrid& grid) {
+    if (options.color_mode == COLOR_RETRO) {
+        analyze_tiles<Channels, COLOR_RETRO>(source, kernels, options, grid);
+    } else {
+        analyze_tiles<Channels, COLOR_TRUECOLOR>(source, kernels, options, grid);
+    }
+}
+
+CellGrid analyze_cells(RowSource& source, size_t width, size_t height, const AnalysisOptions& options) {
+    CellGrid grid;
+    grid.width = width;
+    grid.height = height;
+    grid.has_edges = options.edge_threshold < 4.0;
+    grid.charset = options.charset;
+    grid.cells.resize(width * height);
+
+    const Kernels& kernels = get_kernels(options.isa);
+    switch (source.channels) {
+        case 1:
+            analyze_tiles<1>(source, kernels, options, grid);
+            break;
+        case 2:
+            analyze_tiles<2>(source, kernels, options, grid);
+            break;
+        case 3:
+            analyze_tiles<3>(source, kernels, options, grid);
+            break;
+        case 4:
+            analyze_tiles<4>(source, kernels, options, grid);
+            break;
+        default:
+            throw invalid_argument("Image must have 1 to 4 channels");
+    }
+
+    return grid;
+}
+
+CellGrid analyze_cells(const ByteImage& original, size_t width, size_t height, const AnalysisOptions& options) {
+    ImageRowSource source(original);
+    return analyze_cells(source, width, height, options);
+}
+
+void get_background_pixel(const AnalysisOptions& options, size_t channels, uint8_t* pixel) {
+    const uint8_t* rgb = options.background;
+    if (channels <= 2) {
+        pixel[0] = static_cast<uint8_t>((LUMA_RED * rgb[0] + LUMA_GREEN * rgb[1] + LUMA_BLUE * rgb[2] + (1 << 15)) >> 16);
+    } else {
+        copy_n(rgb, 3, pixel);
+    }
+    if (has_alpha(channels)) {
+        pixel[channels - 1] = 255;
+    }
+}
+
+ByteImage make_composited(const ByteImage& image, const AnalysisOptions& options) {
+    if (!has_alpha(image.channels) || image.empty()) {
+        return image;
+    }
+
+    uint8_t background[MAX_CHANNELS];
+    get_background_pixel(options, image.channels, background);
+    CompositeRowFn composite_row = get_kernels(options.isa).composite_row_u8[image.channels / 2 - 1];
+
+    size_t row_size = image.width * image.channels;
+    shared_ptr<vector<uint8_t>> pixels = make_shared<vector<uint8_t>>(image.height * row_size);
+    for (size_t y = 0; y < image.height; y++) {
+        composite_row(pixels->data() + y * row_size, image.row(y), image.width, background);
+    }
+    return ByteImage(image.width, image.height, image.channels, pixels->data(), pixels);
+}
+
+CellGrid make_scaled_cells(const CellGrid& grid, size_t width, size_t height) {
+    CellGrid scaled;
+    scaled.width = width;
+    scaled.height = height;
+    scaled.has_edges = grid.has_edges;
+    scaled.charset = grid.charset;
+    scaled.palette = grid.palette;
+    scaled.cells.resize(width * height);
+    if (grid.empty()) {
+        return scaled;
+    }
+
+    for (size_t y = 0; y < height; y++) {
+        for (size_t x = 0; x < width; x++) {
+            scaled.cells[y * width + x] = grid.at((x * grid.width) / width, (y * grid.height) / height);
+        }
+    }
+    return scaled;
+}
+
+// Same cells as analyze_tiles, with every box read from the table in constant time
+template <size_t Channels, ColorMode Mode>
+static void analyze_table(const SummedAreaTable& table, const Kernels& kernels, const AnalysisOptions& options, CellGrid& grid) {
+    size_t threads = options.threads ? options.threads : max(1u, thread::hardware_concurrency());
+
+    // The table stays in stored order; each upright cell reads its stored box
+    vector<uint64_t> box_sums(grid.width * grid.height * Channels, 0);
+    for_each_tile(threads, grid.height, [&](size_t j0, size_t j1) {
+        for (size_t j = j0; j < j1; j++) {
+            for (size_t i = 0; i < grid.width; i++) {
+                size_t x1, x2, y1, y2;
+                get_oriented_box(table.width, table.height, table.orientation, grid.width, grid.height, i, j, x1, x2, y1, y2);
+                table.get_box_sums(x1, x2, y1, y2, &box_sums[(j * grid.width + i) * Channels]);
+            }
+        }
+    });
+
+    size_t upright_width, upright_height;
+    get_oriented_dimensions(table.width, table.height, table.orientation, upright_width, upright_height);
+    // The table's sums are of linear light if it was built that way
+    const uint16_t* srgb_table = table.linear_light ? get_srgb_table() : nullptr;
+    shade_cells<Channels, Mode>(upright_width, upright_height, box_sums, srgb_table, kernels, options, threads, grid);
+}
+
+template <size_t Channels>
+static void analyze_table(const SummedAreaTable& table, const Kernels& kernels, const AnalysisOptions& options, CellGrid& grid) {
+    if (options.color_mode == COLOR_RETRO) {
+        analyze_table<Channels, COLOR_RETRO>(table, kernels, options, grid);
+    } else {
+        analyze_table<Channels, COLOR_TRUECOLOR>(table, kernels, options, grid);
+    }
+}
+
+CellGrid analyze_cells(const SummedAreaTable& table, size_t width, size_t height, const AnalysisOptions& options) {
+    // The largest box must not overflow the table's 32-bit sums
+    size_t upright_width, upright_height;
+    get_oriented_dimensions(table.width, table.height, table.orientation, upright_width, upright_height);
+    uint64_t box_width = (upright_width + width - 1) / width;
+    uint64_t box_height = (upright_height + height - 1) / height;
+    if (box_width * box_height > table.get_max_box_pixels()) {
+        throw invalid_argument("Cells too large for the summed-area table");
+    }
+
+    CellGrid grid;
+    grid.width = width;
+    grid.height = height;
+    grid.has_edges = options.edge_threshold < 4.0;
+    grid.charset = options.charset;
+    grid.cells.resize(width * height);
+
+    const Kernels& kernels = get_kernels(options.isa);
+    switch (table.channels) {
+        case 1:
+            analyze_table<1>(table, kernels, options, grid);
+            break;
+        case 2:
+            analyze_table<2>(table, kernels, options, grid);
+            break;
+        case 3:
+            analyze_table<3>(table, kernels, options, grid);
+            break;
+        case 4:
+            analyze_table<4>(table, kernels, options, grid);
+            break;
+        default:
+            throw invalid_argument("Image must have 1 to 4 channels");
+    }
+
+    return grid;
+}
+
+// Cells of the window plus a one-cell halo, summed straight from the pixels
+template <size_t Channels, ColorMode Mode>
+static void analyze_window(const ByteImage& image, const CellWindow& window, const Kernels& kernels, const AnalysisOptions& options, CellGrid& grid) {
+    // Lattice cells that hold at least one pixel
+    size_t lattice_width = (image.width + window.cell_width - 1) / window.cell_width;
+    size_t lattice_height = (image.height + window.cell_height - 1) / window.cell_height;
+
+    // Halo cell (i, j) is lattice cell (window.x + i - 1, window.y + j - 1)
+    size_t halo_width = window.width + 2;
+    size_t halo_height = window.height + 2;
+    vector<Cell> halo_cells(halo_width * halo_height);
+    vector<int32_t> luminance(halo_width * halo_height, 0);
+    uint64_t sums[Channels];
+
+    uint8_t background[MAX_CHANNELS];
+    get_background_pixel(options, Channels, background);
+    vector<uint8_t> composited(has_alpha(Channels) ? window.cell_width * Channels : 0);
+    const uint16_t* linear_table = options.linear_light ? get_linear_table() : nullptr;
+    const uint16_t* srgb_table = options.linear_light ? get_srgb_table() : nullptr;
+
+    for (size_t j = 0; j < halo_height; j++) {
+        size_t lattice_y = window.y + j - 1;
+        if (window.y + j == 0 || lattice_y >= lattice_height) {
+            continue;
+        }
+        size_t y1 = lattice_y * window.cell_height;
+        size_t y2 = min(y1 + window.cell_height, image.height);
+
+        for (size_t i = 0; i < halo_width; i++) {
+            size_t lattice_x = window.x + i - 1;
+            if (window.x + i == 0 || lattice_x >= lattice_width) {
+                continue;
+            }
+            size_t x1 = lattice_x * window.cell_width;
+            size_t x2 = min(x1 + window.cell_width, image.width);
+
+            fill(sums, sums + Channels, 0);
+            for (size_t y = y1; y < y2; y++) {
+                const uint8_t* pixels = image.row(y) + x1 * Channels;
+                if constexpr (has_alpha(Channels)) {
+                    kernels.composite_row_u8[Channels / 2 - 1](composited.data(), pixels, x2 - x1, background);
+                    pixels = composited.data();
+                }
+                for (size_t x = 0; x < (x2 - x1) * Channels; x += Channels) {
+                    for (size_t c = 0; c < Channels; c++) {
+                        sums[c] += linear_table ? linear_table[pixels[x + c]] : pixels[x + c];
+                    }
+                }
+            }
+            shade_box_fixed<Channels, Mode>(sums, (x2 - x1) * (y2 - y1), srgb_table, grid.charset->levels, halo_cells[j * halo_width + i], luminance[j * halo_width + i]);
+        }
+    }
+
+    // Crop the halo away
+    for (size_t j = 0; j < window.height; j++) {
+        copy_n(&halo_cells[(j + 1) * halo_width + 1], window.width, &grid.cells[j * window.width]);
+    }
+
+    if (grid.has_edges) {
+        double limit = options.edge_threshold * options.edge_threshold * 4294967296.0;
+        uint64_t threshold_squared = limit >= 1.8e19 ? UINT64_MAX : static_cast<uint64_t>(ceil(limit));
+
+        vector<int32_t> sobel_x(halo_width, 0);
+        vector<int32_t> sobel_y(halo_width, 0);
+        for (size_t j = 0; j < window.height; j++) {
+            const int32_t* row = &luminance[(j + 1) * halo_width];
+            kernels.sobel_row_fixed(row - halo_width, row, row + halo_width, halo_width, sobel_x.data(), sobel_y.data());
+
+            size_t lattice_y = window.y + j;
+            for (size_t i = 0; i < window.width; i++) {
+                size_t lattice_x = window.x + i;
+                if (lattice_x >= lattice_width || lattice_y >= lattice_height) {
+                    continue;
+                }
+
+                // Like the whole-image path, cells on the image border have no gradient
+                int64_t sx = 0, sy = 0;
+                if (lattice_x > 0 && lattice_y > 0 && lattice_x + 1 < lattice_width && lattice_y + 1 < lattice_height) {
+                    sx = sobel_x[i + 1];
+                    sy = sobel_y[i + 1];
+                }
+
+                // If edge
+                if (static_cast<uint64_t>(sx * sx + sy * sy) >= threshold_squared) {
+                    grid.cells[j * window.width + i].edge_dir = get_sobel_edge_dir_fixed(static_cast<int32_t>(sx), static_cast<int32_t>(sy));
+                }
+            }
+        }
+    }
+}
+
+template <size_t Channels>
+static void analyze_window(const ByteImage& image, const CellWindow& window, const Kernels& kernels, const AnalysisOptions& options, CellGrid& grid) {
+    if (options.color_mode == COLOR_RETRO) {
+        analyze_window<Channels, COLOR_RETRO>(image, window, kernels, options, grid);
+    } else {
+        analyze_window<Channels, COLOR_TRUECOLOR>(image, window, kernels, options, grid);
+    }
+}
+
+CellGrid analyze_window(const ByteImage& image, const CellWindow& window, const AnalysisOptions& options) {
+    if (window.cell_width == 0 || window.cell_height == 0) {
+        throw invalid_argument("Cell size must be at least one pixel");
+    }
+
+    CellGrid grid;
+    grid.width = window.width;
+    grid.height = window.height;
+    grid.has_edges = options.edge_threshold < 4.0;
+    grid.charset = options.charset;
+    grid.cells.resize(window.width * window.height);
+
+    const Kernels& kernels = get_kernels(options.isa);
+    switch (image.channels) {
+        case 1:
+            analyze_window<1>(image, window, kernels, options, grid);
+            break;
+        case 2:
+            analyze_window<2>(image, window, kernels, options, grid);
+            break;
+        case 3:
+            analyze_window<3>(image, window, kernels, options, grid);
+            break;
+        case 4:
+            analyze_window<4>(image, window, kernels, options, grid);
+            break;
+        default:
+            throw invalid_argument("Image must have 1 to 4 channels");
+    }
+
+    return grid;
+}
+
+FrameAnalyzer::FrameAnalyzer(size_t width, size_t height, const AnalysisOptions& options)
+    : options(options), frame_width(0), frame_height(0), frame_channels(0), luminance(width * height, 0), changed(width * height, 0), changed_cells(0) {
+    grid.width = width;
+    grid.height = height;
+    grid.has_edges = options.edge_threshold < 4.0;
+    grid.charset = options.charset;
+    grid.cells.resize(width * height);
+}
+
+// Phases 1 and 2 for the cells whose pixels differ from the previous frame, which are then
+// copied over it, and phase 3 for every row that has one of them or a neighbour of one
+template <size_t Channels, ColorMode Mode>
+void FrameAnalyzer::analyze_frame(const ByteImage& frame, const Kernels& kernels, bool first) {
+    size_t width = grid.width;
+    size_t height = grid.height;
+    size_t row_size = frame.width * Channels;
+    size_t threads = options.threads ? options.threads : max(1u, thread::hardware_concurrency());
+
+    uint8_t background[MAX_CHANNELS];
+    get_background_pixel(options, Channels, background);
+    const uint16_t* linear_table = options.linear_light ? get_linear_table() : nullptr;
+    const uint16_t* srgb_table = options.linear_light ? get_srgb_table() : nullptr;
+
+    for_each_tile(threads, height, [&](size_t j0, size_t j1) {
+        vector<uint8_t> composited(has_alpha(Channels) ? row_size : 0);
+        uint64_t sums[Channels];
+        for (size_t j = j0; j < j1; j++) {
+            size_t y1 = row_edges[j], y2 = row_edges[j + 1];
+            uint8_t* dirty = &changed[j * width];
+            fill(dirty, dirty + width, first);
+
+            // Whole rows first, as in still footage most are the same; only rows that differ are split into cells
+            for (size_t y = y1; y < y2 && !first; y++) {
+                const uint8_t* row = frame.row(y);
+                const uint8_t* last = &previous[y * row_size];
+                if (memcmp(row, last, row_size) == 0) {
+                    continue;
+                }
+                for (size_t i = 0; i < width; i++) {
+                    size_t x1 = column_edges[i] * Channels, x2 = column_edges[i + 1] * Channels;
+                    dirty[i] = dirty[i] || memcmp(row + x1, last + x1, x2 - x1) != 0;
+                }
+            }
+
+            for (size_t i = 0; i < width; i++) {
+                if (!dirty[i]) {
+                    continue;
+                }
+                size_t x1 = column_edges[i] * Channels, x2 = column_edges[i + 1] * Channels;
+
+                fill(sums, sums + Channels, 0);
+                for (size_t y = y1; y < y2; y++) {
+                    const uint8_t* pixels = frame.row(y) + x1;
+                    memcpy(&previous[y * row_size + x1], pixels, x2 - x1);
+                    if constexpr (has_alpha(Channels)) {
+                        kernels.composite_row_u8[Channels / 2 - 1](composited.data(), pixels, (x2 - x1) / Channels, background);
+                        pixels = composited.data();
+                    }
+                    for (size_t x = 0; x < x2 - x1; x += Channels) {
+                        for (size_t c = 0; c < Channels; c++) {
+                            sums[c] += linear_table ? linear_table[pixels[x + c]] : pixels[x + c];
+                        }
+                    }
+                }
+                size_t index = j * width + i;
+                shade_box_fixed<Channels, Mode>(sums, (x2 - x1) / Channels * (y2 - y1), srgb_table, grid.charset->levels, grid.cells[index], luminance[index]);
+            }
+        }
+    });
+    changed_cells = static_cast<size_t>(count(changed.begin(), changed.end(), 1));
+
+    if (!grid.has_edges || changed_cells == 0) {
+        return;
+    }
+    double limit = options.edge_threshold * options.edge_threshold * 4294967296.0;
+    uint64_t threshold_squared = limit >= 1.8e19 ? UINT64_MAX : static_cast<uint64_t>(ceil(limit));
+
+    // Cells next to a changed one along their row, then along their column as well
+    vector<uint8_t> across(width * height, 0);
+    for (size_t k = 0; k < width * height; k++) {
+        size_t i = k % width;
+        across[k] = changed[k] || (i > 0 && changed[k - 1]) || (i + 1 < width && changed[k + 1]);
+    }
+
+    vector<int32_t> sobel_x(width, 0);
+    vector<int32_t> sobel_y(width, 0);
+    for (size_t j = 0; j < height; j++) {
+        const uint8_t* above = &across[(j > 0 ? j - 1 : j) * width];
+        const uint8_t* row = &across[j * width];
+        const uint8_t* below = &across[(j + 1 < height ? j + 1 : j) * width];
+        bool touched = false;
+        for (size_t i = 0; i < width && !touched; i++) {
+            touched = above[i] || row[i] || below[i];
+        }
+        if (!touched) {
+            continue;
+        }
+
+        // Border rows have no gradient, as in mark_edges
+        if (j == 0 || j + 1 >= height) {
+            fill(sobel_x.begin(), sobel_x.end(), 0);
+            fill(sobel_y.begin(), sobel_y.end(), 0);
+        } else {
+            const int32_t* center = &luminance[j * width];
+            kernels.sobel_row_fixed(center - width, center, center + width, width, sobel_x.data(), sobel_y.data());
+        }
+
+        for (size_t i = 0; i < width; i++) {
+            if (!above[i] && !row[i] && !below[i]) {
+                continue;
+            }
+            int64_t sx = sobel_x[i];
+            int64_t sy = sobel_y[i];
+
+            // If edge, and otherwise cleared of the edge an earlier frame left
+            Cell& cell = grid.cells[j * width + i];
+            cell.edge_dir = EDGE_NONE;
+            if (static_cast<uint64_t>(sx * sx + sy * sy) >= threshold_squared) {
+                cell.edge_dir = get_sobel_edge_dir_fixed(sobel_x[i], sobel_y[i]);
+            }
+        }
+    }
+}
+
+template <size_t Channels>
+void FrameAnalyzer::analyze_frame(const ByteImage& frame, const Kernels& kernels, bool first) {
+    if (options.color_mode == COLOR_RETRO) {
+        analyze_frame<Channels, COLOR_RETRO>(frame, kernels, first);
+    } else {
+        analyze_frame<Channels, COLOR_TRUECOLOR>(frame, kernels, first);
+    }
+}
+
+const CellGrid& FrameAnalyzer::analyze(const ByteImage& frame) {
+    bool first = frame_channels == 0;
+    if (first) {
+        if (frame.empty() || frame.channels < 1 || frame.channels > 4) {
+            throw invalid_argument("Image must have 1 to 4 channels");
+        }
+        frame_width = frame.width;
+        frame_height = frame.height;
+        frame_channels = frame.channels;
+
+        // Same boxes as analyze_cells over the upright frame
+        column_edges.resize(grid.width + 1);
+        row_edges.resize(grid.height + 1);
+        for (size_t i = 0; i <= grid.width; i++) {
+            column_edges[i] = (i * frame.width) / grid.width;
+        }
+        for (size_t j = 0; j <= grid.height; j++) {
+            row_edges[j] = (j * frame.height) / grid.height;
+        }
+
+        previous.resize(frame.width * frame.height * frame.channels);
+    } else if (frame.width != frame_width || frame.height != frame_height || frame.channels != frame_channels) {
+        throw invalid_argument("Video frames must all have the size and channels of the first");
+    }
+
+    // The first frame has nothing to compare with, so all of it is analyzed
+    const Kernels& kernels = get_kernels(options.isa);
+    switch (frame_channels) {
+        case 1:
+            analyze_frame<1>(frame, kernels, first);
+            break;
+        case 2:
+            analyze_frame<2>(frame, kernels, first);
+            break;
+        case 3:
+            analyze_frame<3>(frame, kernels, first);
+            break;
+        default:
+            analyze_frame<4>(frame, kernels, first);
+            break;
+    }
+    return grid;
+}
+
+// ---------------------------------------------------------------------------
+// Shape matching. Samples each cell at FONT_WIDTH x FONT_HEIGHT points, thresholds
+// them into a 128-bit mask and picks the charset glyph whose bitmap is nearest to it.
+
+// Smallest spread between a cell's darkest and brightest sample, out of 255, for its shape
+// to be matched; flatter cells keep the glyph their brightness picked
+constexpr uint32_t SHAPE_MIN_CONTRAST = 48;
+
+// Pixels [first, last) of sample s of n across [begin, end): an equal share of them, or
+// the pixel under the sample's centre when there are fewer pixels than samples
+static void get_sample_span(size_t begin, size_t end, size_t s, size_t n, size_t& first, size_t& last) {
+    size_t length = end - begin;
+    first = begin + (s * length) / n;
+    last = begin + ((s + 1) * length) / n;
+    if (first == last && length > 0) {
+        first = begin + ((2 * s + 1) * length) / (2 * n);
+        last = first + 1;
+    }
+}
+
+// 8-bit BT.709 luminance of n pixels, composited over the background first when they have alpha
+template <size_t Channels>
+static void get_luma_row_u8(const uint8_t* row, size_t n, const Kernels& kernels, const uint8_t* background, uint8_t* composited, uint8_t* luma) {
+    if constexpr (has_alpha(Channels)) {
+        kernels.composite_row_u8[Channels / 2 - 1](composited, row, n, background);
+        row = composited;
+    }
+    for (size_t x = 0; x < n; x++) {
+        const uint8_t* pixel = row + x * Channels;
+        if constexpr (Channels >= 3) {
+            luma[x] = static_cast<uint8_t>((LUMA_RED * pixel[0] + LUMA_GREEN * pixel[1] + LUMA_BLUE * pixel[2] + (1 << 15)) >> 16);
+        } else {
+            luma[x] = pixel[0];
+        }
+    }
+}
+
+// Cell rows [j0, j1), where cell (i, j) covers pixels [column_edges[i], column_edges[i + 1])
+// x [row_edges[j], row_edges[j + 1]). Cells without pixels are left alone.
+template <size_t Channels>
+static void match_shape_rows(const ByteImage& image, const Kernels& kernels, const uint8_t* background, const vector<size_t>& column_edges, const vector<size_t>& row_edges,
+                             size_t j0, size_t j1, CellGrid& grid) {
+    const Charset& charset = *grid.charset;
+    size_t width = grid.width;
+    size_t n_samples = width * FONT_WIDTH;
+
+    vector<size_t> sample_first(n_samples), sample_last(n_samples);
+    for (size_t i = 0; i < width; i++) {
+        for (size_t s = 0; s < FONT_WIDTH; s++) {
+            get_sample_span(column_edges[i], column_edges[i + 1], s, FONT_WIDTH, sample_first[i * FONT_WIDTH + s], sample_last[i * FONT_WIDTH + s]);
+        }
+    }
+
+    vector<uint8_t> composited(has_alpha(Channels) ? image.width * Channels : 0);
+    vector<uint8_t> luma(image.width);
+    vector<uint32_t> sums(n_samples);
+    vector<uint8_t> samples(FONT_HEIGHT * n_samples);
+    vector<uint64_t> masks;
+    vector<size_t> matched;
+    vector<uint8_t> glyph_classes;
+
+    for (size_t j = j0; j < j1; j++) {
+        if (row_edges[j] == row_edges[j + 1]) {
+            continue;
+        }
+
+        // Mean luminance of every sample of the cell row, one row of samples at a time
+        for (size_t t = 0; t < FONT_HEIGHT; t++) {
+            size_t first_row, last_row;
+            get_sample_span(row_edges[j], row_edges[j + 1], t, FONT_HEIGHT, first_row, last_row);
+            fill(sums.begin(), sums.end(), 0);
+            for (size_t y = first_row; y < last_row; y++) {
+                get_luma_row_u8<Channels>(image.row(y), image.width, kernels, background, composited.data(), luma.data());
+                for (size_t k = 0; k < n_samples; k++) {
+                    uint32_t sum = 0;
+                    for (size_t x = sample_first[k]; x < sample_last[k]; x++) {
+                        sum += luma[x];
+                    }
+                    sums[k] += sum;
+                }
+            }
+
+            uint8_t* row_samples = &samples[t * n_samples];
+            for (size_t k = 0; k < n_samples; k++) {
+                uint32_t count = static_cast<uint32_t>((last_row - first_row) * (sample_last[k] - sample_first[k]));
+                row_samples[k] = count ? static_cast<uint8_t>((sums[k] + count / 2) / count) : 0;
+            }
+        }
+
+        // Samples brighter than halfway between the cell's darkest and brightest one are ink
+        masks.clear();
+        matched.clear();
+        for (size_t i = 0; i < width; i++) {
+            if (column_edges[i] == column_edges[i + 1]) {
+                continue;
+            }
+
+            uint32_t darkest = 255, brightest = 0;
+            for (size_t t = 0; t < FONT_HEIGHT; t++) {
+                const uint8_t* cell_samples = &samples[t * n_samples + i * FONT_WIDTH];
+                for (size_t s = 0; s < FONT_WIDTH; s++) {
+                    darkest = min<uint32_t>(darkest, cell_samples[s]);
+                    brightest = max<uint32_t>(brightest, cell_samples[s]);
+                }
+            }
+            if (brightest - darkest < SHAPE_MIN_CONTRAST) {
+                continue;
+            }
+
+            uint64_t mask[2] = {0, 0};
+            for (size_t t = 0; t < FONT_HEIGHT; t++) {
+                const uint8_t* cell_samples = &samples[t * n_samples + i * FONT_WIDTH];
+                for (size_t s = 0; s < FONT_WIDTH; s++) {
+                    if (2u * cell_samples[s] > darkest + brightest) {
+                        mask[t / 8] |= 1ull << (63 - 8 * (t % 8) - s);
+                    }
+                }
+            }
+            masks.insert(masks.end(), mask, mask + 2);
+            matched.push_back(j * width + i);
+        }
+
+        glyph_classes.resize(matched.size());
+        kernels.match_glyphs(masks.data(), matched.size(), charset.shapes.data(), charset.glyphs.size(), glyph_classes.data());
+        for (size_t k = 0; k < matched.size(); k++) {
+            grid.cells[matched[k]].glyph_class = glyph_classes[k];
+        }
+    }
+}
+
+static void match_shape_boxes(const ByteImage& image, const vector<size_t>& column_edges, const vector<size_t>& row_edges, const AnalysisOptions& options, CellGrid& grid) {
+    const Kernels& kernels = get_kernels(options.isa);
+    uint8_t background[MAX_CHANNELS];
+    get_background_pixel(options, image.channels, background);
+    size_t threads = options.threads ? options.threads : max(1u, thread::hardware_concurrency());
+
+    for_each_tile(threads, grid.height, [&](size_t j0, size_t j1) {
+        switch (image.channels) {
+            case 1:
+                match_shape_rows<1>(image, kernels, background, column_edges, row_edges, j0, j1, grid);
+                break;
+            case 2:
+                match_shape_rows<2>(image, kernels, background, column_edges, row_edges, j0, j1, grid);
+                break;
+            case 3:
+                match_shape_rows<3>(image, kernels, background, column_edges, row_edges, j0, j1, grid);
+                break;
+            case 4:
+                match_shape_rows<4>(image, kernels, background, column_edges, row_edges, j0, j1, grid);
+                break;
+        }
+    });
+}
+
+void match_shapes(const ByteImage& image, const AnalysisOptions& options, CellGrid& grid) {
+    if (image.channels < 1 || image.channels > MAX_CHANNELS) {
+        throw invalid_argument("Image must have 1 to 4 channels");
+    }
+
+    vector<size_t> column_edges(grid.width + 1), row_edges(grid.height + 1);
+    for (size_t i = 0; i <= grid.width; i++) {
+        column_edges[i] = (i * image.width) / grid.width;
+    }
+    for (size_t j = 0; j <= grid.height; j++) {
+        row_edges[j] = (j * image.height) / grid.height;
+    }
+    match_shape_boxes(image, column_edges, row_edges, options, grid);
+}
+
+void match_shapes(const ByteImage& image, const CellWindow& window, const AnalysisOptions& options, CellGrid& grid) {
+    if (image.channels < 1 || image.channels > MAX_CHANNELS) {
+        throw invalid_argument("Image must have 1 to 4 channels");
+    }
+
+    // Lattice cells past the image have no pixels
+    vector<size_t> column_edges(window.width + 1), row_edges(window.height + 1);
+    for (size_t i = 0; i <= window.width; i++) {
+        column_edges[i] = min((window.x + i) * window.cell_width, image.width);
+    }
+    for (size_t j = 0; j <= window.height; j++) {
+        row_edges[j] = min((window.y + j) * window.cell_height, image.height);
+    }
+    match_shape_boxes(image, column_edges, row_edges, options, grid);
+}
+
+// ---------------------------------------------------------------------------
+// Dithering. Quantizes the analyzed colors to a terminal palette, approximating the
+// colors between its entries by a pattern of neighbouring ones.
+
+// Cell rows scanned in the same direction by Floyd-Steinberg; bands alternate direction
+constexpr size_t DITHER_BAND_ROWS = 8;
+
+// Threshold order of the 8x8 Bayer matrix
+static const uint8_t BAYER_MATRIX[8][8] = {{0, 32, 8, 40, 2, 34, 10, 42},  {48, 16, 56, 24, 50, 18, 58, 26}, {12, 44, 4, 36, 14, 46, 6, 38},  {60, 28, 52, 20, 62, 30, 54, 22},
+                                           {3, 35, 11, 43, 1, 33, 9, 41},  {51, 19, 59, 27, 49, 17, 57, 25}, {15, 47, 7, 39, 13, 45, 5, 37},  {63, 31, 55, 23, 61, 29, 53, 21}};
+
+// Range a dithered color may stray outside 8 bits by. Colors on the edge of the RGB cube, like
+// every brightness-normalized one, are then still reached by mixing entries inside it.
+constexpr int DITHER_HEADROOM = 128;
+
+// Sets the cell to the palette entry nearest a color
+static void set_palette_color(Palette palette, const int* color, Cell& cell) {
+    uint8_t rgb[3];
+    get_palette_rgb(palette, get_nearest_palette_index(palette, color[0], color[1], color[2]), rgb);
+    cell.r = rgb[0];
+    cell.g = rgb[1];
+    cell.b = rgb[2];
+}
+
+// Nearest entries, or with Bayer, nearest after an offset of up to half the palette's spread
+static void dither_ordered(Palette palette, bool bayer, size_t j0, size_t j1, CellGrid& grid) {
+    int spread = bayer ? get_palette_spread(palette) : 0;
+    for (size_t j = j0; j < j1; j++) {
+        for (size_t i = 0; i < grid.width; i++) {
+            Cell& cell = grid.cells[j * grid.width + i];
+            int offset = (2 * BAYER_MATRIX[j % 8][i % 8] + 1 - 64) * spread / 128;
+            int color[3] = {cell.r + offset, cell.g + offset, cell.b + offset};
+            set_palette_color(palette, color, cell);
+        }
+    }
+}
+
+// Floyd-Steinberg: 7/16 of a cell's error goes on along the row, 3/16, 5/16 and 1/16 to the
+// cells behind, under and ahead of it in the next row. Cell (x, y) is final once the row above
+// has finished columns x - 1 to x + 1, which is all a worker waits for before quantizing it.
+static void dither_error_diffusion(Palette palette, size_t threads, CellGrid& grid) {
+    size_t width = grid.width;
+    size_t height = grid.height;
+
+    // Error each row receives from the one above, in 1/16 levels
+    vector<int32_t> errors(height * width * 3, 0);
+
+    // Cells each row has finished, in its own scan order
+    unique_ptr<atomic<size_t>[]> progress(new atomic<size_t>[height]);
+    for (size_t j = 0; j < height; j++) {
+        progress[j].store(0, memory_order_relaxed);
+    }
+
+    auto is_reversed = [](size_t j) { return (j / DITHER_BAND_ROWS) % 2 == 1; };
+
+    threads = max(static_cast<size_t>(1), min(threads, height));
+    run_workers(threads, [&](size_t worker) {
+        for (size_t j = worker; j < height; j += threads) {
+            bool reversed = is_reversed(j);
+            int32_t* row_errors = &errors[j * width * 3];
+            int32_t* below = j + 1 < height ? &errors[(j + 1) * width * 3] : nullptr;
+            int32_t carried[3] = {0, 0, 0};
+            size_t above_done = 0;
+
+            for (size_t step = 0; step < width; step++) {
+                size_t x = reversed ? width - 1 - step : step;
+
+                // Wait for the row above to pass column x + 1 in its own direction
+                if (j > 0) {
+                    size_t needed = min(width, is_reversed(j - 1) ? width - x + 1 : x + 2);
+                    while (above_done < needed) {
+                        above_done = progress[j - 1].load(memory_order_acquire);
+                        if (above_done < needed) {
+                            this_thread::yield();
+                        }
+                    }
+                }
+
+                Cell& cell = grid.cells[j * width + x];
+                int color[3] = {cell.r, cell.g, cell.b};
+                for (size_t c = 0; c < 3; c++) {
+                    color[c] = clamp(color[c] + ((row_errors[x * 3 + c] + carried[c] + 8) >> 4), -DITHER_HEADROOM, 255 + DITHER_HEADROOM);
+                }
+                set_palette_color(palette, color, cell);
+
+                int32_t error[3] = {color[0] - cell.r, color[1] - cell.g, color[2] - cell.b};
+                for (size_t c = 0; c < 3; c++) {
+                    carried[c] = 7 * error[c];
+                }
+                if (below) {
+                    size_t behind = reversed ? x + 1 : x - 1;
+                    size_t ahead = reversed ? x - 1 : x + 1;
+                    for (size_t c = 0; c < 3; c++) {
+                        below[x * 3 + c] += 5 * error[c];
+                        if (behind < width) {
+                            below[behind * 3 + c] += 3 * error[c];
+                        }
+                        if (ahead < width) {
+                            below[ahead * 3 + c] += error[c];
+                        }
+                    }
+                }
+                progress[j].store(step + 1, memory_order_release);
+            }
+        }
+    });
+}
+
+void dither_cells(const AnalysisOptions& options, CellGrid& grid) {
+    if (options.palette == PALETTE_TRUECOLOR) {
+        return;
+    }
+
+    grid.palette = options.palette;
+    if (grid.empty()) {
+        return;
+    }
+
+    size_t threads = options.threads ? options.threads : max(1u, thread::hardware_concurrency());
+    if (options.dither == DITHER_FLOYD_STEINBERG) {
+        dither_error_diffusion(options.palette, threads, grid);
+    } else {
+        bool bayer = options.dither == DITHER_BAYER;
+        for_each_tile(threads, grid.height, [&](size_t j0, size_t j1) { dither_ordered(options.palette, bayer, j0, j1, grid); });
+    }
+}
\ No newline at end of file
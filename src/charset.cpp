@@ -0,0 +1,229 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "../include/cells.hpp"
+#include "../include/charset.hpp"
+#include "../include/font.hpp"
+
+using namespace std;
+
+// Identifies a cache file, followed by FONT_VERSION
+static const char CACHE_MAGIC[8] = {'A', 'S', 'C', 'I', 'I', 'L', 'U', 'T'};
+
+// Glyph index per level in equal buckets, for ramps whose coverage carries no information
+static void fill_equal_levels(Charset& charset) {
+    size_t n_glyphs = charset.glyphs.size();
+    for (size_t level = 0; level < N_BRIGHTNESS_LEVELS; level++) {
+        charset.levels[level] = static_cast<uint8_t>(level * n_glyphs / N_BRIGHTNESS_LEVELS);
+    }
+}
+
+// Packs each glyph's bitmap into two words, one byte per row with the first row most significant
+static void fill_shapes(Charset& charset) {
+    size_t n_glyphs = charset.glyphs.size();
+    charset.shapes.assign(2 * n_glyphs, 0);
+    for (size_t g = 0; g < n_glyphs; g++) {
+        const uint8_t* bitmap = get_glyph_bitmap(decode_utf8(charset.glyphs[g]));
+        for (size_t y = 0; bitmap && y < FONT_HEIGHT; y++) {
+            charset.shapes[(y / 8) * n_glyphs + g] |= static_cast<uint64_t>(bitmap[y]) << (56 - 8 * (y % 8));
+        }
+    }
+}
+
+const Charset& get_default_charset() {
+    static const Charset charset = [] {
+        Charset result;
+        for (char c : VALUE_CHARS) {
+            result.glyphs.push_back(string(1, c));
+        }
+        fill_equal_levels(result);
+        fill_shapes(result);
+        return result;
+    }();
+    return charset;
+}
+
+bool make_charset(const string& text, Charset& charset) {
+    vector<string> characters;
+    if (!split_utf8(text, characters)) {
+        cerr << "Error: Charset is not valid UTF-8!" << endl;
+        return false;
+    }
+
+    struct Glyph {
+        string text;
+        size_t coverage;
+    };
+    vector<Glyph> glyphs;
+    for (const string& character : characters) {
+        bool seen = any_of(glyphs.begin(), glyphs.end(), [&](const Glyph& glyph) { return glyph.text == character; });
+        if (seen) {
+            continue;
+        }
+
+        const uint8_t* bitmap = get_glyph_bitmap(decode_utf8(character));
+        if (!bitmap) {
+            cerr << "Warning: No bitmap for '" << character << "' in the built-in font, leaving it out" << endl;
+            continue;
+        }
+        glyphs.push_back({character, get_glyph_coverage(bitmap)});
+    }
+
+    if (glyphs.empty()) {
+        cerr << "Error: Charset has no glyphs the built-in font can measure!" << endl;
+        return false;
+    }
+    if (glyphs.size() > N_BRIGHTNESS_LEVELS) {
+        cerr << "Error: Charset has more than " << N_BRIGHTNESS_LEVELS << " glyphs!" << endl;
+        return false;
+    }
+
+    // Darkest first; glyphs of equal coverage keep the order they were given in
+    stable_sort(glyphs.begin(), glyphs.end(), [](const Glyph& a, const Glyph& b) { return a.coverage < b.coverage; });
+
+    charset.glyphs.clear();
+    for (const Glyph& glyph : glyphs) {
+        charset.glyphs.push_back(glyph.text);
+    }
+    fill_shapes(charset);
+
+    size_t lightest = glyphs.front().coverage;
+    size_t darkest = glyphs.back().coverage;
+    if (lightest == darkest) {
+        fill_equal_levels(charset);
+        return true;
+    }
+
+    // Level l wants coverage lightest + (darkest - lightest) * l / 255; pick the nearest glyph,
+    // compared in integers scaled by 255. Targets only grow, so the index never goes back.
+    // Of glyphs with equal coverage only the first is used.
+    size_t index = 0;
+    for (size_t level = 0; level < N_BRIGHTNESS_LEVELS; level++) {
+        size_t target = lightest * 255 + (darkest - lightest) * level;
+        while (true) {
+            size_t next = index + 1;
+            while (next < glyphs.size() && glyphs[next].coverage == glyphs[index].coverage) {
+                next++;
+            }
+            if (next == glyphs.size()) {
+                break;
+            }
+
+            size_t here = glyphs[index].coverage * 255;
+            size_t there = glyphs[next].coverage * 255;
+            size_t here_distance = target > here ? target - here : here - target;
+            size_t there_distance = target > there ? target - there : there - target;
+            if (there_distance >= here_distance) {
+                break;
+            }
+            index = next;
+        }
+        charset.levels[level] = static_cast<uint8_t>(index);
+    }
+    return true;
+}
+
+// Cache layout: magic, FONT_VERSION, text, glyph count, glyphs, then the levels.
+// Numbers are 32-bit little-endian and strings are prefixed with their 32-bit length.
+static void put_u32(string& out, uint32_t value) {
+    for (int shift = 0; shift < 32; shift += 8) {
+        out.push_back(static_cast<char>((value >> shift) & 0xFF));
+    }
+}
+
+static void put_string(string& out, const string& value) {
+    put_u32(out, static_cast<uint32_t>(value.size()));
+    out += value;
+}
+
+static bool get_u32(const string& in, size_t& at, uint32_t& value) {
+    if (in.size() - at < 4) {
+        return false;
+    }
+    value = 0;
+    for (int k = 3; k >= 0; k--) {
+        value = (value << 8) | static_cast<uint8_t>(in[at + k]);
+    }
+    at += 4;
+    return true;
+}
+
+static bool get_string(const string& in, size_t& at, string& value) {
+    uint32_t size;
+    if (!get_u32(in, at, size) || in.size() - at < size) {
+        return false;
+    }
+    value = in.substr(at, size);
+    at += size;
+    return true;
+}
+
+static bool read_cache(const string& text, const string& contents, Charset& charset) {
+    size_t at = sizeof(CACHE_MAGIC);
+    uint32_t version, n_glyphs;
+    string cached_text;
+    if (contents.compare(0, at, CACHE_MAGIC, sizeof(CACHE_MAGIC)) != 0 || !get_u32(contents, at, version) || version != FONT_VERSION ||
+        !get_string(contents, at, cached_text) || cached_text != text || !get_u32(contents, at, n_glyphs) || n_glyphs == 0 || n_glyphs > N_BRIGHTNESS_LEVELS) {
+        return false;
+    }
+
+    vector<string> glyphs(n_glyphs);
+    for (string& glyph : glyphs) {
+        if (!get_string(contents, at, glyph)) {
+            return false;
+        }
+    }
+    if (contents.size() - at != N_BRIGHTNESS_LEVELS) {
+        return false;
+    }
+    for (size_t level = 0; level < N_BRIGHTNESS_LEVELS; level++) {
+        charset.levels[level] = static_cast<uint8_t>(contents[at + level]);
+        if (charset.levels[level] >= n_glyphs) {
+            return false;
+        }
+    }
+    charset.glyphs = glyphs;
+    fill_shapes(charset);
+    return true;
+}
+
+bool load_charset(const string& text, const string& cache_path, Charset& charset) {
+    string contents;
+    if (FILE* file = fopen(cache_path.c_str(), "rb")) {
+        char buffer[4096];
+        size_t n;
+        while ((n = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+            contents.append(buffer, n);
+        }
+        fclose(file);
+        if (read_cache(text, contents, charset)) {
+            return true;
+        }
+    }
+
+    if (!make_charset(text, charset)) {
+        return false;
+    }
+
+    contents.assign(CACHE_MAGIC, sizeof(CACHE_MAGIC));
+    put_u32(contents, FONT_VERSION);
+    put_string(contents, text);
+    put_u32(contents, static_cast<uint32_t>(charset.glyphs.size()));
+    for (const string& glyph : charset.glyphs) {
+        put_string(contents, glyph);
+    }
+    contents.append(reinterpret_cast<const char*>(charset.levels), N_BRIGHTNESS_LEVELS);
+
+    FILE* file = fopen(cache_path.c_str(), "wb");
+    if (!file || fwrite(contents.data(), 1, contents.size(), file) != contents.size()) {
+        cerr << "Warning: Could not write the charset cache '" << cache_path << "'" << endl;
+    }
+    if (file) {
+        fclose(file);
+    }
+    return true;
+}
\ No newline at end of file
@@ -0,0 +1,239 @@
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "../include/color.hpp"
+
+using namespace std;
+
+double get_max(double a, double b, double c) { return max({a, b, c}); }
+
+double get_min(double a, double b, double c) { return min({a, b, c}); }
+
+HSV rgb_to_hsv(double red, double green, double blue) {
+    HSV hsv;
+
+    double max_val = get_max(red, green, blue);
+    double min_val = get_min(red, green, blue);
+
+    hsv.value = max_val;
+    double chroma = hsv.value - min_val;
+
+    // Calculate saturation
+    if (abs(hsv.value) < 1e-4) {
+        hsv.saturation = 0.0;
+    } else {
+        hsv.saturation = chroma / hsv.value;
+    }
+
+    // Calculate hue
+    if (chroma < 1e-4) {
+        hsv.hue = 0.0;
+    } else if (max_val == red) {
+        hsv.hue = 60.0 * fmod((green - blue) / chroma, 6.0);
+        if (hsv.hue < 0.0) hsv.hue += 360.0;
+    } else if (max_val == green) {
+        hsv.hue = 60.0 * (2.0 + (blue - red) / chroma);
+    } else {
+        hsv.hue = 60.0 * (4.0 + (red - green) / chroma);
+    }
+
+    return hsv;
+}
+
+void hsv_to_rgb(const HSV& hsv, double& r, double& g, double& b) {
+    double c = hsv.value * hsv.saturation;
+    double h_prime = hsv.hue / 60.0;
+    double x = c * (1.0 - abs(fmod(h_prime, 2.0) - 1.0));
+
+    double r1, g1, b1;
+
+    if (h_prime >= 0.0 && h_prime < 1.0) {
+        r1 = c;
+        g1 = x;
+        b1 = 0.0;
+    } else if (h_prime >= 1.0 && h_prime < 2.0) {
+        r1 = x;
+        g1 = c;
+        b1 = 0.0;
+    } else if (h_prime >= 2.0 && h_prime < 3.0) {
+        r1 = 0.0;
+        g1 = c;
+        b1 = x;
+    } else if (h_prime >= 3.0 && h_prime < 4.0) {
+        r1 = 0.0;
+        g1 = x;
+        b1 = c;
+    } else if (h_prime >= 4.0 && h_prime < 5.0) {
+        r1 = x;
+        g1 = 0.0;
+        b1 = c;
+    } else {
+        r1 = c;
+        g1 = 0.0;
+        b1 = x;
+    }
+
+    double m = hsv.value - c;
+    r = r1 + m;
+    g = g1 + m;
+    b = b1 + m;
+}
+
+void get_retro_rgb(const HSV& hsv, int& out_r, int& out_g, int& out_b) {
+    // For retro colors: quantize hue and saturation for 8-color palette
+    HSV quantized_hsv = hsv;
+
+    // Set value to full brightness (character controls apparent brightness)
+    quantized_hsv.value = 1.0;
+
+    // Quantize hue to nearest multiple of 60 degrees (6 hues: R, Y, G, C, B, M)
+    quantized_hsv.hue = round(quantized_hsv.hue / 60.0) * 60.0;
+    if (quantized_hsv.hue >= 360.0) {
+        quantized_hsv.hue = 0.0;
+    }
+
+    // Quantize saturation: either 0% (grayscale) or 100% (full color)
+    quantized_hsv.saturation = (quantized_hsv.saturation < 0.25) ? 0.0 : 1.0;
+
+    // Convert back to RGB
+    double r, g, b;
+    hsv_to_rgb(quantized_hsv, r, g, b);
+
+    // Convert to 0-255 range
+    out_r = static_cast<int>(r * 255);
+    out_g = static_cast<int>(g * 255);
+    out_b = static_cast<int>(b * 255);
+}
+
+// xterm's default ANSI colors, then their bright variants
+static const uint8_t ANSI_RGB[16][3] = {{0, 0, 0},       {205, 0, 0}, {0, 205, 0}, {205, 205, 0}, {0, 0, 238},   {205, 0, 205}, {0, 205, 205}, {229, 229, 229},
+                                        {127, 127, 127}, {255, 0, 0}, {0, 255, 0}, {255, 255, 0}, {92, 92, 255}, {255, 0, 255}, {0, 255, 255}, {255, 255, 255}};
+
+// Channel levels of the 256-color palette's 6x6x6 cube
+static const uint8_t CUBE_LEVELS[6] = {0, 95, 135, 175, 215, 255};
+
+size_t get_palette_size(Palette palette) {
+    switch (palette) {
+        case PALETTE_8:
+            return 8;
+        case PALETTE_16:
+            return 16;
+        case PALETTE_256:
+            return 256;
+        default:
+            return 0;
+    }
+}
+
+void get_palette_rgb(Palette palette, uint8_t index, uint8_t* rgb) {
+    if (palette == PALETTE_8) {
+        // Bits 0, 1 and 2 of an ANSI color are red, green and blue
+        for (size_t c = 0; c < 3; c++) {
+            rgb[c] = (index >> c) & 1 ? 255 : 0;
+        }
+    } else if (index < 16) {
+        copy_n(ANSI_RGB[index], 3, rgb);
+    } else if (index < 232) {
+        rgb[0] = CUBE_LEVELS[(index - 16) / 36];
+        rgb[1] = CUBE_LEVELS[(index - 16) / 6 % 6];
+        rgb[2] = CUBE_LEVELS[(index - 16) % 6];
+    } else {
+        rgb[0] = rgb[1] = rgb[2] = static_cast<uint8_t>(8 + 10 * (index - 232));
+    }
+}
+
+static int get_squared_distance(int r, int g, int b, const uint8_t* rgb) {
+    return (r - rgb[0]) * (r - rgb[0]) + (g - rgb[1]) * (g - rgb[1]) + (b - rgb[2]) * (b - rgb[2]);
+}
+
+// Nearest of CUBE_LEVELS, split at the midpoints 48, 115, 155, 195 and 235
+static int get_cube_level(int value) {
+    return value < 48 ? 0 : value < 115 ? 1 : (value - 35) / 40;
+}
+
+uint8_t get_nearest_palette_index(Palette palette, int r, int g, int b) {
+    if (palette == PALETTE_8) {
+        return static_cast<uint8_t>((r >= 128) | (g >= 128) << 1 | (b >= 128) << 2);
+    }
+
+    if (palette == PALETTE_16) {
+        uint8_t best = 0;
+        int best_distance = get_squared_distance(r, g, b, ANSI_RGB[0]);
+        for (uint8_t index = 1; index < 16; index++) {
+            int distance = get_squared_distance(r, g, b, ANSI_RGB[index]);
+            if (distance < best_distance) {
+                best = index;
+                best_distance = distance;
+            }
+        }
+        return best;
+    }
+
+    // The cube's nearest color is the nearest level of each channel, and the ramp's the gray nearest the mean
+    uint8_t cube = static_cast<uint8_t>(16 + 36 * get_cube_level(clamp(r, 0, 255)) + 6 * get_cube_level(clamp(g, 0, 255)) + get_cube_level(clamp(b, 0, 255)));
+    uint8_t gray = static_cast<uint8_t>(232 + clamp((r + g + b - 24 + 15) / 30, 0, 23));
+    uint8_t cube_rgb[3], gray_rgb[3];
+    get_palette_rgb(palette, cube, cube_rgb);
+    get_palette_rgb(palette, gray, gray_rgb);
+    return get_squared_distance(r, g, b, gray_rgb) < get_squared_distance(r, g, b, cube_rgb) ? gray : cube;
+}
+
+int get_palette_spread(Palette palette) {
+    switch (palette) {
+        case PALETTE_8:
+            return 255;
+        case PALETTE_16:
+            return 128;
+        case PALETTE_256:
+            return 51;
+        default:
+            return 0;
+    }
+}
+
+double calculate_grayscale_from_hsv(const HSV& hsv) {
+    // Use value * value for increased contrast
+    return hsv.value * hsv.value;
+}
+
+double srgb_to_linear(double value) {
+    return value <= 0.04045 ? value / 12.92 : pow((value + 0.055) / 1.055, 2.4);
+}
+
+double linear_to_srgb(double value) {
+    return value <= 0.0031308 ? value * 12.92 : 1.055 * pow(value, 1.0 / 2.4) - 0.055;
+}
+
+const uint16_t* get_linear_table() {
+    static const vector<uint16_t> table = [] {
+        vector<uint16_t> entries(256);
+        for (size_t i = 0; i < entries.size(); i++) {
+            entries[i] = static_cast<uint16_t>(lround(srgb_to_linear(i / 255.0) * LINEAR_MAX));
+        }
+        return entries;
+    }();
+    return table.data();
+}
+
+const double* get_linear_values() {
+    static const vector<double> table = [] {
+        vector<double> entries(256);
+        for (size_t i = 0; i < entries.size(); i++) {
+            entries[i] = srgb_to_linear(i / 255.0);
+        }
+        return entries;
+    }();
+    return table.data();
+}
+
+const uint16_t* get_srgb_table() {
+    static const vector<uint16_t> table = [] {
+        vector<uint16_t> entries(LINEAR_MAX + 1);
+        for (size_t i = 0; i < entries.size(); i++) {
+            entries[i] = static_cast<uint16_t>(lround(linear_to_srgb(static_cast<double>(i) / LINEAR_MAX) * (255 << 8)));
+        }
+        return entries;
+    }();
+    return table.data();
+}
\ No newline at end of file
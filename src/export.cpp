@@ -0,0 +1,412 @@
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../include/export.hpp"
+#include "../include/font.hpp"
+#include "../include/png.hpp"
+#include "../include/sixel.hpp"
+
+using namespace std;
+
+// Size of a cell in SVG output, in pixels. The font size is the one whose usual monospace
+// advance of 0.6 em fills a cell; rows are stretched to their exact width regardless.
+constexpr size_t SVG_CELL_WIDTH = 8;
+constexpr size_t SVG_CELL_HEIGHT = 16;
+
+bool parse_output_format(const string& name, OutputFormat& format) {
+    if (name == "ans") {
+        format = FORMAT_ANSI;
+    } else if (name == "txt") {
+        format = FORMAT_TEXT;
+    } else if (name == "html") {
+        format = FORMAT_HTML;
+    } else if (name == "svg") {
+        format = FORMAT_SVG;
+    } else if (name == "png") {
+        format = FORMAT_PNG;
+    } else if (name == "sixel") {
+        format = FORMAT_SIXEL;
+    } else if (name == "kitty") {
+        format = FORMAT_KITTY;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool parse_output_target(const string& text, OutputTarget& target) {
+    size_t colon = text.find(':');
+    if (colon == string::npos || colon + 1 == text.size()) {
+        return false;
+    }
+    target.path = text.substr(colon + 1);
+    return parse_output_format(text.substr(0, colon), target.format);
+}
+
+OutputBuffer::OutputBuffer(FILE* file, size_t capacity) : file(file), buffer(capacity), used(0), failed(false) {}
+
+OutputBuffer::~OutputBuffer() {
+    flush();
+}
+
+void OutputBuffer::write(const char* data, size_t n) {
+    if (used + n > buffer.size()) {
+        flush();
+        // Larger than the whole buffer: hand it over directly
+        if (n > buffer.size()) {
+            failed = failed || fwrite(data, 1, n, file) != n;
+            return;
+        }
+    }
+    memcpy(&buffer[used], data, n);
+    used += n;
+}
+
+bool OutputBuffer::flush() {
+    if (used > 0) {
+        failed = failed || fwrite(buffer.data(), 1, used, file) != used;
+        used = 0;
+    }
+    return fflush(file) == 0 && !failed;
+}
+
+// Decimal and two-digit hex text of every byte value, built once
+struct NumberTable {
+    char decimal[256][3];
+    uint8_t decimal_lengths[256];
+    char hex[256][2];
+};
+
+static const NumberTable& get_number_table() {
+    static const NumberTable table = [] {
+        NumberTable entries;
+        const char* hex_digits = "0123456789abcdef";
+        for (size_t i = 0; i < 256; i++) {
+            string decimal = to_string(i);
+            memcpy(entries.decimal[i], decimal.data(), decimal.size());
+            entries.decimal_lengths[i] = static_cast<uint8_t>(decimal.size());
+            entries.hex[i][0] = hex_digits[i >> 4];
+            entries.hex[i][1] = hex_digits[i & 15];
+        }
+        return entries;
+    }();
+    return table;
+}
+
+static size_t append_text(char* out, const char* text) {
+    size_t n = strlen(text);
+    memcpy(out, text, n);
+    return n;
+}
+
+static size_t append_decimal(char* out, uint8_t value) {
+    const NumberTable& table = get_number_table();
+    memcpy(out, table.decimal[value], table.decimal_lengths[value]);
+    return table.decimal_lengths[value];
+}
+
+// "#rrggbb"
+static size_t append_hex_color(char* out, const Cell& cell) {
+    const NumberTable& table = get_number_table();
+    out[0] = '#';
+    memcpy(out + 1, table.hex[cell.r], 2);
+    memcpy(out + 3, table.hex[cell.g], 2);
+    memcpy(out + 5, table.hex[cell.b], 2);
+    return 7;
+}
+
+size_t format_color_escape(const Cell& cell, Palette palette, char* out) {
+    size_t n = 0;
+    if (palette == PALETTE_TRUECOLOR) {
+        n += append_text(out, "\x1b[38;2;");
+        n += append_decimal(out + n, cell.r);
+        out[n++] = ';';
+        n += append_decimal(out + n, cell.g);
+        out[n++] = ';';
+        n += append_decimal(out + n, cell.b);
+    } else if (palette == PALETTE_256) {
+        n += append_text(out, "\x1b[38;5;");
+        n += append_decimal(out + n, get_nearest_palette_index(palette, cell.r, cell.g, cell.b));
+    } else {
+        // ANSI colors are 30-37, their bright variants 90-97
+        uint8_t index = get_nearest_palette_index(palette, cell.r, cell.g, cell.b);
+        n += append_text(out, "\x1b[");
+        n += append_decimal(out + n, static_cast<uint8_t>(index < 8 ? 30 + index : 90 + index - 8));
+    }
+    out[n++] = 'm';
+    return n;
+}
+
+// The charset's glyphs, then the edge glyphs, as a format writes them
+struct GlyphTable {
+    vector<string> glyphs;
+    vector<bool> blank;  // Whether the glyph shows no color
+    size_t n_classes;
+
+    size_t get_index(const Cell& cell) const { return cell.edge_dir != EDGE_NONE ? n_classes + cell.edge_dir : cell.glyph_class; }
+};
+
+// Escapes the characters markup gives a meaning
+static string escape_markup(const string& text) {
+    string escaped;
+    for (char c : text) {
+        if (c == '&') {
+            escaped += "&amp;";
+        } else if (c == '<') {
+            escaped += "&lt;";
+        } else if (c == '>') {
+            escaped += "&gt;";
+        } else {
+            escaped += c;
+        }
+    }
+    return escaped;
+}
+
+static GlyphTable make_glyph_table(const CellGrid& grid, OutputFormat format) {
+    GlyphTable table;
+    table.glyphs = grid.charset->glyphs;
+    table.n_classes = table.glyphs.size();
+    for (uint8_t edge_dir = EDGE_NONE; edge_dir <= EDGE_SLASH; edge_dir++) {
+        Cell cell = {0, 0, 0, 0, edge_dir};
+        table.glyphs.push_back(get_cell_glyph(cell, *grid.charset));
+    }
+
+    for (string& glyph : table.glyphs) {
+        table.blank.push_back(glyph.empty() || glyph == " ");
+        if (format == FORMAT_HTML || format == FORMAT_SVG) {
+            glyph = escape_markup(glyph);
+        }
+    }
+    return table;
+}
+
+// A pixel row of a cell in RGB, as whole words: FONT_WIDTH pixels of 3 bytes
+constexpr size_t TILE_ROW_WORDS = FONT_WIDTH * 3 / sizeof(uint64_t);
+
+static_assert(FONT_WIDTH * 3 % sizeof(uint64_t) == 0, "Cell rows must be whole words");
+
+ByteImage rasterize_cells(const CellGrid& grid) {
+    if (grid.empty()) {
+        return ByteImage();
+    }
+
+    // Atlas of every glyph the grid can show: FONT_HEIGHT rows of byte masks each, blank ones flagged
+    GlyphTable glyphs = make_glyph_table(grid, FORMAT_PNG);
+    vector<uint64_t> atlas(glyphs.glyphs.size() * FONT_HEIGHT * TILE_ROW_WORDS, 0);
+    for (size_t g = 0; g < glyphs.glyphs.size(); g++) {
+        const uint8_t* bitmap = get_glyph_bitmap(decode_utf8(glyphs.glyphs[g]));
+        if (!bitmap || glyphs.blank[g]) {
+            glyphs.blank[g] = true;
+            continue;
+        }
+        for (size_t y = 0; y < FONT_HEIGHT; y++) {
+            uint8_t mask[FONT_WIDTH * 3];
+            for (size_t x = 0; x < FONT_WIDTH; x++) {
+                memset(&mask[x * 3], (bitmap[y] >> (FONT_WIDTH - 1 - x)) & 1 ? 0xff : 0, 3);
+            }
+            memcpy(&atlas[(g * FONT_HEIGHT + y) * TILE_ROW_WORDS], mask, sizeof(mask));
+        }
+    }
+
+    size_t width = grid.width * FONT_WIDTH;
+    size_t height = grid.height * FONT_HEIGHT;
+    auto pixels = make_shared<vector<uint8_t>>(width * height * 3, 0);
+    for (size_t j = 0; j < grid.height; j++) {
+        for (size_t i = 0; i < grid.width; i++) {
+            const Cell& cell = grid.at(i, j);
+            size_t g = glyphs.get_index(cell);
+            if (glyphs.blank[g]) {
+                continue;
+            }
+
+            // The cell's color tinted across a whole row, then masked by each glyph row
+            uint8_t tint_bytes[FONT_WIDTH * 3];
+            for (size_t x = 0; x < FONT_WIDTH; x++) {
+                tint_bytes[x * 3] = cell.r;
+                tint_bytes[x * 3 + 1] = cell.g;
+                tint_bytes[x * 3 + 2] = cell.b;
+            }
+            uint64_t tint[TILE_ROW_WORDS];
+            memcpy(tint, tint_bytes, sizeof(tint));
+
+            const uint64_t* tile = &atlas[g * FONT_HEIGHT * TILE_ROW_WORDS];
+            uint8_t* out = &(*pixels)[((j * FONT_HEIGHT) * width + i * FONT_WIDTH) * 3];
+            for (size_t y = 0; y < FONT_HEIGHT; y++, tile += TILE_ROW_WORDS, out += width * 3) {
+                uint64_t row[TILE_ROW_WORDS];
+                for (size_t w = 0; w < TILE_ROW_WORDS; w++) {
+                    row[w] = tile[w] & tint[w];
+                }
+                memcpy(out, row, sizeof(row));
+            }
+        }
+    }
+    return ByteImage(width, height, 3, pixels->data(), pixels);
+}
+
+// Opens a run of cells of the color of `cell`, closing the previous one
+template <OutputFormat Format>
+static void write_run_start(const Cell& cell, Palette palette, bool close, OutputBuffer& out) {
+    char text[64];
+    size_t n = 0;
+    if constexpr (Format == FORMAT_ANSI) {
+        n = format_color_escape(cell, palette, text);
+    } else if constexpr (Format == FORMAT_HTML) {
+        if (close) {
+            n += append_text(text, "</span>");
+        }
+        n += append_text(text + n, "<span style=\"color:");
+        n += append_hex_color(text + n, cell);
+        n += append_text(text + n, "\">");
+    } else if constexpr (Format == FORMAT_SVG) {
+        if (close) {
+            n += append_text(text, "</tspan>");
+        }
+        n += append_text(text + n, "<tspan fill=\"");
+        n += append_hex_color(text + n, cell);
+        n += append_text(text + n, "\">");
+    }
+    out.write(text, n);
+}
+
+template <OutputFormat Format>
+static void write_rows(const CellGrid& grid, const GlyphTable& glyphs, OutputBuffer& out) {
+    // Runs carry on over line breaks, except in SVG where every row is its own element
+    bool in_run = false;
+    Cell run_color = {};
+    for (size_t y = 0; y < grid.height; y++) {
+        if constexpr (Format == FORMAT_SVG) {
+            out.write("<text y=\"" + to_string(y * SVG_CELL_HEIGHT + SVG_CELL_HEIGHT * 3 / 4) + "\" textLength=\"" + to_string(grid.width * SVG_CELL_WIDTH) +
+                      "\" lengthAdjust=\"spacing\">");
+        }
+
+        for (size_t x = 0; x < grid.width; x++) {
+            const Cell& cell = grid.at(x, y);
+            size_t index = glyphs.get_index(cell);
+            if constexpr (Format != FORMAT_TEXT) {
+                if (!glyphs.blank[index] && (!in_run || cell.r != run_color.r || cell.g != run_color.g || cell.b != run_color.b)) {
+                    write_run_start<Format>(cell, grid.palette, in_run, out);
+                    in_run = true;
+                    run_color = cell;
+                }
+            }
+            out.write(glyphs.glyphs[index]);
+        }
+
+        if constexpr (Format == FORMAT_SVG) {
+            out.write(in_run ? "</tspan></text>\n" : "</text>\n");
+            in_run = false;
+        } else {
+            out.write("\n", 1);
+        }
+    }
+
+    if constexpr (Format == FORMAT_HTML) {
+        if (in_run) {
+            out.write("</span>");
+        }
+    }
+}
+
+void write_cells(const CellGrid& grid, OutputFormat format, OutputBuffer& out) {
+    GlyphTable glyphs = make_glyph_table(grid, format);
+
+    switch (format) {
+        case FORMAT_ANSI:
+            write_rows<FORMAT_ANSI>(grid, glyphs, out);
+            out.write("\x1b[0m");
+            break;
+        case FORMAT_TEXT:
+            write_rows<FORMAT_TEXT>(grid, glyphs, out);
+            break;
+        case FORMAT_HTML:
+            out.write(
+                "<!DOCTYPE html>\n<html>\n<head>\n<meta charset=\"utf-8\">\n<title>ASCII art</title>\n"
+                "<style>body{margin:0;background:#000}pre{margin:0;font:16px/1 monospace}</style>\n</head>\n<body>\n<pre>\n");
+            write_rows<FORMAT_HTML>(grid, glyphs, out);
+            out.write("</pre>\n</body>\n</html>\n");
+            break;
+        case FORMAT_SVG: {
+            string width = to_string(grid.width * SVG_CELL_WIDTH);
+            string height = to_string(grid.height * SVG_CELL_HEIGHT);
+            out.write("<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"" + width + "\" height=\"" + height + "\" viewBox=\"0 0 " + width + " " + height + "\">\n");
+            out.write("<rect width=\"100%\" height=\"100%\" fill=\"#000\"/>\n");
+            out.write("<g font-family=\"monospace\" font-size=\"13.33\" xml:space=\"preserve\">\n");
+            write_rows<FORMAT_SVG>(grid, glyphs, out);
+            out.write("</g>\n</svg>\n");
+            break;
+        }
+        case FORMAT_PNG: {
+            vector<uint8_t> png = encode_png(rasterize_cells(grid));
+            out.write(reinterpret_cast<const char*>(png.data()), png.size());
+            break;
+        }
+        case FORMAT_SIXEL:
+        case FORMAT_KITTY:
+            throw invalid_argument("Pixel formats are encoded from pixels, not cells");
+    }
+}
+
+void write_pixels(const CellGrid& grid, const ByteImage& pixels, OutputFormat format, OutputBuffer& out, size_t threads, KittyTransfer transfer) {
+    if (format == FORMAT_SIXEL) {
+        out.write(encode_sixel(pixels, threads));
+    } else if (format == FORMAT_KITTY) {
+        out.write(KittyImage(get_kitty_image_id(), transfer).encode_frame(pixels, grid.width, grid.height));
+        out.write(string(grid.height, '\n'));
+    } else {
+        throw invalid_argument("Cell formats are written from cells, not pixels");
+    }
+}
+
+// Writes one target, on whichever thread; false if it failed
+static bool write_output(const CellGrid& grid, const ByteImage& pixels, const OutputTarget& target, size_t threads) {
+    bool to_stdout = target.path == "-";
+    FILE* file = to_stdout ? stdout : fopen(target.path.c_str(), "wb");
+    if (!file) {
+        return false;
+    }
+
+    bool written;
+    try {
+        OutputBuffer out(file);
+        if (is_pixel_format(target.format)) {
+            write_pixels(grid, pixels, target.format, out, threads, to_stdout && target.format == FORMAT_KITTY ? get_kitty_transfer() : KITTY_DIRECT);
+        } else {
+            write_cells(grid, target.format, out);
+        }
+        written = out.flush();
+    } catch (const exception&) {
+        written = false;
+    }
+    if (!to_stdout) {
+        written = fclose(file) == 0 && written;
+    }
+    return written;
+}
+
+vector<string> write_outputs(const CellGrid& grid, const ByteImage& pixels, const vector<OutputTarget>& targets, size_t threads) {
+    // The emitters only read the grid, so they share it without locks
+    vector<char> written(targets.size(), false);
+    vector<thread> pool;
+    for (size_t i = 1; i < targets.size(); i++) {
+        pool.emplace_back([&, i] { written[i] = write_output(grid, pixels, targets[i], threads); });
+    }
+    if (!targets.empty()) {
+        written[0] = write_output(grid, pixels, targets[0], threads);
+    }
+    for (thread& t : pool) {
+        t.join();
+    }
+
+    vector<string> failed;
+    for (size_t i = 0; i < targets.size(); i++) {
+        if (!written[i]) {
+            failed.push_back(targets[i].path);
+        }
+    }
+    return failed;
+}
\ No newline at end of file
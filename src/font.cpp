@@ -0,0 +1,537 @@
+#include <bitset>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "../include/font.hpp"
+
+using namespace std;
+
+// Basic Latin, Latin-1, box drawing and geometric shapes are DejaVu Sans Mono rasterized
+// at 8 pixels per advance with 8x8 supersampling, inked from 35% coverage. Block elements
+// are drawn exactly, with the shades as 25%, 50% and 75% dither patterns.
+
+static const uint8_t BASIC_LATIN[][FONT_HEIGHT] = {
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},  // U+0020 SPACE
+    {0x00, 0x00, 0x00, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x00, 0x00, 0x18, 0x18, 0x00, 0x00, 0x00},  // U+0021 !
+    {0x00, 0x00, 0x00, 0x3C, 0x3C, 0x3C, 0x24, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},  // U+0022 "
+    {0x00, 0x00, 0x00, 0x12, 0x12, 0x36, 0x7F, 0x24, 0x2C, 0xFE, 0x68, 0x48, 0x48, 0x00, 0x00, 0x00},  // U+0023 #
+    {0x00, 0x00, 0x00, 0x08, 0x3E, 0x68, 0x68, 0x78, 0x1E, 0x0A, 0x0A, 0x7E, 0x3C, 0x08, 0x00, 0x00},  // U+0024 $
+    {0x00, 0x00, 0x00, 0x60, 0xD0, 0x98, 0xF2, 0x2C, 0x76, 0x0F, 0x19, 0x0B, 0x06, 0x00, 0x00, 0x00},  // U+0025 %
+    {0x00, 0x00, 0x00, 0x3C, 0x60, 0x60, 0x30, 0x70, 0xD9, 0xCF, 0xC6, 0x66, 0x3B, 0x00, 0x00, 0x00},  // U+0026 &
+    {0x00, 0x00, 0x00, 0x18, 0x18, 0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},  // U+0027 '
+    {0x00, 0x00, 0x00, 0x08, 0x18, 0x18, 0x10, 0x10, 0x10, 0x10, 0x10, 0x18, 0x08, 0x08, 0x00, 0x00},  // U+0028 (
+    {0x00, 0x00, 0x00, 0x10, 0x18, 0x18, 0x08, 0x08, 0x08, 0x08, 0x08, 0x18, 0x10, 0x10, 0x00, 0x00},  // U+0029 )
+    {0x00, 0x00, 0x00, 0x18, 0x7E, 0x18, 0x3C, 0x5A, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},  // U+002A *
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x18, 0x18, 0x18, 0xFF, 0x18, 0x18, 0x18, 0x00, 0x00, 0x00, 0x00},  // U+002B +
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x18, 0x18, 0x10, 0x10, 0x00},  // U+002C ,
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x3C, 0x3C, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},  // U+002D -
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x18, 0x18, 0x00, 0x00, 0x00},  // U+002E .
+    {0x00, 0x00, 0x00, 0x06, 0x04, 0x0C, 0x08, 0x18, 0x18, 0x10, 0x30, 0x20, 0x60, 0x40, 0x00, 0x00},  // U+002F /
+    {0x00, 0x00, 0x00, 0x3C, 0x66, 0x66, 0x42, 0x5A, 0x5A, 0x42, 0x66, 0x3C, 0x18, 0x00, 0x00, 0x00},  // U+0030 0
+    {0x00, 0x00, 0x00, 0x38, 0x38, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x3E, 0x3E, 0x00, 0x00, 0x00},  // U+0031 1
+    {0x00, 0x00, 0x00, 0x7C, 0x46, 0x06, 0x06, 0x0C, 0x08, 0x10, 0x30, 0x7E, 0x7E, 0x00, 0x00, 0x00},  // U+0032 2
+    {0x00, 0x00, 0x00, 0x7C, 0x06, 0x06, 0x06, 0x3C, 0x06, 0x02, 0x06, 0x7E, 0x7C, 0x00, 0x00, 0x00},  // U+0033 3
+    {0x00, 0x00, 0x00, 0x0C, 0x1C, 0x14, 0x24, 0x64, 0x44, 0xFE, 0x0C, 0x04, 0x04, 0x00, 0x00, 0x00},  // U+0034 4
+    {0x00, 0x00, 0x00, 0x7C, 0x60, 0x60, 0x78, 0x6E, 0x06, 0x06, 0x06, 0x7C, 0x78, 0x00, 0x00, 0x00},  // U+0035 5
+    {0x00, 0x00, 0x00, 0x3E, 0x60, 0x60, 0x5C, 0x66, 0x62, 0x42, 0x62, 0x66, 0x3C, 0x00, 0x00, 0x00},  // U+0036 6
+    {0x00, 0x00, 0x00, 0x7E, 0x06, 0x04, 0x0C, 0x0C, 0x08, 0x18, 0x10, 0x30, 0x30, 0x00, 0x00, 0x00},  // U+0037 7
+    {0x00, 0x00, 0x00, 0x3C, 0x66, 0x66, 0x66, 0x3C, 0x66, 0x42, 0x42, 0x66, 0x3C, 0x00, 0x00, 0x00},  // U+0038 8
+    {0x00, 0x00, 0x00, 0x3C, 0x66, 0x46, 0x46, 0x66, 0x3E, 0x02, 0x06, 0x3C, 0x38, 0x00, 0x00, 0x00},  // U+0039 9
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x18, 0x18, 0x00, 0x00, 0x00, 0x18, 0x18, 0x00, 0x00, 0x00},  // U+003A :
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x18, 0x18, 0x00, 0x00, 0x00, 0x18, 0x18, 0x10, 0x10, 0x00},  // U+003B ;
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x0E, 0x78, 0xE0, 0x38, 0x0E, 0x00, 0x00, 0x00, 0x00, 0x00},  // U+003C <
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x7E, 0x7E, 0x00, 0x7E, 0x7E, 0x00, 0x00, 0x00, 0x00, 0x00},  // U+003D =
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x40, 0x70, 0x1E, 0x07, 0x1C, 0x70, 0x00, 0x00, 0x00, 0x00, 0x00},  // U+003E >
+    {0x00, 0x00, 0x00, 0x3C, 0x06, 0x06, 0x0C, 0x08, 0x18, 0x18, 0x00, 0x18, 0x10, 0x00, 0x00, 0x00},  // U+003F ?
+    {0x00, 0x00, 0x00, 0x08, 0x3E, 0x43, 0xCF, 0x9B, 0x91, 0x91, 0x93, 0xCF, 0x40, 0x30, 0x1E, 0x00},  // U+0040 @
+    {0x00, 0x00, 0x00, 0x18, 0x18, 0x3C, 0x24, 0x24, 0x66, 0x7E, 0x42, 0xC3, 0xC3, 0x00, 0x00, 0x00},  // U+0041 A
+    {0x00, 0x00, 0x00, 0x7C, 0x66, 0x62, 0x66, 0x7C, 0x66, 0x62, 0x62, 0x7E, 0x7C, 0x00, 0x00, 0x00},  // U+0042 B
+    {0x00, 0x00, 0x00, 0x3E, 0x20, 0x60, 0x60, 0x40, 0x40, 0x60, 0x60, 0x36, 0x1E, 0x00, 0x00, 0x00},  // U+0043 C
+    {0x00, 0x00, 0x00, 0x7C, 0x46, 0x46, 0x42, 0x42, 0x42, 0x46, 0x46, 0x7C, 0x78, 0x00, 0x00, 0x00},  // U+0044 D
+    {0x00, 0x00, 0x00, 0x7E, 0x60, 0x60, 0x60, 0x7E, 0x60, 0x60, 0x60, 0x7E, 0x7E, 0x00, 0x00, 0x00},  // U+0045 E
+    {0x00, 0x00, 0x00, 0x7E, 0x60, 0x60, 0x60, 0x7E, 0x60, 0x60, 0x60, 0x60, 0x20, 0x00, 0x00, 0x00},  // U+0046 F
+    {0x00, 0x00, 0x00, 0x3E, 0x62, 0x60, 0x40, 0xC6, 0x4E, 0x42, 0x62, 0x36, 0x1C, 0x00, 0x00, 0x00},  // U+0047 G
+    {0x00, 0x00, 0x00, 0x42, 0x42, 0x42, 0x42, 0x7E, 0x42, 0x42, 0x42, 0x42, 0x42, 0x00, 0x00, 0x00},  // U+0048 H
+    {0x00, 0x00, 0x00, 0x7E, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x7C, 0x7E, 0x00, 0x00, 0x00},  // U+0049 I
+    {0x00, 0x00, 0x00, 0x3C, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x6C, 0x78, 0x00, 0x00, 0x00},  // U+004A J
+    {0x00, 0x00, 0x00, 0x42, 0x44, 0x4C, 0x78, 0x78, 0x68, 0x4C, 0x46, 0x42, 0x43, 0x00, 0x00, 0x00},  // U+004B K
+    {0x00, 0x00, 0x00, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x7E, 0x7E, 0x00, 0x00, 0x00},  // U+004C L
+    {0x00, 0x00, 0x00, 0xE7, 0xE7, 0xE7, 0xFF, 0xDB, 0xDB, 0xC3, 0xC3, 0xC3, 0x42, 0x00, 0x00, 0x00},  // U+004D M
+    {0x00, 0x00, 0x00, 0x62, 0x62, 0x72, 0x52, 0x5A, 0x4A, 0x4E, 0x4E, 0x46, 0x46, 0x00, 0x00, 0x00},  // U+004E N
+    {0x00, 0x00, 0x00, 0x3C, 0x66, 0x42, 0x42, 0x42, 0x42, 0x42, 0x66, 0x7E, 0x3C, 0x00, 0x00, 0x00},  // U+004F O
+    {0x00, 0x00, 0x00, 0x7E, 0x66, 0x63, 0x62, 0x7E, 0x7C, 0x60, 0x60, 0x60, 0x60, 0x00, 0x00, 0x00},  // U+0050 P
+    {0x00, 0x00, 0x00, 0x3C, 0x66, 0x42, 0x42, 0x42, 0x42, 0x42, 0x66, 0x7E, 0x3C, 0x06, 0x00, 0x00},  // U+0051 Q
+    {0x00, 0x00, 0x00, 0x7C, 0x46, 0x46, 0x46, 0x7C, 0x7C, 0x46, 0x46, 0x43, 0x41, 0x00, 0x00, 0x00},  // U+0052 R
+    {0x00, 0x00, 0x00, 0x3E, 0x60, 0x40, 0x60, 0x3C, 0x0E, 0x02, 0x02, 0x6E, 0x7C, 0x00, 0x00, 0x00},  // U+0053 S
+    {0x00, 0x00, 0x00, 0xFF, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x00, 0x00, 0x00},  // U+0054 T
+    {0x00, 0x00, 0x00, 0x42, 0x42, 0x42, 0x42, 0x42, 0x42, 0x42, 0x42, 0x66, 0x3C, 0x00, 0x00, 0x00},  // U+0055 U
+    {0x00, 0x00, 0x00, 0xC3, 0x42, 0x66, 0x66, 0x24, 0x24, 0x3C, 0x3C, 0x18, 0x18, 0x00, 0x00, 0x00},  // U+0056 V
+    {0x00, 0x00, 0x00, 0x81, 0xC3, 0xC3, 0xDB, 0x5A, 0x5A, 0x7E, 0x66, 0x66, 0x66, 0x00, 0x00, 0x00},  // U+0057 W
+    {0x00, 0x00, 0x00, 0x42, 0x66, 0x34, 0x1C, 0x18, 0x1C, 0x34, 0x66, 0x42, 0xC3, 0x00, 0x00, 0x00},  // U+0058 X
+    {0x00, 0x00, 0x00, 0xC3, 0x66, 0x24, 0x3C, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x00, 0x00, 0x00},  // U+0059 Y
+    {0x00, 0x00, 0x00, 0x7F, 0x06, 0x06, 0x0C, 0x08, 0x18, 0x30, 0x20, 0x7E, 0x7F, 0x00, 0x00, 0x00},  // U+005A Z
+    {0x00, 0x00, 0x1C, 0x18, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x1C, 0x18, 0x00},  // U+005B [
+    {0x00, 0x00, 0x00, 0x40, 0x60, 0x20, 0x30, 0x10, 0x18, 0x08, 0x0C, 0x04, 0x06, 0x06, 0x00, 0x00},  // U+005C REVERSE SOLIDUS
+    {0x00, 0x00, 0x38, 0x18, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x38, 0x18, 0x00},  // U+005D ]
+    {0x00, 0x00, 0x00, 0x18, 0x3C, 0x66, 0x42, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},  // U+005E ^
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF},  // U+005F _
+    {0x00, 0x00, 0x30, 0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},  // U+0060 `
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x3C, 0x66, 0x06, 0x3E, 0x66, 0x46, 0x6E, 0x3A, 0x00, 0x00, 0x00},  // U+0061 a
+    {0x00, 0x00, 0x40, 0x60, 0x60, 0x7C, 0x76, 0x62, 0x62, 0x62, 0x62, 0x76, 0x7C, 0x00, 0x00, 0x00},  // U+0062 b
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x1E, 0x32, 0x60, 0x60, 0x60, 0x60, 0x32, 0x1E, 0x00, 0x00, 0x00},  // U+0063 c
+    {0x00, 0x00, 0x02, 0x06, 0x06, 0x3E, 0x6E, 0x46, 0x46, 0x46, 0x46, 0x6E, 0x3A, 0x00, 0x00, 0x00},  // U+0064 d
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x3C, 0x66, 0x42, 0x7E, 0x40, 0x40, 0x76, 0x1E, 0x00, 0x00, 0x00},  // U+0065 e
+    {0x00, 0x00, 0x06, 0x1E, 0x18, 0x7E, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x10, 0x00, 0x00, 0x00},  // U+0066 f
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x3A, 0x66, 0x46, 0x46, 0x46, 0x46, 0x7E, 0x3E, 0x06, 0x7C, 0x18},  // U+0067 g
+    {0x00, 0x00, 0x40, 0x60, 0x60, 0x7C, 0x76, 0x66, 0x66, 0x66, 0x66, 0x66, 0x42, 0x00, 0x00, 0x00},  // U+0068 h
+    {0x00, 0x00, 0x08, 0x18, 0x00, 0x38, 0x18, 0x18, 0x18, 0x18, 0x18, 0x3E, 0x7E, 0x00, 0x00, 0x00},  // U+0069 i
+    {0x00, 0x00, 0x08, 0x08, 0x00, 0x38, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x78, 0x20},  // U+006A j
+    {0x00, 0x00, 0x20, 0x60, 0x60, 0x62, 0x64, 0x68, 0x78, 0x6C, 0x64, 0x66, 0x23, 0x00, 0x00, 0x00},  // U+006B k
+    {0x00, 0x00, 0x70, 0x70, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x1C, 0x0E, 0x00, 0x00, 0x00},  // U+006C l
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x76, 0x5A, 0x5B, 0x5B, 0x5B, 0x5B, 0x5B, 0x4A, 0x00, 0x00, 0x00},  // U+006D m
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x7C, 0x76, 0x66, 0x66, 0x66, 0x66, 0x66, 0x42, 0x00, 0x00, 0x00},  // U+006E n
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x3C, 0x66, 0x66, 0x42, 0x42, 0x66, 0x66, 0x3C, 0x00, 0x00, 0x00},  // U+006F o
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x5C, 0x76, 0x62, 0x62, 0x62, 0x62, 0x76, 0x7C, 0x60, 0x60, 0x00},  // U+0070 p
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x3A, 0x6E, 0x66, 0x46, 0x46, 0x66, 0x6E, 0x3E, 0x06, 0x06, 0x00},  // U+0071 q
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x2E, 0x38, 0x30, 0x30, 0x30, 0x30, 0x30, 0x20, 0x00, 0x00, 0x00},  // U+0072 r
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x3C, 0x64, 0x60, 0x38, 0x0E, 0x06, 0x66, 0x3C, 0x00, 0x00, 0x00},  // U+0073 s
+    {0x00, 0x00, 0x00, 0x10, 0x10, 0x7E, 0x30, 0x10, 0x10, 0x10, 0x10, 0x1C, 0x0E, 0x00, 0x00, 0x00},  // U+0074 t
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x42, 0x66, 0x66, 0x66, 0x66, 0x66, 0x6E, 0x3A, 0x00, 0x00, 0x00},  // U+0075 u
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x42, 0x42, 0x66, 0x24, 0x24, 0x3C, 0x18, 0x18, 0x00, 0x00, 0x00},  // U+0076 v
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x81, 0xC3, 0xC3, 0x5A, 0x5A, 0x7E, 0x66, 0x24, 0x00, 0x00, 0x00},  // U+0077 w
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x42, 0x66, 0x3C, 0x18, 0x18, 0x3C, 0x66, 0x42, 0x00, 0x00, 0x00},  // U+0078 x
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x42, 0x62, 0x66, 0x24, 0x34, 0x1C, 0x18, 0x18, 0x10, 0x70, 0x00},  // U+0079 y
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x3E, 0x06, 0x0C, 0x08, 0x10, 0x30, 0x7C, 0x7E, 0x00, 0x00, 0x00},  // U+007A z
+    {0x00, 0x00, 0x04, 0x0C, 0x18, 0x18, 0x18, 0x18, 0x70, 0x18, 0x18, 0x18, 0x18, 0x18, 0x0E, 0x00},  // U+007B {
+    {0x00, 0x00, 0x00, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18},  // U+007C |
+    {0x00, 0x00, 0x20, 0x30, 0x18, 0x18, 0x18, 0x18, 0x0E, 0x18, 0x18, 0x18, 0x18, 0x18, 0x70, 0x00},  // U+007D }
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x20, 0x7E, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},  // U+007E ~
+};
+
+static const uint8_t LATIN_1[][FONT_HEIGHT] = {
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},  // U+00A0 NO-BREAK SPACE
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x18, 0x18, 0x00, 0x00, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x00},  // U+00A1 INVERTED EXCLAMATION MARK
+    {0x00, 0x00, 0x00, 0x08, 0x08, 0x1E, 0x3E, 0x68, 0x68, 0x68, 0x68, 0x3E, 0x1E, 0x08, 0x00, 0x00},  // U+00A2 CENT SIGN
+    {0x00, 0x00, 0x00, 0x1E, 0x30, 0x30, 0x30, 0x7C, 0x7C, 0x30, 0x30, 0x7E, 0x7E, 0x00, 0x00, 0x00},  // U+00A3 POUND SIGN
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x3E, 0x24, 0x26, 0x34, 0x7E, 0x00, 0x00, 0x00, 0x00, 0x00},  // U+00A4 CURRENCY SIGN
+    {0x00, 0x00, 0x00, 0xC3, 0x66, 0x24, 0x7E, 0x18, 0x7E, 0x18, 0x18, 0x18, 0x18, 0x00, 0x00, 0x00},  // U+00A5 YEN SIGN
+    {0x00, 0x00, 0x00, 0x18, 0x18, 0x18, 0x18, 0x18, 0x00, 0x00, 0x18, 0x18, 0x18, 0x18, 0x18, 0x00},  // U+00A6 BROKEN BAR
+    {0x00, 0x00, 0x00, 0x3C, 0x20, 0x30, 0x38, 0x64, 0x66, 0x36, 0x0C, 0x04, 0x04, 0x3C, 0x00, 0x00},  // U+00A7 SECTION SIGN
+    {0x00, 0x00, 0x24, 0x24, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},  // U+00A8 DIAERESIS
+    {0x00, 0x00, 0x00, 0x00, 0x3C, 0x5A, 0xA1, 0xE1, 0xA1, 0xBD, 0x42, 0x3C, 0x00, 0x00, 0x00, 0x00},  // U+00A9 COPYRIGHT SIGN
+    {0x00, 0x00, 0x00, 0x3C, 0x04, 0x3C, 0x24, 0x3C, 0x00, 0x3C, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},  // U+00AA FEMININE ORDINAL INDICATOR
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x12, 0x24, 0x48, 0x6C, 0x36, 0x00, 0x00, 0x00, 0x00, 0x00},  // U+00AB LEFT-POINTING DOUBLE ANGLE QUOTATION MARK
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0x03, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},  // U+00AC NOT SIGN
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x3C, 0x3C, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},  // U+00AD SOFT HYPHEN
+    {0x00, 0x00, 0x00, 0x00, 0x3C, 0x5A, 0xA5, 0xBD, 0xA9, 0xA5, 0x42, 0x3C, 0x00, 0x00, 0x00, 0x00},  // U+00AE REGISTERED SIGN
+    {0x00, 0x00, 0x00, 0x3C, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},  // U+00AF MACRON
+    {0x00, 0x00, 0x00, 0x3C, 0x24, 0x24, 0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},  // U+00B0 DEGREE SIGN
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x18, 0x18, 0x7E, 0x18, 0x18, 0x00, 0x7E, 0x7E, 0x00, 0x00, 0x00},  // U+00B1 PLUS-MINUS SIGN
+    {0x00, 0x00, 0x00, 0x3C, 0x04, 0x08, 0x10, 0x3C, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},  // U+00B2 SUPERSCRIPT TWO
+    {0x00, 0x00, 0x00, 0x3C, 0x04, 0x1C, 0x04, 0x3C, 0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},  // U+00B3 SUPERSCRIPT THREE
+    {0x00, 0x00, 0x0C, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},  // U+00B4 ACUTE ACCENT
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x42, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x7B, 0x60, 0x60, 0x00},  // U+00B5 MICRO SIGN
+    {0x00, 0x00, 0x00, 0x3E, 0x7A, 0x7A, 0x7A, 0x7A, 0x1A, 0x1A, 0x1A, 0x1A, 0x1A, 0x0A, 0x00, 0x00},  // U+00B6 PILCROW SIGN
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x18, 0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},  // U+00B7 MIDDLE DOT
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x08, 0x18, 0x00},  // U+00B8 CEDILLA
+    {0x00, 0x00, 0x00, 0x38, 0x18, 0x18, 0x18, 0x1C, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},  // U+00B9 SUPERSCRIPT ONE
+    {0x00, 0x00, 0x00, 0x3C, 0x24, 0x66, 0x24, 0x3C, 0x00, 0x3C, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},  // U+00BA MASCULINE ORDINAL INDICATOR
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x48, 0x24, 0x12, 0x36, 0x6C, 0x00, 0x00, 0x00, 0x00, 0x00},  // U+00BB RIGHT-POINTING DOUBLE ANGLE QUOTATION MARK
+    {0x00, 0x00, 0xE0, 0x20, 0x20, 0x20, 0x70, 0x1E, 0x70, 0x06, 0x0E, 0x16, 0x1E, 0x06, 0x00, 0x00},  // U+00BC VULGAR FRACTION ONE QUARTER
+    {0x00, 0x00, 0xE0, 0x20, 0x20, 0x20, 0x70, 0x1E, 0x78, 0x1E, 0x02, 0x06, 0x0C, 0x1E, 0x0E, 0x00},  // U+00BD VULGAR FRACTION ONE HALF
+    {0x00, 0x00, 0x70, 0x10, 0x30, 0x18, 0x70, 0x0E, 0x70, 0x06, 0x0E, 0x16, 0x1E, 0x06, 0x00, 0x00},  // U+00BE VULGAR FRACTION THREE QUARTERS
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x08, 0x18, 0x00, 0x18, 0x18, 0x10, 0x20, 0x60, 0x60, 0x3C, 0x00},  // U+00BF INVERTED QUESTION MARK
+    {0x10, 0x18, 0x00, 0x18, 0x18, 0x3C, 0x24, 0x24, 0x66, 0x7E, 0x42, 0xC3, 0xC3, 0x00, 0x00, 0x00},  // U+00C0 LATIN CAPITAL LETTER A WITH GRAVE
+    {0x08, 0x18, 0x00, 0x18, 0x18, 0x3C, 0x24, 0x24, 0x66, 0x7E, 0x42, 0xC3, 0xC3, 0x00, 0x00, 0x00},  // U+00C1 LATIN CAPITAL LETTER A WITH ACUTE
+    {0x18, 0x3C, 0x00, 0x18, 0x18, 0x3C, 0x24, 0x24, 0x66, 0x7E, 0x42, 0xC3, 0xC3, 0x00, 0x00, 0x00},  // U+00C2 LATIN CAPITAL LETTER A WITH CIRCUMFLEX
+    {0x34, 0x2C, 0x00, 0x18, 0x18, 0x3C, 0x24, 0x24, 0x66, 0x7E, 0x42, 0xC3, 0xC3, 0x00, 0x00, 0x00},  // U+00C3 LATIN CAPITAL LETTER A WITH TILDE
+    {0x24, 0x24, 0x00, 0x18, 0x18, 0x3C, 0x24, 0x24, 0x66, 0x7E, 0x42, 0xC3, 0xC3, 0x00, 0x00, 0x00},  // U+00C4 LATIN CAPITAL LETTER A WITH DIAERESIS
+    {0x18, 0x24, 0x24, 0x18, 0x18, 0x3C, 0x24, 0x24, 0x66, 0x7E, 0x42, 0xC3, 0xC3, 0x00, 0x00, 0x00},  // U+00C5 LATIN CAPITAL LETTER A WITH RING ABOVE
+    {0x00, 0x00, 0x00, 0x3F, 0x2C, 0x2C, 0x2C, 0x6F, 0x4C, 0x7C, 0xCC, 0xCE, 0x8F, 0x00, 0x00, 0x00},  // U+00C6 LATIN CAPITAL LETTER AE
+    {0x00, 0x00, 0x00, 0x3E, 0x20, 0x60, 0x60, 0x40, 0x40, 0x60, 0x60, 0x36, 0x1E, 0x04, 0x1C, 0x00},  // U+00C7 LATIN CAPITAL LETTER C WITH CEDILLA
+    {0x10, 0x18, 0x00, 0x7E, 0x60, 0x60, 0x60, 0x7E, 0x60, 0x60, 0x60, 0x7E, 0x7E, 0x00, 0x00, 0x00},  // U+00C8 LATIN CAPITAL LETTER E WITH GRAVE
+    {0x08, 0x18, 0x00, 0x7E, 0x60, 0x60, 0x60, 0x7E, 0x60, 0x60, 0x60, 0x7E, 0x7E, 0x00, 0x00, 0x00},  // U+00C9 LATIN CAPITAL LETTER E WITH ACUTE
+    {0x18, 0x34, 0x00, 0x7E, 0x60, 0x60, 0x60, 0x7E, 0x60, 0x60, 0x60, 0x7E, 0x7E, 0x00, 0x00, 0x00},  // U+00CA LATIN CAPITAL LETTER E WITH CIRCUMFLEX
+    {0x24, 0x34, 0x00, 0x7E, 0x60, 0x60, 0x60, 0x7E, 0x60, 0x60, 0x60, 0x7E, 0x7E, 0x00, 0x00, 0x00},  // U+00CB LATIN CAPITAL LETTER E WITH DIAERESIS
+    {0x10, 0x18, 0x00, 0x7E, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x7C, 0x7E, 0x00, 0x00, 0x00},  // U+00CC LATIN CAPITAL LETTER I WITH GRAVE
+    {0x08, 0x18, 0x00, 0x7E, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x7C, 0x7E, 0x00, 0x00, 0x00},  // U+00CD LATIN CAPITAL LETTER I WITH ACUTE
+    {0x18, 0x3C, 0x00, 0x7E, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x7C, 0x7E, 0x00, 0x00, 0x00},  // U+00CE LATIN CAPITAL LETTER I WITH CIRCUMFLEX
+    {0x24, 0x24, 0x00, 0x7E, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x7C, 0x7E, 0x00, 0x00, 0x00},  // U+00CF LATIN CAPITAL LETTER I WITH DIAERESIS
+    {0x00, 0x00, 0x00, 0x7C, 0x46, 0x46, 0x42, 0xF2, 0x42, 0x46, 0x46, 0x7C, 0x78, 0x00, 0x00, 0x00},  // U+00D0 LATIN CAPITAL LETTER ETH
+    {0x34, 0x2C, 0x00, 0x62, 0x62, 0x72, 0x52, 0x5A, 0x4A, 0x4E, 0x4E, 0x46, 0x46, 0x00, 0x00, 0x00},  // U+00D1 LATIN CAPITAL LETTER N WITH TILDE
+    {0x10, 0x18, 0x00, 0x3C, 0x66, 0x42, 0x42, 0x42, 0x42, 0x42, 0x66, 0x7E, 0x3C, 0x00, 0x00, 0x00},  // U+00D2 LATIN CAPITAL LETTER O WITH GRAVE
+    {0x08, 0x18, 0x00, 0x3C, 0x66, 0x42, 0x42, 0x42, 0x42, 0x42, 0x66, 0x7E, 0x3C, 0x00, 0x00, 0x00},  // U+00D3 LATIN CAPITAL LETTER O WITH ACUTE
+    {0x18, 0x3C, 0x00, 0x3C, 0x66, 0x42, 0x42, 0x42, 0x42, 0x42, 0x66, 0x7E, 0x3C, 0x00, 0x00, 0x00},  // U+00D4 LATIN CAPITAL LETTER O WITH CIRCUMFLEX
+    {0x34, 0x2C, 0x00, 0x3C, 0x66, 0x42, 0x42, 0x42, 0x42, 0x42, 0x66, 0x7E, 0x3C, 0x00, 0x00, 0x00},  // U+00D5 LATIN CAPITAL LETTER O WITH TILDE
+    {0x24, 0x24, 0x00, 0x3C, 0x66, 0x42, 0x42, 0x42, 0x42, 0x42, 0x66, 0x7E, 0x3C, 0x00, 0x00, 0x00},  // U+00D6 LATIN CAPITAL LETTER O WITH DIAERESIS
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x66, 0x3C, 0x18, 0x3C, 0x66, 0x00, 0x00, 0x00, 0x00, 0x00},  // U+00D7 MULTIPLICATION SIGN
+    {0x00, 0x00, 0x00, 0x3F, 0x66, 0x46, 0x4E, 0x5A, 0x52, 0x62, 0x66, 0x7E, 0xBC, 0x00, 0x00, 0x00},  // U+00D8 LATIN CAPITAL LETTER O WITH STROKE
+    {0x10, 0x18, 0x00, 0x42, 0x42, 0x42, 0x42, 0x42, 0x42, 0x42, 0x42, 0x66, 0x3C, 0x00, 0x00, 0x00},  // U+00D9 LATIN CAPITAL LETTER U WITH GRAVE
+    {0x08, 0x18, 0x00, 0x42, 0x42, 0x42, 0x42, 0x42, 0x42, 0x42, 0x42, 0x66, 0x3C, 0x00, 0x00, 0x00},  // U+00DA LATIN CAPITAL LETTER U WITH ACUTE
+    {0x18, 0x3C, 0x00, 0x42, 0x42, 0x42, 0x42, 0x42, 0x42, 0x42, 0x42, 0x66, 0x3C, 0x00, 0x00, 0x00},  // U+00DB LATIN CAPITAL LETTER U WITH CIRCUMFLEX
+    {0x24, 0x24, 0x00, 0x42, 0x42, 0x42, 0x42, 0x42, 0x42, 0x42, 0x42, 0x66, 0x3C, 0x00, 0x00, 0x00},  // U+00DC LATIN CAPITAL LETTER U WITH DIAERESIS
+    {0x08, 0x18, 0x00, 0xC3, 0x66, 0x24, 0x3C, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x00, 0x00, 0x00},  // U+00DD LATIN CAPITAL LETTER Y WITH ACUTE
+    {0x00, 0x00, 0x00, 0x60, 0x70, 0x7E, 0x63, 0x63, 0x63, 0x7E, 0x60, 0x60, 0x60, 0x00, 0x00, 0x00},  // U+00DE LATIN CAPITAL LETTER THORN
+    {0x00, 0x00, 0x18, 0x3C, 0x66, 0x6C, 0x78, 0x78, 0x6C, 0x66, 0x63, 0x76, 0x5C, 0x00, 0x00, 0x00},  // U+00DF LATIN SMALL LETTER SHARP S
+    {0x00, 0x00, 0x30, 0x10, 0x00, 0x3C, 0x66, 0x06, 0x3E, 0x66, 0x46, 0x6E, 0x3A, 0x00, 0x00, 0x00},  // U+00E0 LATIN SMALL LETTER A WITH GRAVE
+    {0x00, 0x00, 0x0C, 0x08, 0x00, 0x3C, 0x66, 0x06, 0x3E, 0x66, 0x46, 0x6E, 0x3A, 0x00, 0x00, 0x00},  // U+00E1 LATIN SMALL LETTER A WITH ACUTE
+    {0x00, 0x00, 0x18, 0x3C, 0x00, 0x3C, 0x66, 0x06, 0x3E, 0x66, 0x46, 0x6E, 0x3A, 0x00, 0x00, 0x00},  // U+00E2 LATIN SMALL LETTER A WITH CIRCUMFLEX
+    {0x00, 0x00, 0x34, 0x2C, 0x00, 0x3C, 0x66, 0x06, 0x3E, 0x66, 0x46, 0x6E, 0x3A, 0x00, 0x00, 0x00},  // U+00E3 LATIN SMALL LETTER A WITH TILDE
+    {0x00, 0x00, 0x24, 0x24, 0x00, 0x3C, 0x66, 0x06, 0x3E, 0x66, 0x46, 0x6E, 0x3A, 0x00, 0x00, 0x00},  // U+00E4 LATIN SMALL LETTER A WITH DIAERESIS
+    {0x00, 0x18, 0x24, 0x3C, 0x18, 0x3C, 0x66, 0x06, 0x3E, 0x66, 0x46, 0x6E, 0x3A, 0x00, 0x00, 0x00},  // U+00E5 LATIN SMALL LETTER A WITH RING ABOVE
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x7E, 0x1B, 0x19, 0x7F, 0xD8, 0xD8, 0xD9, 0x76, 0x00, 0x00, 0x00},  // U+00E6 LATIN SMALL LETTER AE
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x1E, 0x32, 0x60, 0x60, 0x60, 0x60, 0x32, 0x1E, 0x04, 0x1C, 0x00},  // U+00E7 LATIN SMALL LETTER C WITH CEDILLA
+    {0x00, 0x00, 0x30, 0x10, 0x00, 0x3C, 0x66, 0x42, 0x7E, 0x40, 0x40, 0x76, 0x1E, 0x00, 0x00, 0x00},  // U+00E8 LATIN SMALL LETTER E WITH GRAVE
+    {0x00, 0x00, 0x0C, 0x08, 0x00, 0x3C, 0x66, 0x42, 0x7E, 0x40, 0x40, 0x76, 0x1E, 0x00, 0x00, 0x00},  // U+00E9 LATIN SMALL LETTER E WITH ACUTE
+    {0x00, 0x00, 0x18, 0x3C, 0x00, 0x3C, 0x66, 0x42, 0x7E, 0x40, 0x40, 0x76, 0x1E, 0x00, 0x00, 0x00},  // U+00EA LATIN SMALL LETTER E WITH CIRCUMFLEX
+    {0x00, 0x00, 0x24, 0x34, 0x00, 0x3C, 0x66, 0x42, 0x7E, 0x40, 0x40, 0x76, 0x1E, 0x00, 0x00, 0x00},  // U+00EB LATIN SMALL LETTER E WITH DIAERESIS
+    {0x00, 0x00, 0x30, 0x10, 0x00, 0x38, 0x18, 0x18, 0x18, 0x18, 0x18, 0x3E, 0x7E, 0x00, 0x00, 0x00},  // U+00EC LATIN SMALL LETTER I WITH GRAVE
+    {0x00, 0x00, 0x0C, 0x08, 0x00, 0x38, 0x18, 0x18, 0x18, 0x18, 0x18, 0x3E, 0x7E, 0x00, 0x00, 0x00},  // U+00ED LATIN SMALL LETTER I WITH ACUTE
+    {0x00, 0x00, 0x18, 0x3C, 0x00, 0x38, 0x18, 0x18, 0x18, 0x18, 0x18, 0x3E, 0x7E, 0x00, 0x00, 0x00},  // U+00EE LATIN SMALL LETTER I WITH CIRCUMFLEX
+    {0x00, 0x00, 0x24, 0x34, 0x00, 0x38, 0x18, 0x18, 0x18, 0x18, 0x18, 0x3E, 0x7E, 0x00, 0x00, 0x00},  // U+00EF LATIN SMALL LETTER I WITH DIAERESIS
+    {0x00, 0x00, 0x20, 0x1C, 0x38, 0x1C, 0x3E, 0x66, 0x42, 0x42, 0x66, 0x66, 0x3C, 0x00, 0x00, 0x00},  // U+00F0 LATIN SMALL LETTER ETH
+    {0x00, 0x00, 0x34, 0x2C, 0x00, 0x7C, 0x76, 0x66, 0x66, 0x66, 0x66, 0x66, 0x42, 0x00, 0x00, 0x00},  // U+00F1 LATIN SMALL LETTER N WITH TILDE
+    {0x00, 0x00, 0x30, 0x10, 0x00, 0x3C, 0x66, 0x66, 0x42, 0x42, 0x66, 0x66, 0x3C, 0x00, 0x00, 0x00},  // U+00F2 LATIN SMALL LETTER O WITH GRAVE
+    {0x00, 0x00, 0x0C, 0x08, 0x00, 0x3C, 0x66, 0x66, 0x42, 0x42, 0x66, 0x66, 0x3C, 0x00, 0x00, 0x00},  // U+00F3 LATIN SMALL LETTER O WITH ACUTE
+    {0x00, 0x00, 0x18, 0x3C, 0x00, 0x3C, 0x66, 0x66, 0x42, 0x42, 0x66, 0x66, 0x3C, 0x00, 0x00, 0x00},  // U+00F4 LATIN SMALL LETTER O WITH CIRCUMFLEX
+    {0x00, 0x00, 0x34, 0x2C, 0x00, 0x3C, 0x66, 0x66, 0x42, 0x42, 0x66, 0x66, 0x3C, 0x00, 0x00, 0x00},  // U+00F5 LATIN SMALL LETTER O WITH TILDE
+    {0x00, 0x00, 0x24, 0x24, 0x00, 0x3C, 0x66, 0x66, 0x42, 0x42, 0x66, 0x66, 0x3C, 0x00, 0x00, 0x00},  // U+00F6 LATIN SMALL LETTER O WITH DIAERESIS
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x18, 0x18, 0x00, 0xFF, 0x00, 0x18, 0x18, 0x00, 0x00, 0x00, 0x00},  // U+00F7 DIVISION SIGN
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x3E, 0x66, 0x46, 0x4A, 0x52, 0x66, 0x66, 0xFC, 0x00, 0x00, 0x00},  // U+00F8 LATIN SMALL LETTER O WITH STROKE
+    {0x00, 0x00, 0x30, 0x10, 0x00, 0x42, 0x66, 0x66, 0x66, 0x66, 0x66, 0x6E, 0x3A, 0x00, 0x00, 0x00},  // U+00F9 LATIN SMALL LETTER U WITH GRAVE
+    {0x00, 0x00, 0x0C, 0x08, 0x00, 0x42, 0x66, 0x66, 0x66, 0x66, 0x66, 0x6E, 0x3A, 0x00, 0x00, 0x00},  // U+00FA LATIN SMALL LETTER U WITH ACUTE
+    {0x00, 0x00, 0x18, 0x3C, 0x00, 0x42, 0x66, 0x66, 0x66, 0x66, 0x66, 0x6E, 0x3A, 0x00, 0x00, 0x00},  // U+00FB LATIN SMALL LETTER U WITH CIRCUMFLEX
+    {0x00, 0x00, 0x24, 0x24, 0x00, 0x42, 0x66, 0x66, 0x66, 0x66, 0x66, 0x6E, 0x3A, 0x00, 0x00, 0x00},  // U+00FC LATIN SMALL LETTER U WITH DIAERESIS
+    {0x00, 0x00, 0x0C, 0x08, 0x00, 0x42, 0x62, 0x66, 0x24, 0x34, 0x1C, 0x18, 0x18, 0x10, 0x70, 0x00},  // U+00FD LATIN SMALL LETTER Y WITH ACUTE
+    {0x00, 0x00, 0x40, 0x60, 0x60, 0x7C, 0x76, 0x62, 0x62, 0x62, 0x62, 0x76, 0x7C, 0x60, 0x60, 0x00},  // U+00FE LATIN SMALL LETTER THORN
+    {0x00, 0x00, 0x24, 0x24, 0x00, 0x42, 0x62, 0x66, 0x24, 0x34, 0x1C, 0x18, 0x18, 0x10, 0x70, 0x00},  // U+00FF LATIN SMALL LETTER Y WITH DIAERESIS
+};
+
+static const uint8_t BOX_DRAWING[][FONT_HEIGHT] = {
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},  // U+2500 BOX DRAWINGS LIGHT HORIZONTAL
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},  // U+2501 BOX DRAWINGS HEAVY HORIZONTAL
+    {0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18},  // U+2502 BOX DRAWINGS LIGHT VERTICAL
+    {0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18},  // U+2503 BOX DRAWINGS HEAVY VERTICAL
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x5A, 0xDB, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},  // U+2504 BOX DRAWINGS LIGHT TRIPLE DASH HORIZONTAL
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xDB, 0xDB, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},  // U+2505 BOX DRAWINGS HEAVY TRIPLE DASH HORIZONTAL
+    {0x00, 0x18, 0x18, 0x18, 0x18, 0x00, 0x18, 0x18, 0x18, 0x18, 0x00, 0x18, 0x18, 0x18, 0x18, 0x00},  // U+2506 BOX DRAWINGS LIGHT TRIPLE DASH VERTICAL
+    {0x00, 0x18, 0x18, 0x18, 0x18, 0x00, 0x18, 0x18, 0x18, 0x18, 0x00, 0x18, 0x18, 0x18, 0x18, 0x00},  // U+2507 BOX DRAWINGS HEAVY TRIPLE DASH VERTICAL
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},  // U+2508 BOX DRAWINGS LIGHT QUADRUPLE DASH HORIZONTAL
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},  // U+2509 BOX DRAWINGS HEAVY QUADRUPLE DASH HORIZONTAL
+    {0x00, 0x18, 0x18, 0x00, 0x00, 0x18, 0x18, 0x00, 0x00, 0x18, 0x18, 0x00, 0x00, 0x18, 0x18, 0x00},  // U+250A BOX DRAWINGS LIGHT QUADRUPLE DASH VERTICAL
+    {0x00, 0x18, 0x18, 0x18, 0x00, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x00},  // U+250B BOX DRAWINGS HEAVY QUADRUPLE DASH VERTICAL
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x0F, 0x1F, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18},  // U+250C BOX DRAWINGS LIGHT DOWN AND RIGHT
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1F, 0x1F, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18},  // U+250D BOX DRAWINGS DOWN LIGHT AND RIGHT HEAVY
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1F, 0x1F, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18},  // U+250E BOX DRAWINGS DOWN HEAVY AND RIGHT LIGHT
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1F, 0x1F, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18},  // U+250F BOX DRAWINGS HEAVY DOWN AND RIGHT
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xF0, 0xF8, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18},  // U+2510 BOX DRAWINGS LIGHT DOWN AND LEFT
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xF8, 0xF8, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18},  // U+2511 BOX DRAWINGS DOWN LIGHT AND LEFT HEAVY
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xF8, 0xF8, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18},  // U+2512 BOX DRAWINGS DOWN HEAVY AND LEFT LIGHT
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xF8, 0xF8, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18},  // U+2513 BOX DRAWINGS HEAVY DOWN AND LEFT
+    {0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x1F, 0x0F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},  // U+2514 BOX DRAWINGS LIGHT UP AND RIGHT
+    {0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x1F, 0x1F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},  // U+2515 BOX DRAWINGS UP LIGHT AND RIGHT HEAVY
+    {0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x1F, 0x1F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},  // U+2516 BOX DRAWINGS UP HEAVY AND RIGHT LIGHT
+    {0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x1F, 0x1F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},  // U+2517 BOX DRAWINGS HEAVY UP AND RIGHT
+    {0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0xF8, 0xF0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},  // U+2518 BOX DRAWINGS LIGHT UP AND LEFT
+    {0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0xF8, 0xF8, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},  // U+2519 BOX DRAWINGS UP LIGHT AND LEFT HEAVY
+    {0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0xF8, 0xF8, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},  // U+251A BOX DRAWINGS UP HEAVY AND LEFT LIGHT
+    {0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0xF8, 0xF8, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},  // U+251B BOX DRAWINGS HEAVY UP AND LEFT
+    {0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x1F, 0x1F, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18},  // U+251C BOX DRAWINGS LIGHT VERTICAL AND RIGHT
+    {0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x1F, 0x1F, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18},  // U+251D BOX DRAWINGS VERTICAL LIGHT AND RIGHT HEAVY
+    {0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x1F, 0x1F, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18},  // U+251E BOX DRAWINGS UP HEAVY AND RIGHT DOWN LIGHT
+    {0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x1F, 0x1F, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18},  // U+251F BOX DRAWINGS DOWN HEAVY AND RIGHT UP LIGHT
+    {0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x1F, 0x1F, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18},  // U+2520 BOX DRAWINGS VERTICAL HEAVY AND RIGHT LIGHT
+    {0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x1F, 0x1F, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18},  // U+2521 BOX DRAWINGS DOWN LIGHT AND RIGHT UP HEAVY
+    {0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x1F, 0x1F, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18},  // U+2522 BOX DRAWINGS UP LIGHT AND RIGHT DOWN HEAVY
+    {0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x1F, 0x1F, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18},  // U+2523 BOX DRAWINGS HEAVY VERTICAL AND RIGHT
+    {0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0xF8, 0xF8, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18},  // U+2524 BOX DRAWINGS LIGHT VERTICAL AND LEFT
+    {0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0xF8, 0xF8, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18},  // U+2525 BOX DRAWINGS VERTICAL LIGHT AND LEFT HEAVY
+    {0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0xF8, 0xF8, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18},  // U+2526 BOX DRAWINGS UP HEAVY AND LEFT DOWN LIGHT
+    {0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0xF8, 0xF8, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18},  // U+2527 BOX DRAWINGS DOWN HEAVY AND LEFT UP LIGHT
+    {0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0xF8, 0xF8, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18},  // U+2528 BOX DRAWINGS VERTICAL HEAVY AND LEFT LIGHT
+    {0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0xF8, 0xF8, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18},  // U+2529 BOX DRAWINGS DOWN LIGHT AND LEFT UP HEAVY
+    {0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0xF8, 0xF8, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18},  // U+252A BOX DRAWINGS UP LIGHT AND LEFT DOWN HEAVY
+    {0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0xF8, 0xF8, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18},  // U+252B BOX DRAWINGS HEAVY VERTICAL AND LEFT
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18},  // U+252C BOX DRAWINGS LIGHT DOWN AND HORIZONTAL
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18},  // U+252D BOX DRAWINGS LEFT HEAVY AND RIGHT DOWN LIGHT
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18},  // U+252E BOX DRAWINGS RIGHT HEAVY AND LEFT DOWN LIGHT
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18},  // U+252F BOX DRAWINGS DOWN LIGHT AND HORIZONTAL HEAVY
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18},  // U+2530 BOX DRAWINGS DOWN HEAVY AND HORIZONTAL LIGHT
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18},  // U+2531 BOX DRAWINGS RIGHT LIGHT AND LEFT DOWN HEAVY
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18},  // U+2532 BOX DRAWINGS LEFT LIGHT AND RIGHT DOWN HEAVY
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18},  // U+2533 BOX DRAWINGS HEAVY DOWN AND HORIZONTAL
+    {0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0xFF, 0xFF, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},  // U+2534 BOX DRAWINGS LIGHT UP AND HORIZONTAL
+    {0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0xFF, 0xFF, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},  // U+2535 BOX DRAWINGS LEFT HEAVY AND RIGHT UP LIGHT
+    {0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0xFF, 0xFF, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},  // U+2536 BOX DRAWINGS RIGHT HEAVY AND LEFT UP LIGHT
+    {0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0xFF, 0xFF, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},  // U+2537 BOX DRAWINGS UP LIGHT AND HORIZONTAL HEAVY
+    {0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0xFF, 0xFF, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},  // U+2538 BOX DRAWINGS UP HEAVY AND HORIZONTAL LIGHT
+    {0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0xFF, 0xFF, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},  // U+2539 BOX DRAWINGS RIGHT LIGHT AND LEFT UP HEAVY
+    {0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0xFF, 0xFF, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},  // U+253A BOX DRAWINGS LEFT LIGHT AND RIGHT UP HEAVY
+    {0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0xFF, 0xFF, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},  // U+253B BOX DRAWINGS HEAVY UP AND HORIZONTAL
+    {0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0xFF, 0xFF, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18},  // U+253C BOX DRAWINGS LIGHT VERTICAL AND HORIZONTAL
+    {0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0xFF, 0xFF, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18},  // U+253D BOX DRAWINGS LEFT HEAVY AND RIGHT VERTICAL LIGHT
+    {0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0xFF, 0xFF, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18},  // U+253E BOX DRAWINGS RIGHT HEAVY AND LEFT VERTICAL LIGHT
+    {0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0xFF, 0xFF, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18},  // U+253F BOX DRAWINGS VERTICAL LIGHT AND HORIZONTAL HEAVY
+    {0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0xFF, 0xFF, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18},  // U+2540 BOX DRAWINGS UP HEAVY AND DOWN HORIZONTAL LIGHT
+    {0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0xFF, 0xFF, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18},  // U+2541 BOX DRAWINGS DOWN HEAVY AND UP HORIZONTAL LIGHT
+    {0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0xFF, 0xFF, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18},  // U+2542 BOX DRAWINGS VERTICAL HEAVY AND HORIZONTAL LIGHT
+    {0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0xFF, 0xFF, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18},  // U+2543 BOX DRAWINGS LEFT UP HEAVY AND RIGHT DOWN LIGHT
+    {0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0xFF, 0xFF, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18},  // U+2544 BOX DRAWINGS RIGHT UP HEAVY AND LEFT DOWN LIGHT
+    {0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0xFF, 0xFF, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18},  // U+2545 BOX DRAWINGS LEFT DOWN HEAVY AND RIGHT UP LIGHT
+    {0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0xFF, 0xFF, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18},  // U+2546 BOX DRAWINGS RIGHT DOWN HEAVY AND LEFT UP LIGHT
+    {0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0xFF, 0xFF, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18},  // U+2547 BOX DRAWINGS DOWN LIGHT AND UP HORIZONTAL HEAVY
+    {0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0xFF, 0xFF, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18},  // U+2548 BOX DRAWINGS UP LIGHT AND DOWN HORIZONTAL HEAVY
+    {0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0xFF, 0xFF, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18},  // U+2549 BOX DRAWINGS RIGHT LIGHT AND LEFT VERTICAL HEAVY
+    {0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0xFF, 0xFF, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18},  // U+254A BOX DRAWINGS LEFT LIGHT AND RIGHT VERTICAL HEAVY
+    {0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0xFF, 0xFF, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18},  // U+254B BOX DRAWINGS HEAVY VERTICAL AND HORIZONTAL
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x66, 0xFF, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},  // U+254C BOX DRAWINGS LIGHT DOUBLE DASH HORIZONTAL
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},  // U+254D BOX DRAWINGS HEAVY DOUBLE DASH HORIZONTAL
+    {0x00, 0x00, 0x18, 0x18, 0x18, 0x18, 0x18, 0x00, 0x00, 0x18, 0x18, 0x18, 0x18, 0x18, 0x00, 0x00},  // U+254E BOX DRAWINGS LIGHT DOUBLE DASH VERTICAL
+    {0x00, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x00, 0x00, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x00},  // U+254F BOX DRAWINGS HEAVY DOUBLE DASH VERTICAL
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0xFF, 0xFF, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},  // U+2550 BOX DRAWINGS DOUBLE HORIZONTAL
+    {0x3C, 0x3C, 0x3C, 0x3C, 0x3C, 0x3C, 0x3C, 0x3C, 0x3C, 0x3C, 0x3C, 0x3C, 0x3C, 0x3C, 0x3C, 0x3C},  // U+2551 BOX DRAWINGS DOUBLE VERTICAL
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x0F, 0x1F, 0x1F, 0x1F, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18},  // U+2552 BOX DRAWINGS DOWN SINGLE AND RIGHT DOUBLE
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1F, 0x3F, 0x3C, 0x3C, 0x3C, 0x3C, 0x3C, 0x3C, 0x3C},  // U+2553 BOX DRAWINGS DOWN DOUBLE AND RIGHT SINGLE
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1F, 0x3F, 0x37, 0x3F, 0x3C, 0x3C, 0x3C, 0x3C, 0x3C, 0x3C},  // U+2554 BOX DRAWINGS DOUBLE DOWN AND RIGHT
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xF0, 0xF8, 0xF8, 0xF8, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18},  // U+2555 BOX DRAWINGS DOWN SINGLE AND LEFT DOUBLE
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xF8, 0xFC, 0x3C, 0x3C, 0x3C, 0x3C, 0x3C, 0x3C, 0x3C},  // U+2556 BOX DRAWINGS DOWN DOUBLE AND LEFT SINGLE
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xF8, 0xFC, 0xEC, 0xFC, 0x3C, 0x3C, 0x3C, 0x3C, 0x3C, 0x3C},  // U+2557 BOX DRAWINGS DOUBLE DOWN AND LEFT
+    {0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x1F, 0x1F, 0x1F, 0x1F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},  // U+2558 BOX DRAWINGS UP SINGLE AND RIGHT DOUBLE
+    {0x3C, 0x3C, 0x3C, 0x3C, 0x3C, 0x3C, 0x3C, 0x3F, 0x1F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},  // U+2559 BOX DRAWINGS UP DOUBLE AND RIGHT SINGLE
+    {0x3C, 0x3C, 0x3C, 0x3C, 0x3C, 0x3C, 0x3F, 0x37, 0x3F, 0x3F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},  // U+255A BOX DRAWINGS DOUBLE UP AND RIGHT
+    {0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0xF8, 0xF8, 0xF8, 0xF8, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},  // U+255B BOX DRAWINGS UP SINGLE AND LEFT DOUBLE
+    {0x3C, 0x3C, 0x3C, 0x3C, 0x3C, 0x3C, 0x3C, 0xFC, 0xF8, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},  // U+255C BOX DRAWINGS UP DOUBLE AND LEFT SINGLE
+    {0x3C, 0x3C, 0x3C, 0x3C, 0x3C, 0x3C, 0xFC, 0xEC, 0xFC, 0xFC, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},  // U+255D BOX DRAWINGS DOUBLE UP AND LEFT
+    {0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x1F, 0x1F, 0x1F, 0x1F, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18},  // U+255E BOX DRAWINGS VERTICAL SINGLE AND RIGHT DOUBLE
+    {0x3C, 0x3C, 0x3C, 0x3C, 0x3C, 0x3C, 0x3C, 0x3F, 0x3F, 0x3C, 0x3C, 0x3C, 0x3C, 0x3C, 0x3C, 0x3C},  // U+255F BOX DRAWINGS VERTICAL DOUBLE AND RIGHT SINGLE
+    {0x3C, 0x3C, 0x3C, 0x3C, 0x3C, 0x3C, 0x3F, 0x37, 0x37, 0x3F, 0x3C, 0x3C, 0x3C, 0x3C, 0x3C, 0x3C},  // U+2560 BOX DRAWINGS DOUBLE VERTICAL AND RIGHT
+    {0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0xF8, 0xF8, 0xF8, 0xF8, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18},  // U+2561 BOX DRAWINGS VERTICAL SINGLE AND LEFT DOUBLE
+    {0x3C, 0x3C, 0x3C, 0x3C, 0x3C, 0x3C, 0x3C, 0xFC, 0xFC, 0x3C, 0x3C, 0x3C, 0x3C, 0x3C, 0x3C, 0x3C},  // U+2562 BOX DRAWINGS VERTICAL DOUBLE AND LEFT SINGLE
+    {0x3C, 0x3C, 0x3C, 0x3C, 0x3C, 0x3C, 0xFC, 0xEC, 0xEC, 0xFC, 0x3C, 0x3C, 0x3C, 0x3C, 0x3C, 0x3C},  // U+2563 BOX DRAWINGS DOUBLE VERTICAL AND LEFT
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0xFF, 0xFF, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18},  // U+2564 BOX DRAWINGS DOWN SINGLE AND HORIZONTAL DOUBLE
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0x3C, 0x3C, 0x3C, 0x3C, 0x3C, 0x3C, 0x3C},  // U+2565 BOX DRAWINGS DOWN DOUBLE AND HORIZONTAL SINGLE
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0xE7, 0xFF, 0x3C, 0x3C, 0x3C, 0x3C, 0x3C, 0x3C},  // U+2566 BOX DRAWINGS DOUBLE DOWN AND HORIZONTAL
+    {0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0xFF, 0xFF, 0xFF, 0xFF, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},  // U+2567 BOX DRAWINGS UP SINGLE AND HORIZONTAL DOUBLE
+    {0x3C, 0x3C, 0x3C, 0x3C, 0x3C, 0x3C, 0x3C, 0xFF, 0xFF, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},  // U+2568 BOX DRAWINGS UP DOUBLE AND HORIZONTAL SINGLE
+    {0x3C, 0x3C, 0x3C, 0x3C, 0x3C, 0x3C, 0xFF, 0xE7, 0xFF, 0xFF, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},  // U+2569 BOX DRAWINGS DOUBLE UP AND HORIZONTAL
+    {0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0xFF, 0xFF, 0xFF, 0xFF, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18},  // U+256A BOX DRAWINGS VERTICAL SINGLE AND HORIZONTAL DOUBLE
+    {0x3C, 0x3C, 0x3C, 0x3C, 0x3C, 0x3C, 0x3C, 0xFF, 0xFF, 0x3C, 0x3C, 0x3C, 0x3C, 0x3C, 0x3C, 0x3C},  // U+256B BOX DRAWINGS VERTICAL DOUBLE AND HORIZONTAL SINGLE
+    {0x3C, 0x3C, 0x3C, 0x3C, 0x3C, 0x3C, 0xFF, 0xE7, 0xE7, 0xFF, 0x3C, 0x3C, 0x3C, 0x3C, 0x3C, 0x3C},  // U+256C BOX DRAWINGS DOUBLE VERTICAL AND HORIZONTAL
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x07, 0x0F, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18},  // U+256D BOX DRAWINGS LIGHT ARC DOWN AND RIGHT
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xE0, 0xF0, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18},  // U+256E BOX DRAWINGS LIGHT ARC DOWN AND LEFT
+    {0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0xF0, 0xE0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},  // U+256F BOX DRAWINGS LIGHT ARC UP AND LEFT
+    {0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x0F, 0x07, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},  // U+2570 BOX DRAWINGS LIGHT ARC UP AND RIGHT
+    {0x01, 0x01, 0x03, 0x02, 0x06, 0x04, 0x0C, 0x08, 0x10, 0x10, 0x20, 0x60, 0x40, 0xC0, 0x80, 0x80},  // U+2571 BOX DRAWINGS LIGHT DIAGONAL UPPER RIGHT TO LOWER LEFT
+    {0x80, 0x80, 0xC0, 0x40, 0x60, 0x20, 0x30, 0x10, 0x08, 0x08, 0x04, 0x06, 0x02, 0x03, 0x01, 0x01},  // U+2572 BOX DRAWINGS LIGHT DIAGONAL UPPER LEFT TO LOWER RIGHT
+    {0x81, 0x81, 0xC3, 0x42, 0x66, 0x24, 0x3C, 0x18, 0x18, 0x18, 0x24, 0x66, 0x42, 0xC3, 0x81, 0x81},  // U+2573 BOX DRAWINGS LIGHT DIAGONAL CROSS
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xF0, 0xF0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},  // U+2574 BOX DRAWINGS LIGHT LEFT
+    {0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},  // U+2575 BOX DRAWINGS LIGHT UP
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x0F, 0x0F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},  // U+2576 BOX DRAWINGS LIGHT RIGHT
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18},  // U+2577 BOX DRAWINGS LIGHT DOWN
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xF0, 0xF0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},  // U+2578 BOX DRAWINGS HEAVY LEFT
+    {0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},  // U+2579 BOX DRAWINGS HEAVY UP
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x0F, 0x0F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},  // U+257A BOX DRAWINGS HEAVY RIGHT
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18},  // U+257B BOX DRAWINGS HEAVY DOWN
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},  // U+257C BOX DRAWINGS LIGHT LEFT AND HEAVY RIGHT
+    {0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18},  // U+257D BOX DRAWINGS LIGHT UP AND HEAVY DOWN
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},  // U+257E BOX DRAWINGS HEAVY LEFT AND LIGHT RIGHT
+    {0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18},  // U+257F BOX DRAWINGS HEAVY UP AND LIGHT DOWN
+};
+
+static const uint8_t BLOCK_ELEMENTS[][FONT_HEIGHT] = {
+    {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},  // U+2580 UPPER HALF BLOCK
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF},  // U+2581 LOWER ONE EIGHTH BLOCK
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0xFF, 0xFF},  // U+2582 LOWER ONE QUARTER BLOCK
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF},  // U+2583 LOWER THREE EIGHTHS BLOCK
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF},  // U+2584 LOWER HALF BLOCK
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF},  // U+2585 LOWER FIVE EIGHTHS BLOCK
+    {0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF},  // U+2586 LOWER THREE QUARTERS BLOCK
+    {0x00, 0x00, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF},  // U+2587 LOWER SEVEN EIGHTHS BLOCK
+    {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF},  // U+2588 FULL BLOCK
+    {0xFE, 0xFE, 0xFE, 0xFE, 0xFE, 0xFE, 0xFE, 0xFE, 0xFE, 0xFE, 0xFE, 0xFE, 0xFE, 0xFE, 0xFE, 0xFE},  // U+2589 LEFT SEVEN EIGHTHS BLOCK
+    {0xFC, 0xFC, 0xFC, 0xFC, 0xFC, 0xFC, 0xFC, 0xFC, 0xFC, 0xFC, 0xFC, 0xFC, 0xFC, 0xFC, 0xFC, 0xFC},  // U+258A LEFT THREE QUARTERS BLOCK
+    {0xF8, 0xF8, 0xF8, 0xF8, 0xF8, 0xF8, 0xF8, 0xF8, 0xF8, 0xF8, 0xF8, 0xF8, 0xF8, 0xF8, 0xF8, 0xF8},  // U+258B LEFT FIVE EIGHTHS BLOCK
+    {0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0},  // U+258C LEFT HALF BLOCK
+    {0xE0, 0xE0, 0xE0, 0xE0, 0xE0, 0xE0, 0xE0, 0xE0, 0xE0, 0xE0, 0xE0, 0xE0, 0xE0, 0xE0, 0xE0, 0xE0},  // U+258D LEFT THREE EIGHTHS BLOCK
+    {0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0},  // U+258E LEFT ONE QUARTER BLOCK
+    {0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80},  // U+258F LEFT ONE EIGHTH BLOCK
+    {0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F},  // U+2590 RIGHT HALF BLOCK
+    {0x88, 0x22, 0x88, 0x22, 0x88, 0x22, 0x88, 0x22, 0x88, 0x22, 0x88, 0x22, 0x88, 0x22, 0x88, 0x22},  // U+2591 LIGHT SHADE
+    {0xAA, 0x55, 0xAA, 0x55, 0xAA, 0x55, 0xAA, 0x55, 0xAA, 0x55, 0xAA, 0x55, 0xAA, 0x55, 0xAA, 0x55},  // U+2592 MEDIUM SHADE
+    {0x77, 0xDD, 0x77, 0xDD, 0x77, 0xDD, 0x77, 0xDD, 0x77, 0xDD, 0x77, 0xDD, 0x77, 0xDD, 0x77, 0xDD},  // U+2593 DARK SHADE
+    {0xFF, 0xFF, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},  // U+2594 UPPER ONE EIGHTH BLOCK
+    {0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01},  // U+2595 RIGHT ONE EIGHTH BLOCK
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0},  // U+2596 QUADRANT LOWER LEFT
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F},  // U+2597 QUADRANT LOWER RIGHT
+    {0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},  // U+2598 QUADRANT UPPER LEFT
+    {0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF},  // U+2599 QUADRANT UPPER LEFT AND LOWER LEFT AND LOWER RIGHT
+    {0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F},  // U+259A QUADRANT UPPER LEFT AND LOWER RIGHT
+    {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0},  // U+259B QUADRANT UPPER LEFT AND UPPER RIGHT AND LOWER LEFT
+    {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F},  // U+259C QUADRANT UPPER LEFT AND UPPER RIGHT AND LOWER RIGHT
+    {0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},  // U+259D QUADRANT UPPER RIGHT
+    {0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0},  // U+259E QUADRANT UPPER RIGHT AND LOWER LEFT
+    {0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF},  // U+259F QUADRANT UPPER RIGHT AND LOWER LEFT AND LOWER RIGHT
+};
+
+static const uint8_t GEOMETRIC_SHAPES[][FONT_HEIGHT] = {
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x00, 0x00, 0x00},  // U+25A0 BLACK SQUARE
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0x81, 0x81, 0x81, 0x81, 0x81, 0x81, 0xFF, 0x00, 0x00, 0x00},  // U+25A1 WHITE SQUARE
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x7E, 0x81, 0x81, 0x81, 0x81, 0x81, 0x81, 0xFF, 0x00, 0x00, 0x00},  // U+25A2 WHITE SQUARE WITH ROUNDED CORNERS
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0xBD, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x00, 0x00, 0x00},  // U+25A3 WHITE SQUARE CONTAINING BLACK SMALL SQUARE
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x00, 0x00, 0x00},  // U+25A4 SQUARE WITH HORIZONTAL FILL
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x00, 0x00, 0x00},  // U+25A5 SQUARE WITH VERTICAL FILL
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x00, 0x00, 0x00},  // U+25A6 SQUARE WITH ORTHOGONAL CROSSHATCH FILL
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0xAB, 0xD5, 0xAB, 0xD5, 0xAB, 0xD5, 0xFF, 0x00, 0x00, 0x00},  // U+25A7 SQUARE WITH UPPER LEFT TO LOWER RIGHT FILL
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0xD5, 0xAB, 0xD5, 0xAB, 0xD5, 0xAB, 0xFF, 0x00, 0x00, 0x00},  // U+25A8 SQUARE WITH UPPER RIGHT TO LOWER LEFT FILL
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x00, 0x00, 0x00},  // U+25A9 SQUARE WITH DIAGONAL CROSSHATCH FILL
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x3C, 0x7E, 0x7E, 0x7E, 0x7E, 0x7E, 0x00, 0x00, 0x00, 0x00},  // U+25AA BLACK SMALL SQUARE
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x3C, 0x42, 0x42, 0x42, 0x42, 0x7E, 0x00, 0x00, 0x00, 0x00},  // U+25AB WHITE SMALL SQUARE
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0xFF, 0xFF, 0x00, 0x00, 0x00, 0x00, 0x00},  // U+25AC BLACK RECTANGLE
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0x81, 0x81, 0xFF, 0x00, 0x00, 0x00, 0x00, 0x00},  // U+25AD WHITE RECTANGLE
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x3C, 0x3C, 0x3C, 0x3C, 0x3C, 0x3C, 0x3C, 0x3C, 0x00, 0x00, 0x00},  // U+25AE BLACK VERTICAL RECTANGLE
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x3C, 0x24, 0x24, 0x24, 0x24, 0x24, 0x24, 0x3C, 0x00, 0x00, 0x00},  // U+25AF WHITE VERTICAL RECTANGLE
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x3F, 0x7E, 0x7E, 0xFC, 0x00, 0x00, 0x00, 0x00, 0x00},  // U+25B0 BLACK PARALLELOGRAM
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x3F, 0x42, 0x42, 0xFC, 0x00, 0x00, 0x00, 0x00, 0x00},  // U+25B1 WHITE PARALLELOGRAM
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x18, 0x18, 0x3C, 0x3C, 0x7E, 0x7E, 0xFF, 0x00, 0x00, 0x00},  // U+25B2 BLACK UP-POINTING TRIANGLE
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x18, 0x18, 0x24, 0x24, 0x42, 0x42, 0xFF, 0x00, 0x00, 0x00},  // U+25B3 WHITE UP-POINTING TRIANGLE
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x18, 0x18, 0x3C, 0x3C, 0x3C, 0x00, 0x00, 0x00, 0x00},  // U+25B4 BLACK UP-POINTING SMALL TRIANGLE
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x18, 0x18, 0x24, 0x24, 0x3C, 0x00, 0x00, 0x00, 0x00},  // U+25B5 WHITE UP-POINTING SMALL TRIANGLE
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0xE0, 0xF8, 0xFE, 0xFE, 0xFC, 0xF0, 0xC0, 0x00, 0x00, 0x00},  // U+25B6 BLACK RIGHT-POINTING TRIANGLE
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0xE0, 0x98, 0x86, 0x86, 0x9C, 0xF0, 0xC0, 0x00, 0x00, 0x00},  // U+25B7 WHITE RIGHT-POINTING TRIANGLE
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x70, 0x7C, 0x7C, 0x70, 0x40, 0x00, 0x00, 0x00, 0x00},  // U+25B8 BLACK RIGHT-POINTING SMALL TRIANGLE
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x70, 0x5C, 0x4C, 0x70, 0x40, 0x00, 0x00, 0x00, 0x00},  // U+25B9 WHITE RIGHT-POINTING SMALL TRIANGLE
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xE0, 0xFC, 0xFE, 0xF0, 0x80, 0x00, 0x00, 0x00, 0x00},  // U+25BA BLACK RIGHT-POINTING POINTER
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xE0, 0x9C, 0x8E, 0xF0, 0x80, 0x00, 0x00, 0x00, 0x00},  // U+25BB WHITE RIGHT-POINTING POINTER
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0x7E, 0x7E, 0x3C, 0x3C, 0x18, 0x18, 0x00, 0x00, 0x00, 0x00},  // U+25BC BLACK DOWN-POINTING TRIANGLE
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0x42, 0x42, 0x24, 0x24, 0x18, 0x18, 0x00, 0x00, 0x00, 0x00},  // U+25BD WHITE DOWN-POINTING TRIANGLE
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x3C, 0x3C, 0x3C, 0x18, 0x18, 0x00, 0x00, 0x00, 0x00, 0x00},  // U+25BE BLACK DOWN-POINTING SMALL TRIANGLE
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x3C, 0x24, 0x24, 0x18, 0x18, 0x00, 0x00, 0x00, 0x00, 0x00},  // U+25BF WHITE DOWN-POINTING SMALL TRIANGLE
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x07, 0x1F, 0x7F, 0x7F, 0x3F, 0x0F, 0x03, 0x00, 0x00, 0x00},  // U+25C0 BLACK LEFT-POINTING TRIANGLE
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x07, 0x19, 0x61, 0x61, 0x39, 0x0F, 0x03, 0x00, 0x00, 0x00},  // U+25C1 WHITE LEFT-POINTING TRIANGLE
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x0E, 0x3E, 0x3E, 0x0E, 0x02, 0x00, 0x00, 0x00, 0x00},  // U+25C2 BLACK LEFT-POINTING SMALL TRIANGLE
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x0E, 0x3A, 0x32, 0x0E, 0x02, 0x00, 0x00, 0x00, 0x00},  // U+25C3 WHITE LEFT-POINTING SMALL TRIANGLE
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x07, 0x3F, 0x7F, 0x0F, 0x01, 0x00, 0x00, 0x00, 0x00},  // U+25C4 BLACK LEFT-POINTING POINTER
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x07, 0x39, 0x71, 0x0F, 0x01, 0x00, 0x00, 0x00, 0x00},  // U+25C5 WHITE LEFT-POINTING POINTER
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x18, 0x3C, 0x7E, 0xFF, 0x7E, 0x3C, 0x18, 0x00, 0x00, 0x00},  // U+25C6 BLACK DIAMOND
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x18, 0x24, 0x42, 0xC3, 0x66, 0x3C, 0x18, 0x00, 0x00, 0x00},  // U+25C7 WHITE DIAMOND
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x18, 0x3C, 0x7E, 0xFF, 0x7E, 0x3C, 0x18, 0x00, 0x00, 0x00},  // U+25C8 WHITE DIAMOND CONTAINING BLACK SMALL DIAMOND
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x3C, 0x7E, 0xFF, 0xFF, 0xFF, 0xBD, 0x5A, 0x3C, 0x00, 0x00, 0x00},  // U+25C9 FISHEYE
+    {0x00, 0x00, 0x00, 0x18, 0x18, 0x24, 0x24, 0x42, 0x42, 0x42, 0x42, 0x24, 0x24, 0x18, 0x18, 0x00},  // U+25CA LOZENGE
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x3C, 0x66, 0x81, 0x81, 0x81, 0x81, 0x42, 0x3C, 0x00, 0x00, 0x00},  // U+25CB WHITE CIRCLE
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x18, 0x42, 0x00, 0x81, 0x81, 0x00, 0x42, 0x18, 0x00, 0x00, 0x00},  // U+25CC DOTTED CIRCLE
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x3C, 0x7E, 0xFF, 0xFF, 0xFF, 0xFF, 0x7E, 0x3C, 0x00, 0x00, 0x00},  // U+25CD CIRCLE WITH VERTICAL FILL
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x3C, 0x66, 0x81, 0xBD, 0xA5, 0x99, 0x42, 0x3C, 0x00, 0x00, 0x00},  // U+25CE BULLSEYE
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x3C, 0x7E, 0xFF, 0xFF, 0xFF, 0xFF, 0x7E, 0x3C, 0x00, 0x00, 0x00},  // U+25CF BLACK CIRCLE
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x3C, 0x76, 0xF1, 0xF1, 0xF1, 0xF1, 0x72, 0x3C, 0x00, 0x00, 0x00},  // U+25D0 CIRCLE WITH LEFT HALF BLACK
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x3C, 0x6E, 0x8F, 0x8F, 0x8F, 0x8F, 0x4E, 0x3C, 0x00, 0x00, 0x00},  // U+25D1 CIRCLE WITH RIGHT HALF BLACK
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x3C, 0x66, 0x81, 0x81, 0xFF, 0xFF, 0x7E, 0x3C, 0x00, 0x00, 0x00},  // U+25D2 CIRCLE WITH LOWER HALF BLACK
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x3C, 0x7E, 0xFF, 0xFF, 0x81, 0x81, 0x42, 0x3C, 0x00, 0x00, 0x00},  // U+25D3 CIRCLE WITH UPPER HALF BLACK
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x3C, 0x6E, 0x8F, 0x8F, 0x81, 0x81, 0x42, 0x3C, 0x00, 0x00, 0x00},  // U+25D4 CIRCLE WITH UPPER RIGHT QUADRANT BLACK
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x3C, 0x6E, 0x8F, 0x8F, 0xFF, 0xFF, 0x7E, 0x3C, 0x00, 0x00, 0x00},  // U+25D5 CIRCLE WITH ALL BUT UPPER LEFT QUADRANT BLACK
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x0C, 0x1C, 0x3C, 0x3C, 0x3C, 0x3C, 0x1C, 0x0C, 0x00, 0x00, 0x00},  // U+25D6 LEFT HALF BLACK CIRCLE
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x30, 0x38, 0x3C, 0x3C, 0x3C, 0x3C, 0x38, 0x30, 0x00, 0x00, 0x00},  // U+25D7 RIGHT HALF BLACK CIRCLE
+    {0x00, 0x00, 0xFF, 0xFF, 0xFF, 0xFF, 0xE7, 0xC3, 0xC3, 0xFF, 0xFF, 0xFF, 0xFF, 0x00, 0x00, 0x00},  // U+25D8 INVERSE BULLET
+    {0x00, 0x00, 0xFF, 0xFF, 0xFF, 0xE7, 0xBD, 0xFF, 0x7E, 0x7E, 0x7E, 0xBD, 0xC3, 0xFF, 0xFF, 0xFF},  // U+25D9 INVERSE WHITE CIRCLE
+    {0x00, 0x00, 0xFF, 0xFF, 0xFF, 0xE7, 0xBD, 0xFF, 0x7E, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},  // U+25DA UPPER HALF INVERSE WHITE CIRCLE
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x7E, 0x7E, 0xBD, 0xC3, 0xFF, 0xFF, 0xFF},  // U+25DB LOWER HALF INVERSE WHITE CIRCLE
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x0C, 0x18, 0x20, 0x20, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},  // U+25DC UPPER LEFT QUADRANT CIRCULAR ARC
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x30, 0x18, 0x04, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},  // U+25DD UPPER RIGHT QUADRANT CIRCULAR ARC
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x04, 0x04, 0x08, 0x30, 0x00, 0x00, 0x00},  // U+25DE LOWER RIGHT QUADRANT CIRCULAR ARC
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x20, 0x20, 0x10, 0x0C, 0x00, 0x00, 0x00},  // U+25DF LOWER LEFT QUADRANT CIRCULAR ARC
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x3C, 0x66, 0x81, 0x81, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},  // U+25E0 UPPER HALF CIRCLE
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x81, 0x81, 0x42, 0x3C, 0x00, 0x00, 0x00},  // U+25E1 LOWER HALF CIRCLE
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x03, 0x07, 0x0F, 0x1F, 0x3F, 0x7F, 0x00, 0x00, 0x00},  // U+25E2 BLACK LOWER RIGHT TRIANGLE
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0xC0, 0xE0, 0xF0, 0xF8, 0xFC, 0xFE, 0x00, 0x00, 0x00},  // U+25E3 BLACK LOWER LEFT TRIANGLE
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0xFE, 0xFC, 0xF8, 0xF0, 0xE0, 0xC0, 0x80, 0x00, 0x00, 0x00},  // U+25E4 BLACK UPPER LEFT TRIANGLE
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0x7F, 0x3F, 0x1F, 0x0F, 0x07, 0x03, 0x01, 0x00, 0x00, 0x00},  // U+25E5 BLACK UPPER RIGHT TRIANGLE
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x24, 0x24, 0x24, 0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},  // U+25E6 WHITE BULLET
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0xF1, 0xF1, 0xF1, 0xF1, 0xF1, 0xF1, 0xFF, 0x00, 0x00, 0x00},  // U+25E7 SQUARE WITH LEFT HALF BLACK
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0x8F, 0x8F, 0x8F, 0x8F, 0x8F, 0x8F, 0xFF, 0x00, 0x00, 0x00},  // U+25E8 SQUARE WITH RIGHT HALF BLACK
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0xFD, 0xF9, 0xF1, 0xE1, 0xC1, 0xFF, 0x00, 0x00, 0x00},  // U+25E9 SQUARE WITH UPPER LEFT DIAGONAL HALF BLACK
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0x81, 0x83, 0x87, 0x8F, 0x9F, 0xBF, 0xFF, 0x00, 0x00, 0x00},  // U+25EA SQUARE WITH LOWER RIGHT DIAGONAL HALF BLACK
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0x99, 0x99, 0x99, 0x99, 0x99, 0x99, 0xFF, 0x00, 0x00, 0x00},  // U+25EB WHITE SQUARE WITH VERTICAL BISECTING LINE
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x18, 0x18, 0x24, 0x3C, 0x5A, 0x42, 0xFF, 0x00, 0x00, 0x00},  // U+25EC WHITE UP-POINTING TRIANGLE WITH DOT
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x18, 0x18, 0x34, 0x34, 0x72, 0x72, 0xFF, 0x00, 0x00, 0x00},  // U+25ED UP-POINTING TRIANGLE WITH LEFT HALF BLACK
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x18, 0x18, 0x2C, 0x2C, 0x4E, 0x4E, 0xFF, 0x00, 0x00, 0x00},  // U+25EE UP-POINTING TRIANGLE WITH RIGHT HALF BLACK
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x3C, 0x42, 0x81, 0x81, 0x81, 0x81, 0xC3, 0x7E, 0x00, 0x00, 0x00},  // U+25EF LARGE CIRCLE
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0x99, 0x99, 0x99, 0xF1, 0x81, 0x81, 0xFF, 0x00, 0x00, 0x00},  // U+25F0 WHITE SQUARE WITH UPPER LEFT QUADRANT
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0x81, 0x81, 0x81, 0xF9, 0x99, 0x99, 0xFF, 0x00, 0x00, 0x00},  // U+25F1 WHITE SQUARE WITH LOWER LEFT QUADRANT
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0x81, 0x81, 0x81, 0x9F, 0x99, 0x99, 0xFF, 0x00, 0x00, 0x00},  // U+25F2 WHITE SQUARE WITH LOWER RIGHT QUADRANT
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0x99, 0x99, 0x99, 0x8F, 0x81, 0x81, 0xFF, 0x00, 0x00, 0x00},  // U+25F3 WHITE SQUARE WITH UPPER RIGHT QUADRANT
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x3C, 0x7E, 0x99, 0x99, 0xF1, 0x81, 0x42, 0x3C, 0x00, 0x00, 0x00},  // U+25F4 WHITE CIRCLE WITH UPPER LEFT QUADRANT
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x3C, 0x66, 0x81, 0x81, 0xF9, 0x99, 0x5A, 0x3C, 0x00, 0x00, 0x00},  // U+25F5 WHITE CIRCLE WITH LOWER LEFT QUADRANT
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x3C, 0x66, 0x81, 0x81, 0x9F, 0x99, 0x5A, 0x3C, 0x00, 0x00, 0x00},  // U+25F6 WHITE CIRCLE WITH LOWER RIGHT QUADRANT
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x3C, 0x7E, 0x99, 0x99, 0x8F, 0x81, 0x42, 0x3C, 0x00, 0x00, 0x00},  // U+25F7 WHITE CIRCLE WITH UPPER RIGHT QUADRANT
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0x86, 0x8C, 0x98, 0xB0, 0xE0, 0xC0, 0x80, 0x00, 0x00, 0x00},  // U+25F8 UPPER LEFT TRIANGLE
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0x61, 0x31, 0x19, 0x0D, 0x07, 0x03, 0x01, 0x00, 0x00, 0x00},  // U+25F9 UPPER RIGHT TRIANGLE
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0xC0, 0xA0, 0x90, 0x88, 0x84, 0xFE, 0x00, 0x00, 0x00},  // U+25FA LOWER LEFT TRIANGLE
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0xC3, 0xC3, 0xC3, 0xC3, 0xC3, 0x7E, 0x00, 0x00, 0x00},  // U+25FB WHITE MEDIUM SQUARE
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x7E, 0x00, 0x00, 0x00},  // U+25FC BLACK MEDIUM SQUARE
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x7E, 0x42, 0x42, 0x42, 0x42, 0x7E, 0x00, 0x00, 0x00, 0x00},  // U+25FD WHITE MEDIUM SMALL SQUARE
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x7E, 0x7E, 0x7E, 0x7E, 0x7E, 0x7E, 0x00, 0x00, 0x00, 0x00},  // U+25FE BLACK MEDIUM SMALL SQUARE
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x03, 0x05, 0x09, 0x11, 0x21, 0x7F, 0x00, 0x00, 0x00},  // U+25FF LOWER RIGHT TRIANGLE
+};
+
+struct FontRange {
+    uint32_t first, last;
+    const uint8_t (*bitmaps)[FONT_HEIGHT];
+};
+
+static const FontRange FONT_RANGES[] = {
+    {0x0020, 0x007E, BASIC_LATIN}, {0x00A0, 0x00FF, LATIN_1}, {0x2500, 0x257F, BOX_DRAWING}, {0x2580, 0x259F, BLOCK_ELEMENTS}, {0x25A0, 0x25FF, GEOMETRIC_SHAPES},
+};
+
+const uint8_t* get_glyph_bitmap(uint32_t codepoint) {
+    for (const FontRange& range : FONT_RANGES) {
+        if (range.first <= codepoint && codepoint <= range.last) {
+            return range.bitmaps[codepoint - range.first];
+        }
+    }
+    return nullptr;
+}
+
+size_t get_glyph_coverage(const uint8_t* bitmap) {
+    size_t coverage = 0;
+    for (size_t y = 0; y < FONT_HEIGHT; y++) {
+        coverage += bitset<8>(bitmap[y]).count();
+    }
+    return coverage;
+}
+
+bool split_utf8(const string& text, vector<string>& characters) {
+    characters.clear();
+    size_t i = 0;
+    while (i < text.size()) {
+        uint8_t lead = static_cast<uint8_t>(text[i]);
+        size_t length = lead < 0x80 ? 1 : (lead >> 5) == 0x6 ? 2 : (lead >> 4) == 0xE ? 3 : (lead >> 3) == 0x1E ? 4 : 0;
+        if (length == 0 || i + length > text.size()) {
+            return false;
+        }
+        for (size_t k = 1; k < length; k++) {
+            if ((static_cast<uint8_t>(text[i + k]) >> 6) != 0x2) {
+                return false;
+            }
+        }
+        characters.push_back(text.substr(i, length));
+        i += length;
+    }
+    return true;
+}
+
+uint32_t decode_utf8(const string& character) {
+    if (character.empty()) {
+        return 0;
+    }
+    uint8_t lead = static_cast<uint8_t>(character[0]);
+    if (character.size() == 1) {
+        return lead;
+    }
+
+    // Payload bits of the lead byte, then 6 bits per continuation byte
+    uint32_t codepoint = lead & (0x7F >> character.size());
+    for (size_t k = 1; k < character.size(); k++) {
+        codepoint = (codepoint << 6) | (static_cast<uint8_t>(character[k]) & 0x3F);
+    }
+    return codepoint;
+}
\ No newline at end of file
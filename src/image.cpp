@@ -1,3 +1,5 @@
+#include <algorithm>
+#include <cstddef>
 #include <iostream>
 #include <memory>
 #include <stdexcept>
@@ -10,31 +12,223 @@
 #include "../include/stb_image.h"
 #pragma GCC diagnostic pop
 
+#include "../include/color.hpp"
 #include "../include/image.hpp"
 
 using namespace std;
 
 Image load_image(const string& file_path) {
+    return make_double_image(load_byte_image(file_path));
+}
+
+ByteImage load_byte_image(const string& file_path) {
     int width, height, channels;
     unsigned char* raw_data = stbi_load(file_path.c_str(), &width, &height, &channels, 0);
 
     if (!raw_data) {
         cerr << "Error: Failed to load image '" << file_path << "': " << stbi_failure_reason() << "!" << endl;
-        return Image();  // Return empty image on failure
+        return ByteImage();  // Return empty image on failure
+    }
+
+    // Keep stb's buffer instead of copying it
+    shared_ptr<const void> storage(raw_data, stbi_image_free);
+
+    return ByteImage(static_cast<size_t>(width), static_cast<size_t>(height), static_cast<size_t>(channels), raw_data, move(storage));
+}
+
+ByteImage load_byte_image_from_memory(const uint8_t* bytes, size_t size) {
+    int width, height, channels;
+    unsigned char* raw_data = stbi_load_from_memory(bytes, static_cast<int>(size), &width, &height, &channels, 0);
+
+    if (!raw_data) {
+        return ByteImage();  // Return empty image on failure
+    }
+
+    shared_ptr<const void> storage(raw_data, stbi_image_free);
+
+    return ByteImage(static_cast<size_t>(width), static_cast<size_t>(height), static_cast<size_t>(channels), raw_data, move(storage));
+}
+
+Image make_double_image(const ByteImage& image) {
+    if (image.empty()) {
+        return Image();
     }
 
     // Convert to [0., 1.]
-    size_t total_size = static_cast<size_t>(width) * height * channels;
+    size_t total_size = image.width * image.height * image.channels;
     vector<double> data;
     data.reserve(total_size);
 
     for (size_t i = 0; i < total_size; i++) {
-        data.push_back(raw_data[i] / 255.0);
+        data.push_back(image.data[i] / 255.0);
+    }
+
+    return Image(image.width, image.height, image.channels, move(data));
+}
+
+void get_oriented_dimensions(size_t width, size_t height, int orientation, size_t& oriented_width, size_t& oriented_height) {
+    bool swapped = orientation >= 5 && orientation <= 8;
+    oriented_width = swapped ? height : width;
+    oriented_height = swapped ? width : height;
+}
+
+// Maps pixel (x, y) of the upright image to the stored image of size width x height
+void get_source_position(size_t width, size_t height, int orientation, size_t x, size_t y, size_t& source_x, size_t& source_y) {
+    switch (orientation) {
+        case 2:
+            source_x = width - 1 - x;
+            source_y = y;
+            break;
+        case 3:
+            source_x = width - 1 - x;
+            source_y = height - 1 - y;
+            break;
+        case 4:
+            source_x = x;
+            source_y = height - 1 - y;
+            break;
+        case 5:
+            source_x = y;
+            source_y = x;
+            break;
+        case 6:
+            source_x = y;
+            source_y = height - 1 - x;
+            break;
+        case 7:
+            source_x = width - 1 - y;
+            source_y = height - 1 - x;
+            break;
+        case 8:
+            source_x = width - 1 - y;
+            source_y = x;
+            break;
+        default:
+            source_x = x;
+            source_y = y;
+            break;
+    }
+}
+
+void get_oriented_box(size_t stored_width, size_t stored_height, int orientation, size_t width, size_t height, size_t i, size_t j, size_t& x1, size_t& x2, size_t& y1, size_t& y2) {
+    size_t upright_width, upright_height;
+    get_oriented_dimensions(stored_width, stored_height, orientation, upright_width, upright_height);
+
+    // Box in the upright image
+    size_t upright_x1 = (i * upright_width) / width;
+    size_t upright_x2 = ((i + 1) * upright_width) / width;
+    size_t upright_y1 = (j * upright_height) / height;
+    size_t upright_y2 = ((j + 1) * upright_height) / height;
+
+    // Boundaries map onto the stored axes, reversed where get_source_position mirrors them
+    bool transposed = orientation >= 5 && orientation <= 8;
+    bool mirror_x = orientation == 2 || orientation == 3 || orientation == 7 || orientation == 8;
+    bool mirror_y = orientation == 3 || orientation == 4 || orientation == 6 || orientation == 7;
+
+    x1 = transposed ? upright_y1 : upright_x1;
+    x2 = transposed ? upright_y2 : upright_x2;
+    y1 = transposed ? upright_x1 : upright_y1;
+    y2 = transposed ? upright_x2 : upright_y2;
+    if (mirror_x) {
+        size_t left = stored_width - x2;
+        x2 = stored_width - x1;
+        x1 = left;
+    }
+    if (mirror_y) {
+        size_t top = stored_height - y2;
+        y2 = stored_height - y1;
+        y1 = top;
+    }
+}
+
+// Pixels per side of the square blocks make_oriented copies at a time, so that both the
+// rows read and the rows written stay in cache when the copy transposes
+constexpr size_t ORIENT_BLOCK_SIZE = 32;
+
+// Cache-blocked copy of the stored image into upright order. Every orientation is an affine
+// walk through the source, so the target is filled row by row while the source is read
+// along whichever axis the orientation maps its rows to.
+template <typename T, size_t Channels>
+static void copy_oriented(const T* source, size_t stored_width, size_t stored_height, int orientation, T* target) {
+    constexpr size_t channels = Channels;
+    size_t width, height;
+    get_oriented_dimensions(stored_width, stored_height, orientation, width, height);
+
+    // Source offset of upright pixel (x, y) is origin + x * step_x + y * step_y
+    size_t origin_x, origin_y, next_x, next_y;
+    get_source_position(stored_width, stored_height, orientation, 0, 0, origin_x, origin_y);
+    ptrdiff_t origin = static_cast<ptrdiff_t>((origin_y * stored_width + origin_x) * channels);
+    ptrdiff_t step_x = 0, step_y = 0;
+    if (width > 1) {
+        get_source_position(stored_width, stored_height, orientation, 1, 0, next_x, next_y);
+        step_x = static_cast<ptrdiff_t>((next_y * stored_width + next_x) * channels) - origin;
+    }
+    if (height > 1) {
+        get_source_position(stored_width, stored_height, orientation, 0, 1, next_x, next_y);
+        step_y = static_cast<ptrdiff_t>((next_y * stored_width + next_x) * channels) - origin;
+    }
+
+    for (size_t block_y = 0; block_y < height; block_y += ORIENT_BLOCK_SIZE) {
+        size_t end_y = min(block_y + ORIENT_BLOCK_SIZE, height);
+        for (size_t block_x = 0; block_x < width; block_x += ORIENT_BLOCK_SIZE) {
+            size_t end_x = min(block_x + ORIENT_BLOCK_SIZE, width);
+            for (size_t y = block_y; y < end_y; y++) {
+                const T* in = source + origin + static_cast<ptrdiff_t>(y) * step_y + static_cast<ptrdiff_t>(block_x) * step_x;
+                T* out = target + (y * width + block_x) * channels;
+                for (size_t x = block_x; x < end_x; x++, in += step_x, out += channels) {
+                    for (size_t c = 0; c < Channels; c++) {
+                        out[c] = in[c];
+                    }
+                }
+            }
+        }
+    }
+}
+
+template <typename T>
+static void copy_oriented(const T* source, size_t stored_width, size_t stored_height, size_t channels, int orientation, T* target) {
+    switch (channels) {
+        case 1:
+            copy_oriented<T, 1>(source, stored_width, stored_height, orientation, target);
+            break;
+        case 2:
+            copy_oriented<T, 2>(source, stored_width, stored_height, orientation, target);
+            break;
+        case 3:
+            copy_oriented<T, 3>(source, stored_width, stored_height, orientation, target);
+            break;
+        case 4:
+            copy_oriented<T, 4>(source, stored_width, stored_height, orientation, target);
+            break;
+        default:
+            throw invalid_argument("Image must have 1 to 4 channels");
     }
+}
+
+ByteImage make_oriented(const ByteImage& image, int orientation) {
+    if (image.empty() || orientation <= 1 || orientation > 8) {
+        return image;
+    }
+
+    size_t width, height;
+    get_oriented_dimensions(image.width, image.height, orientation, width, height);
+    auto pixels = make_shared<vector<uint8_t>>(width * height * image.channels);
+    copy_oriented(image.data, image.width, image.height, image.channels, orientation, pixels->data());
 
-    stbi_image_free(raw_data);
+    return ByteImage(width, height, image.channels, pixels->data(), pixels);
+}
 
-    return Image(static_cast<size_t>(width), static_cast<size_t>(height), static_cast<size_t>(channels), move(data));
+Image make_oriented(const Image& image, int orientation) {
+    size_t width, height;
+    get_oriented_dimensions(image.width, image.height, orientation, width, height);
+    vector<double> data(image.data.size());
+    if (orientation <= 1 || orientation > 8) {
+        data = image.data;
+    } else if (!image.empty()) {
+        copy_oriented(image.data.data(), image.width, image.height, image.channels, orientation, data.data());
+    }
+
+    return Image(width, height, image.channels, move(data));
 }
 
 // Gets pointer to pixel data at index (x, y)
@@ -65,7 +259,7 @@ void set_pixel(Image& image, size_t x, size_t y, const vector<double>& new_pixel
 }
 
 // Gets average pixel value in rectangular region; writes to `average`
-void get_average(const Image& image, vector<double>& average, size_t x1, size_t x2, size_t y1, size_t y2) {
+void get_average(const Image& image, vector<double>& average, size_t x1, size_t x2, size_t y1, size_t y2, bool linear_light) {
     if (average.size() != image.channels) {
         average.resize(image.channels, 0.0);
     } else {
@@ -78,55 +272,77 @@ void get_average(const Image& image, vector<double>& average, size_t x1, size_t
     y1 = min(y1, image.height);
     y2 = min(y2, image.height);
 
-    // Get total
+    // Get total. Colors with alpha are premultiplied, so transparent pixels add nothing to them.
+    size_t n_colors = image.channels == 2 || image.channels == 4 ? image.channels - 1 : image.channels;
+    const double* linear_values = get_linear_values();
     for (size_t y = y1; y < y2; y++) {
         for (size_t x = x1; x < x2; x++) {
             const double* pixel = get_pixel(image, x, y);
-            for (size_t c = 0; c < image.channels; c++) {
-                average[c] += pixel[c];
+            double weight = n_colors < image.channels ? pixel[n_colors] : 1.0;
+            for (size_t c = 0; c < n_colors; c++) {
+                // Loaded pixels are on the 8-bit grid, so linear light comes from the table
+                double value = linear_light ? linear_values[static_cast<int32_t>(pixel[c] * 255.0 + 0.5)] : pixel[c];
+                average[c] += value * weight;
+            }
+            if (n_colors < image.channels) {
+                average[n_colors] += weight;
             }
         }
     }
 
-    // Divide by number of pixels in region
+    // Divide colors by their total weight and alpha by the number of pixels in region
     double n_pixels = static_cast<double>((x2 - x1) * (y2 - y1));
-    if (n_pixels > 0) {
-        for (size_t c = 0; c < image.channels; c++) {
-            average[c] /= n_pixels;
+    double total_weight = n_colors < image.channels ? average[n_colors] : n_pixels;
+    if (total_weight > 0) {
+        for (size_t c = 0; c < n_colors; c++) {
+            average[c] /= total_weight;
+        }
+    }
+    if (linear_light) {
+        for (size_t c = 0; c < n_colors; c++) {
+            average[c] = linear_to_srgb(average[c]);
         }
     }
+    if (n_colors < image.channels && n_pixels > 0) {
+        average[n_colors] /= n_pixels;
+    }
 }
 
-Image make_resized(const Image& original, size_t max_width, size_t max_height, double character_ratio) {
-    size_t width, height;
-    size_t channels = original.channels;
-
+// Gets the largest cell grid that fits in max_width x max_height and keeps the aspect ratio
+void get_resized_dimensions(size_t original_width, size_t original_height, size_t max_width, size_t max_height, double character_ratio, size_t& width, size_t& height) {
     // Note: Dividing heights by 2 for approximate terminal font aspect ratio
-    size_t proposed_height = (original.height * max_width) / (character_ratio * original.width);
+    size_t proposed_height = (original_height * max_width) / (character_ratio * original_width);
     if (proposed_height <= max_height) {
         width = max_width;
         height = proposed_height;
     } else {
-        width = (character_ratio * original.width * max_height) / original.height;
+        width = (character_ratio * original_width * max_height) / original_height;
         height = max_height;
     }
 
     // Ensure minimum dimensions
     width = max(width, static_cast<size_t>(1));
     height = max(height, static_cast<size_t>(1));
+}
+
+Image make_resized(const Image& original, size_t max_width, size_t max_height, double character_ratio, int orientation, bool linear_light) {
+    size_t width, height, upright_width, upright_height;
+    size_t channels = original.channels;
+
+    get_oriented_dimensions(original.width, original.height, orientation, upright_width, upright_height);
+    get_resized_dimensions(upright_width, upright_height, max_width, max_height, character_ratio, width, height);
 
     vector<double> data(width * height * channels, 0.0);
 
-    // i, j are coordinates in resized image
+    // i, j are coordinates in the upright resized image; the orientation only changes
+    // which stored pixels each one averages, so no rotated copy is made
     for (size_t j = 0; j < height; j++) {
-        size_t y1 = (j * original.height) / height;
-        size_t y2 = ((j + 1) * original.height) / height;
         for (size_t i = 0; i < width; i++) {
-            size_t x1 = (i * original.width) / width;
-            size_t x2 = ((i + 1) * original.width) / width;
+            size_t x1, x2, y1, y2;
+            get_oriented_box(original.width, original.height, orientation, width, height, i, j, x1, x2, y1, y2);
 
             vector<double> average(channels, 0.0);
-            get_average(original, average, x1, x2, y1, y2);
+            get_average(original, average, x1, x2, y1, y2, linear_light);
 
             // Copy average to result
             size_t data_index = (i + j * width) * channels;
@@ -139,6 +355,51 @@ Image make_resized(const Image& original, size_t max_width, size_t max_height, d
     return Image(width, height, channels, move(data));
 }
 
+ByteImage make_box_resized(const ByteImage& image, size_t width, size_t height) {
+    if (image.empty() || width == 0 || height == 0) {
+        return ByteImage();
+    }
+
+    size_t channels = image.channels;
+    size_t row_samples = image.width * channels;
+    auto pixels = make_shared<vector<uint8_t>>(width * height * channels);
+
+    // Box [x_starts[x], x_ends[x]) of each column, at least a pixel wide
+    vector<size_t> x_starts(width), x_ends(width);
+    for (size_t x = 0; x < width; x++) {
+        x_starts[x] = x * image.width / width;
+        x_ends[x] = max(x_starts[x] + 1, (x + 1) * image.width / width);
+    }
+
+    vector<uint32_t> column_sums(row_samples);
+    for (size_t y = 0; y < height; y++) {
+        size_t y1 = y * image.height / height;
+        size_t y2 = max(y1 + 1, (y + 1) * image.height / height);
+
+        fill(column_sums.begin(), column_sums.end(), 0);
+        for (size_t source_y = y1; source_y < y2; source_y++) {
+            const uint8_t* row = image.row(source_y);
+            for (size_t i = 0; i < row_samples; i++) {
+                column_sums[i] += row[i];
+            }
+        }
+
+        uint8_t* out = pixels->data() + y * width * channels;
+        for (size_t x = 0; x < width; x++) {
+            uint32_t area = static_cast<uint32_t>((x_ends[x] - x_starts[x]) * (y2 - y1));
+            for (size_t c = 0; c < channels; c++) {
+                uint32_t sum = 0;
+                for (size_t source_x = x_starts[x]; source_x < x_ends[x]; source_x++) {
+                    sum += column_sums[source_x * channels + c];
+                }
+                out[x * channels + c] = static_cast<uint8_t>((sum + area / 2) / area);
+            }
+        }
+    }
+
+    return ByteImage(width, height, channels, pixels->data(), pixels);
+}
+
 // Create grayscale version of image. Note: Assumes original is at least RGB.
 Image make_grayscale(const Image& original) {
     if (original.channels < 3) {
@@ -0,0 +1,217 @@
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "../include/jpeg_header.hpp"
+
+using namespace std;
+
+// Bounds-checked reads from a TIFF block in either byte order
+class TiffReader {
+   public:
+    TiffReader(const uint8_t* data, size_t size) : data(data), size(size), big_endian(size >= 2 && data[0] == 'M') {}
+
+    bool valid() const { return size >= 8 && (memcmp(data, "II*\0", 4) == 0 || memcmp(data, "MM\0*", 4) == 0); }
+
+    uint32_t read16(size_t offset) const {
+        if (offset + 2 > size) return 0;
+        return big_endian ? (data[offset] << 8) | data[offset + 1] : data[offset] | (data[offset + 1] << 8);
+    }
+
+    uint32_t read32(size_t offset) const {
+        if (offset + 4 > size) return 0;
+        return big_endian ? (read16(offset) << 16) | read16(offset + 2) : read16(offset) | (read16(offset + 2) << 16);
+    }
+
+   private:
+    const uint8_t* data;
+    size_t size;
+    bool big_endian;
+};
+
+// Finds the orientation in IFD0 and the thumbnail in IFD1 of an EXIF block starting at `file_offset` in the file
+static void parse_exif(const uint8_t* tiff, size_t size, uint64_t file_offset, JpegHeader& header) {
+    TiffReader reader(tiff, size);
+    if (!reader.valid()) {
+        return;
+    }
+
+    // IFD0 describes the main image; the thumbnail's IFD1 follows it
+    size_t ifd0 = reader.read32(4);
+    size_t ifd0_entries = reader.read16(ifd0);
+    for (size_t i = 0; i < ifd0_entries; i++) {
+        size_t entry = ifd0 + 2 + 12 * i;
+        if (reader.read16(entry) == 0x0112) {
+            uint32_t orientation = reader.read16(entry + 8);
+            header.orientation = orientation >= 1 && orientation <= 8 ? static_cast<int>(orientation) : 1;
+        }
+    }
+
+    size_t ifd1 = reader.read32(ifd0 + 2 + 12 * ifd0_entries);
+    if (ifd1 == 0) {
+        return;
+    }
+
+    uint64_t offset = 0, length = 0;
+    size_t entries = reader.read16(ifd1);
+    for (size_t i = 0; i < entries; i++) {
+        size_t entry = ifd1 + 2 + 12 * i;
+        uint32_t tag = reader.read16(entry);
+        if (tag == 0x0201) {
+            offset = reader.read32(entry + 8);  // JPEGInterchangeFormat
+        } else if (tag == 0x0202) {
+            length = reader.read32(entry + 8);  // JPEGInterchangeFormatLength
+        }
+    }
+
+    if (offset > 0 && length > 0 && offset + length <= size) {
+        header.thumbnail_offset = file_offset + offset;
+        header.thumbnail_size = length;
+    }
+}
+
+// Start of frame markers, except DHT (C4), JPG (C8) and DAC (CC) which share the range
+static bool is_frame_marker(int marker) {
+    return marker >= 0xC0 && marker <= 0xCF && marker != 0xC4 && marker != 0xC8 && marker != 0xCC;
+}
+
+// Header bytes of a file on disk, read through stdio
+class FileHeaderReader {
+   public:
+    explicit FileHeaderReader(FILE* file) : file(file) {}
+
+    int get() { return fgetc(file); }
+    bool read(uint8_t* out, size_t size) { return fread(out, 1, size, file) == size; }
+    long tell() const { return ftell(file); }
+    bool seek(long offset) { return fseek(file, offset, SEEK_SET) == 0; }
+
+   private:
+    FILE* file;
+};
+
+// Header bytes of a file already in memory
+class MemoryHeaderReader {
+   public:
+    MemoryHeaderReader(const uint8_t* bytes, size_t size) : bytes(bytes), size(size), position(0) {}
+
+    int get() { return position < size ? bytes[position++] : EOF; }
+    bool read(uint8_t* out, size_t count) {
+        if (count > size - position) {
+            return false;
+        }
+        memcpy(out, bytes + position, count);
+        position += count;
+        return true;
+    }
+    long tell() const { return static_cast<long>(position); }
+    bool seek(long offset) {
+        if (offset < 0 || static_cast<size_t>(offset) > size) {
+            return false;
+        }
+        position = static_cast<size_t>(offset);
+        return true;
+    }
+
+   private:
+    const uint8_t* bytes;
+    size_t size;
+    size_t position;
+};
+
+template <typename Reader>
+static bool read_jpeg_header(Reader& file, JpegHeader& header) {
+    bool found_frame = false;
+    if (file.get() == 0xFF && file.get() == 0xD8) {
+        vector<uint8_t> segment;
+        while (true) {
+            // Markers may be padded with any number of 0xFF fill bytes
+            int c = file.get();
+            if (c != 0xFF) {
+                break;
+            }
+            int marker;
+            do {
+                marker = file.get();
+            } while (marker == 0xFF);
+
+            // Scan data or the end of the image: no more header segments
+            if (marker == EOF || marker == 0xDA || marker == 0xD9) {
+                break;
+            }
+            // Standalone markers carry no length
+            if (marker == 0x01 || (marker >= 0xD0 && marker <= 0xD7)) {
+                continue;
+            }
+
+            int high = file.get(), low = file.get();
+            if (high == EOF || low == EOF || ((high << 8) | low) < 2) {
+                break;
+            }
+            size_t length = static_cast<size_t>((high << 8) | low) - 2;
+            long payload = file.tell();
+
+            if (marker == 0xE1 || is_frame_marker(marker)) {
+                segment.resize(length);
+                if (!file.read(segment.data(), length)) {
+                    break;
+                }
+
+                if (marker == 0xE1 && length > 6 && memcmp(segment.data(), "Exif\0\0", 6) == 0) {
+                    parse_exif(segment.data() + 6, length - 6, static_cast<uint64_t>(payload) + 6, header);
+                } else if (is_frame_marker(marker) && length >= 6) {
+                    header.height = (segment[1] << 8) | segment[2];
+                    header.width = (segment[3] << 8) | segment[4];
+                    header.components = segment[5];
+                    found_frame = header.width > 0 && header.height > 0;
+                }
+            } else if (!file.seek(payload + static_cast<long>(length))) {
+                break;
+            }
+        }
+    }
+    return found_frame;
+}
+
+bool read_jpeg_header(const string& file_path, JpegHeader& header) {
+    FILE* file = fopen(file_path.c_str(), "rb");
+    if (!file) {
+        return false;
+    }
+
+    FileHeaderReader reader(file);
+    bool found_frame = read_jpeg_header(reader, header);
+    fclose(file);
+    return found_frame;
+}
+
+bool read_jpeg_header(const uint8_t* bytes, size_t size, JpegHeader& header) {
+    MemoryHeaderReader reader(bytes, size);
+    return read_jpeg_header(reader, header);
+}
+
+int read_jpeg_orientation(const string& file_path) {
+    JpegHeader header;
+    return read_jpeg_header(file_path, header) ? header.orientation : 1;
+}
+
+int read_jpeg_orientation(const uint8_t* bytes, size_t size) {
+    JpegHeader header;
+    return read_jpeg_header(bytes, size, header) ? header.orientation : 1;
+}
+
+ByteImage load_jpeg_thumbnail(const string& file_path, const JpegHeader& header) {
+    if (header.thumbnail_size == 0) {
+        return ByteImage();
+    }
+
+    FILE* file = fopen(file_path.c_str(), "rb");
+    if (!file) {
+        return ByteImage();
+    }
+
+    vector<uint8_t> bytes(header.thumbnail_size);
+    bool read = fseek(file, static_cast<long>(header.thumbnail_offset), SEEK_SET) == 0 && fread(bytes.data(), 1, bytes.size(), file) == bytes.size();
+    fclose(file);
+
+    return read ? load_byte_image_from_memory(bytes.data(), bytes.size()) : ByteImage();
+}
\ No newline at end of file
@@ -0,0 +1,834 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#include "../include/cells.hpp"
+#include "../include/charset.hpp"
+#include "../include/color.hpp"
+#include "../include/kernels.hpp"
+
+using namespace std;
+
+// SIMD variants are built with GCC vector extensions and per-function target attributes,
+// so a single binary carries every variant regardless of the -march it was compiled with
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define HAVE_X86_KERNELS 1
+#endif
+
+// ---------------------------------------------------------------------------
+// Scalar reference implementation
+
+static uint8_t get_brightness_level(double grayscale) {
+    const size_t n_levels = N_BRIGHTNESS_LEVELS;
+
+    grayscale = max(0.0, min(1.0, grayscale));  // Clamp to [0, 1]
+    size_t level = static_cast<size_t>(grayscale * n_levels);
+
+    // Clamp
+    if (level >= n_levels) {
+        level = n_levels - 1;
+    }
+
+    return static_cast<uint8_t>(level);
+}
+
+static void accumulate_row_scalar(double* sums, const double* row, size_t n) {
+    for (size_t k = 0; k < n; k++) {
+        sums[k] += row[k];
+    }
+}
+
+static void accumulate_row_u8_scalar(uint16_t* sums, const uint8_t* row, size_t n) {
+    for (size_t k = 0; k < n; k++) {
+        sums[k] += row[k];
+    }
+}
+
+static void flush_sums_scalar(uint32_t* sums, uint16_t* partial_sums, size_t n) {
+    for (size_t k = 0; k < n; k++) {
+        sums[k] += partial_sums[k];
+        partial_sums[k] = 0;
+    }
+}
+
+static void accumulate_row_linear_scalar(uint16_t* sums, const uint8_t* row, size_t n, const uint16_t* table) {
+    for (size_t k = 0; k < n; k++) {
+        sums[k] += table[row[k]];
+    }
+}
+
+// round(value * 255 / 65535) without a division
+static void narrow_row_u16be_scalar(uint8_t* out, const uint8_t* samples, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        uint32_t value = (samples[2 * i] << 8) | samples[2 * i + 1];
+        out[i] = static_cast<uint8_t>((value * 255 + 32895) >> 16);
+    }
+}
+
+static void match_glyphs_scalar(const uint64_t* masks, size_t n, const uint64_t* shapes, size_t n_glyphs, uint8_t* glyph_classes) {
+    for (size_t i = 0; i < n; i++) {
+        int best_distance = 129;
+        for (size_t g = 0; g < n_glyphs; g++) {
+            int distance = __builtin_popcountll(masks[2 * i] ^ shapes[g]) + __builtin_popcountll(masks[2 * i + 1] ^ shapes[n_glyphs + g]);
+            if (distance < best_distance) {
+                best_distance = distance;
+                glyph_classes[i] = static_cast<uint8_t>(g);
+            }
+        }
+    }
+}
+
+// round((color * alpha + background * (255 - alpha)) / 255) without a division
+template <size_t Channels>
+static void composite_row_u8_scalar(uint8_t* out, const uint8_t* row, size_t n, const uint8_t* background) {
+    for (size_t k = 0; k < n * Channels; k += Channels) {
+        uint32_t alpha = row[k + Channels - 1];
+        for (size_t c = 0; c + 1 < Channels; c++) {
+            uint32_t t = row[k + c] * alpha + background[c] * (255 - alpha) + 128;
+            out[k + c] = static_cast<uint8_t>((t + (t >> 8)) >> 8);
+        }
+        out[k + Channels - 1] = 255;
+    }
+}
+
+static void sobel_row_fixed_scalar(const int32_t* above, const int32_t* row, const int32_t* below, size_t n, int32_t* sx, int32_t* sy) {
+    for (size_t x = 0; x < n; x++) {
+        if (x == 0 || x + 1 >= n) {
+            sx[x] = 0;
+            sy[x] = 0;
+            continue;
+        }
+
+        sx[x] = (above[x + 1] - above[x - 1]) + 2 * (row[x + 1] - row[x - 1]) + (below[x + 1] - below[x - 1]);
+        sy[x] = (above[x - 1] + 2 * above[x] + above[x + 1]) - (below[x - 1] + 2 * below[x] + below[x + 1]);
+    }
+}
+
+template <size_t Channels>
+static void luma_row_scalar(const double* pixels, size_t n, double* luminance) {
+    for (size_t i = 0; i < n; i++) {
+        const double* pixel = &pixels[i * Channels];
+        if constexpr (Channels >= 3) {
+            luminance[i] = 0.2126 * pixel[0] + 0.7152 * pixel[1] + 0.0722 * pixel[2];
+        } else {
+            luminance[i] = pixel[0];
+        }
+    }
+}
+
+static void sobel_row_scalar(const double* above, const double* row, const double* below, size_t n, double* sx, double* sy) {
+    for (size_t x = 0; x < n; x++) {
+        sx[x] = 0.0;
+        sy[x] = 0.0;
+        if (x == 0 || x + 1 >= n) {
+            continue;
+        }
+
+        // Same accumulation order as calculate_convolution_value
+        sx[x] += -1. * above[x - 1];
+        sx[x] += 1. * above[x + 1];
+        sx[x] += -2. * row[x - 1];
+        sx[x] += 2. * row[x + 1];
+        sx[x] += -1. * below[x - 1];
+        sx[x] += 1. * below[x + 1];
+
+        sy[x] += 1. * above[x - 1];
+        sy[x] += 2. * above[x];
+        sy[x] += 1. * above[x + 1];
+        sy[x] += -1. * below[x - 1];
+        sy[x] += -2. * below[x];
+        sy[x] += -1. * below[x + 1];
+    }
+}
+
+template <size_t Channels, ColorMode Mode>
+static void shade_row_scalar(const double* pixels, size_t n, const uint8_t* glyph_levels, Cell* cells) {
+    for (size_t i = 0; i < n; i++) {
+        const double* pixel = &pixels[i * Channels];
+        double grayscale;
+        int r, g, b;
+
+        if constexpr (Channels <= 2) {
+            // Grayscale image
+            grayscale = pixel[0];
+            r = g = b = static_cast<int>(pixel[0] * 255);
+        } else {
+            // RGB image
+            HSV hsv = rgb_to_hsv(pixel[0], pixel[1], pixel[2]);
+
+            grayscale = calculate_grayscale_from_hsv(hsv);
+
+            // Set value to full brightness for both modes
+            // Character choice controls apparent brightness, not color value
+            hsv.value = 1.0;
+
+            if constexpr (Mode == COLOR_RETRO) {
+                // Retro mode: quantize hue to 60° and saturation to 0% or 100%
+                get_retro_rgb(hsv, r, g, b);
+            } else {
+                // Truecolor mode: convert HSV back to RGB with full brightness
+                double r_d, g_d, b_d;
+                hsv_to_rgb(hsv, r_d, g_d, b_d);
+                r = static_cast<int>(r_d * 255);
+                g = static_cast<int>(g_d * 255);
+                b = static_cast<int>(b_d * 255);
+            }
+        }
+
+        cells[i].glyph_class = glyph_levels[get_brightness_level(grayscale)];
+        cells[i].r = static_cast<uint8_t>(r);
+        cells[i].g = static_cast<uint8_t>(g);
+        cells[i].b = static_cast<uint8_t>(b);
+        cells[i].edge_dir = EDGE_NONE;
+    }
+}
+
+// Every (channel layout, color mode) instantiation of a row kernel template
+#define COMPOSITE_ROW_TABLE(kernel) {kernel<2>, kernel<4>}
+#define LUMA_ROW_TABLE(kernel) {kernel<1>, kernel<2>, kernel<3>, kernel<4>}
+#define SHADE_ROW_TABLE(kernel)                                                                                                                           \
+    {                                                                                                                                                     \
+        {kernel<1, COLOR_TRUECOLOR>, kernel<1, COLOR_RETRO>}, {kernel<2, COLOR_TRUECOLOR>, kernel<2, COLOR_RETRO>}, {kernel<3, COLOR_TRUECOLOR>, kernel<3, COLOR_RETRO>}, \
+            {kernel<4, COLOR_TRUECOLOR>, kernel<4, COLOR_RETRO>}                                                                                          \
+    }
+
+static const Kernels SCALAR_KERNELS = {ISA_SCALAR, "scalar", accumulate_row_scalar, sobel_row_scalar, accumulate_row_u8_scalar, flush_sums_scalar, accumulate_row_linear_scalar, narrow_row_u16be_scalar, match_glyphs_scalar, sobel_row_fixed_scalar,
+                                       COMPOSITE_ROW_TABLE(composite_row_u8_scalar), LUMA_ROW_TABLE(luma_row_scalar), SHADE_ROW_TABLE(shade_row_scalar)};
+
+// ---------------------------------------------------------------------------
+// SIMD variants. Every lane performs the same operations in the same order as
+// the scalar reference, so all variants produce bit-identical cells.
+
+#ifdef HAVE_X86_KERNELS
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpsabi"
+
+#define ALWAYS_INLINE inline __attribute__((always_inline))
+
+typedef double v2d __attribute__((vector_size(16)));
+typedef double v4d __attribute__((vector_size(32)));
+typedef double v8d __attribute__((vector_size(64)));
+typedef long long v2l __attribute__((vector_size(16)));
+typedef long long v4l __attribute__((vector_size(32)));
+typedef long long v8l __attribute__((vector_size(64)));
+
+typedef uint8_t v8u8 __attribute__((vector_size(8)));
+typedef uint8_t v16u8 __attribute__((vector_size(16)));
+typedef uint8_t v32u8 __attribute__((vector_size(32)));
+typedef uint16_t v4u16 __attribute__((vector_size(8)));
+typedef uint16_t v8u16 __attribute__((vector_size(16)));
+typedef uint16_t v16u16 __attribute__((vector_size(32)));
+typedef uint16_t v32u16 __attribute__((vector_size(64)));
+typedef int32_t v4i __attribute__((vector_size(16)));
+typedef int32_t v8i __attribute__((vector_size(32)));
+typedef int32_t v16i __attribute__((vector_size(64)));
+typedef uint32_t v4u32 __attribute__((vector_size(16)));
+typedef uint32_t v8u32 __attribute__((vector_size(32)));
+typedef uint32_t v16u32 __attribute__((vector_size(64)));
+typedef uint64_t v2u64 __attribute__((vector_size(16)));
+typedef uint64_t v4u64 __attribute__((vector_size(32)));
+typedef uint64_t v8u64 __attribute__((vector_size(64)));
+
+template <typename V>
+struct IntVector;
+template <>
+struct IntVector<v2d> {
+    typedef v2l type;
+};
+template <>
+struct IntVector<v4d> {
+    typedef v4l type;
+};
+template <>
+struct IntVector<v8d> {
+    typedef v8l type;
+};
+
+// Fixed-point vectors of the same register width as V. Bytes and Partial are narrower
+// vectors with the lane count of Sums and Columns respectively. Words hold glyph masks.
+template <typename V>
+struct FixedVector;
+template <>
+struct FixedVector<v2d> {
+    typedef v8u8 Bytes;
+    typedef v8u16 Sums;
+    typedef v4i Luma;
+    typedef v4u16 Partial;
+    typedef v4u32 Columns;
+    typedef v2u64 Words;
+};
+template <>
+struct FixedVector<v4d> {
+    typedef v16u8 Bytes;
+    typedef v16u16 Sums;
+    typedef v8i Luma;
+    typedef v8u16 Partial;
+    typedef v8u32 Columns;
+    typedef v4u64 Words;
+};
+template <>
+struct FixedVector<v8d> {
+    typedef v32u8 Bytes;
+    typedef v32u16 Sums;
+    typedef v16i Luma;
+    typedef v16u16 Partial;
+    typedef v16u32 Columns;
+    typedef v8u64 Words;
+};
+
+template <typename V, typename T>
+static ALWAYS_INLINE V load(const T* p) {
+    V v;
+    memcpy(&v, p, sizeof(V));
+    return v;
+}
+
+template <typename V, typename T>
+static ALWAYS_INLINE void store(T* p, const V& v) {
+    memcpy(p, &v, sizeof(V));
+}
+
+template <typename V>
+static ALWAYS_INLINE V gather(const double* p, size_t stride) {
+    V v;
+    for (size_t l = 0; l < sizeof(V) / sizeof(double); l++) {
+        v[l] = p[l * stride];
+    }
+    return v;
+}
+
+template <typename V>
+static ALWAYS_INLINE void accumulate_row_simd(double* sums, const double* row, size_t n) {
+    const size_t lanes = sizeof(V) / sizeof(double);
+    size_t k = 0;
+    for (; k + lanes <= n; k += lanes) {
+        store(sums + k, load<V>(sums + k) + load<V>(row + k));
+    }
+    accumulate_row_scalar(sums + k, row + k, n - k);
+}
+
+template <typename V, size_t Channels>
+static ALWAYS_INLINE void luma_row_simd(const double* pixels, size_t n, double* luminance) {
+    const size_t lanes = sizeof(V) / sizeof(double);
+    size_t i = 0;
+    if constexpr (Channels >= 3) {
+        for (; i + lanes <= n; i += lanes) {
+            const double* p = &pixels[i * Channels];
+            V red = gather<V>(p, Channels);
+            V green = gather<V>(p + 1, Channels);
+            V blue = gather<V>(p + 2, Channels);
+            store(luminance + i, 0.2126 * red + 0.7152 * green + 0.0722 * blue);
+        }
+    }
+    luma_row_scalar<Channels>(pixels + i * Channels, n - i, luminance + i);
+}
+
+template <typename V>
+static ALWAYS_INLINE void accumulate_row_u8_simd(uint16_t* sums, const uint8_t* row, size_t n) {
+    typedef typename FixedVector<V>::Bytes B;
+    typedef typename FixedVector<V>::Sums S;
+    const size_t lanes = sizeof(S) / sizeof(uint16_t);
+    size_t k = 0;
+    for (; k + lanes <= n; k += lanes) {
+        store(sums + k, load<S>(sums + k) + __builtin_convertvector(load<B>(row + k), S));
+    }
+    accumulate_row_u8_scalar(sums + k, row + k, n - k);
+}
+
+// Widens each pixel to 16 bits next to a copy of its own alpha, picked out with a byte shuffle
+template <typename V, size_t Channels>
+static ALWAYS_INLINE void composite_row_u8_simd(uint8_t* out, const uint8_t* row, size_t n, const uint8_t* background) {
+    typedef typename FixedVector<V>::Bytes B;
+    typedef typename FixedVector<V>::Sums S;
+    const size_t lanes = sizeof(B);
+
+    // Alpha lanes composite a zero background and are then forced opaque
+    B alpha_index, opaque;
+    S backdrop;
+    for (size_t l = 0; l < lanes; l++) {
+        bool is_alpha = l % Channels == Channels - 1;
+        alpha_index[l] = static_cast<uint8_t>(l - l % Channels + Channels - 1);
+        opaque[l] = is_alpha ? 255 : 0;
+        backdrop[l] = is_alpha ? 0 : background[l % Channels];
+    }
+
+    size_t k = 0;
+    for (; k + lanes <= n * Channels; k += lanes) {
+        B pixels = load<B>(row + k);
+        S color = __builtin_convertvector(pixels, S);
+        S alpha = __builtin_convertvector(__builtin_shuffle(pixels, alpha_index), S);
+        S t = color * alpha + backdrop * (255 - alpha) + 128;
+        store(out + k, __builtin_convertvector((t + (t >> 8)) >> 8, B) | opaque);
+    }
+    composite_row_u8_scalar<Channels>(out + k, row + k, n - k / Channels, background);
+}
+
+template <typename V>
+static ALWAYS_INLINE void flush_sums_simd(uint32_t* sums, uint16_t* partial_sums, size_t n) {
+    typedef typename FixedVector<V>::Partial P;
+    typedef typename FixedVector<V>::Columns C;
+    const size_t lanes = sizeof(C) / sizeof(uint32_t);
+    size_t k = 0;
+    for (; k + lanes <= n; k += lanes) {
+        store(sums + k, load<C>(sums + k) + __builtin_convertvector(load<P>(partial_sums + k), C));
+        store(partial_sums + k, P{});
+    }
+    flush_sums_scalar(sums + k, partial_sums + k, n - k);
+}
+
+// Byte-swaps the samples, then rounds them as (w - (w >> 8)) >> 8 with w = value + 128,
+// which stays in 16-bit lanes. Values whose w wraps around all round to 255.
+template <typename V>
+static ALWAYS_INLINE void narrow_row_u16be_simd(uint8_t* out, const uint8_t* samples, size_t n) {
+    typedef typename FixedVector<V>::Bytes B;
+    typedef typename FixedVector<V>::Sums S;
+    const size_t lanes = sizeof(B);
+    size_t i = 0;
+    for (; i + lanes <= n; i += lanes) {
+        S raw = load<S>(samples + 2 * i);
+        S value = (raw << 8) | (raw >> 8);
+        S w = value + 128;
+        S rounded = ((w - (w >> 8)) >> 8) | (S)(w < value);
+        store(out + i, __builtin_convertvector(rounded, B));
+    }
+    narrow_row_u16be_scalar(out + i, samples + 2 * i, n - i);
+}
+
+// Replaces each 64-bit lane by the number of bits set in it. Without AVX-512 VPOPCNTDQ no instruction
+// counts the bits of a whole vector, so they are counted in 2-, 4- and 8-bit fields and folded together.
+template <typename W, bool Native>
+static ALWAYS_INLINE void popcount_lanes(W& x) {
+    if constexpr (Native) {
+        for (size_t l = 0; l < sizeof(W) / sizeof(uint64_t); l++) {
+            x[l] = __builtin_popcountll(x[l]);
+        }
+    } else {
+        x = x - ((x >> 1) & 0x5555555555555555ull);
+        x = (x & 0x3333333333333333ull) + ((x >> 2) & 0x3333333333333333ull);
+        x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0Full;
+        x = x + (x >> 8);
+        x = x + (x >> 16);
+        x = (x + (x >> 32)) & 0xFF;
+    }
+}
+
+// Distances to one glyph per lane; each lane keeps the first glyph of its smallest distance,
+// then the lanes are reduced in glyph order so ties still go to the first glyph
+template <typename W, bool NativePopcount>
+static ALWAYS_INLINE void match_glyphs_simd(const uint64_t* masks, size_t n, const uint64_t* shapes, size_t n_glyphs, uint8_t* glyph_classes) {
+    const size_t lanes = sizeof(W) / sizeof(uint64_t);
+    W lane_index;
+    for (size_t l = 0; l < lanes; l++) {
+        lane_index[l] = l;
+    }
+
+    for (size_t i = 0; i < n; i++) {
+        W best_distance = W{} + 129;
+        W best_glyph = W{};
+        size_t g = 0;
+        for (; g + lanes <= n_glyphs; g += lanes) {
+            W first = masks[2 * i] ^ load<W>(shapes + g);
+            W second = masks[2 * i + 1] ^ load<W>(shapes + n_glyphs + g);
+            popcount_lanes<W, NativePopcount>(first);
+            popcount_lanes<W, NativePopcount>(second);
+            W distance = first + second;
+            W closer = distance < best_distance;
+            best_distance = closer ? distance : best_distance;
+            best_glyph = closer ? lane_index + g : best_glyph;
+        }
+
+        uint64_t distance = 129, glyph = 0;
+        for (size_t l = 0; l < lanes; l++) {
+            if (best_distance[l] < distance || (best_distance[l] == distance && best_glyph[l] < glyph)) {
+                distance = best_distance[l];
+                glyph = best_glyph[l];
+            }
+        }
+        for (; g < n_glyphs; g++) {
+            uint64_t tail = __builtin_popcountll(masks[2 * i] ^ shapes[g]) + __builtin_popcountll(masks[2 * i + 1] ^ shapes[n_glyphs + g]);
+            if (tail < distance) {
+                distance = tail;
+                glyph = g;
+            }
+        }
+        glyph_classes[i] = static_cast<uint8_t>(glyph);
+    }
+}
+
+// Rows are streamed from memory once; reading ahead lets the lookups overlap the loads
+constexpr size_t LINEAR_PREFETCH_BYTES = 2048;
+
+// Looks the table up in registers. Only 512-bit registers hold it in few enough of them
+// for this to beat scalar lookups: two-register word shuffles then cover a quarter each.
+template <typename V>
+static ALWAYS_INLINE void accumulate_row_linear_simd(uint16_t* sums, const uint8_t* row, size_t n, const uint16_t* table) {
+    typedef typename FixedVector<V>::Bytes B;
+    typedef typename FixedVector<V>::Sums S;
+    const size_t lanes = sizeof(S) / sizeof(uint16_t);
+    size_t k = 0;
+
+    if constexpr (lanes * 8 == 256) {
+        S parts[8];
+        for (size_t p = 0; p < 8; p++) {
+            parts[p] = load<S>(table + p * lanes);
+        }
+
+        for (; k + lanes <= n; k += lanes) {
+            __builtin_prefetch(row + k + LINEAR_PREFETCH_BYTES);
+            S index = __builtin_convertvector(load<B>(row + k), S);
+            S low = (index & 64) ? __builtin_shuffle(parts[2], parts[3], index) : __builtin_shuffle(parts[0], parts[1], index);
+            S high = (index & 64) ? __builtin_shuffle(parts[6], parts[7], index) : __builtin_shuffle(parts[4], parts[5], index);
+            store(sums + k, load<S>(sums + k) + ((index & 128) ? high : low));
+        }
+    }
+    accumulate_row_linear_scalar(sums + k, row + k, n - k, table);
+}
+
+typedef uint8_t v64u8 __attribute__((vector_size(64)));
+
+// AVX-512 VBMI shuffles bytes across the whole register, so the table is split into its
+// low and high bytes, each looked up 128 entries at a time, then interleaved back into words
+__attribute__((target("avx512f,avx512bw,avx512vbmi"))) static void accumulate_row_linear_avx512vbmi(uint16_t* sums, const uint8_t* row, size_t n, const uint16_t* table) {
+    v64u8 even_bytes, interleave_first, interleave_second;
+    for (size_t l = 0; l < 64; l++) {
+        even_bytes[l] = static_cast<uint8_t>(2 * l);
+        interleave_first[l] = static_cast<uint8_t>(l / 2 + (l % 2) * 64);
+        interleave_second[l] = static_cast<uint8_t>(32 + l / 2 + (l % 2) * 64);
+    }
+
+    v64u8 low_bytes[4], high_bytes[4];
+    for (size_t p = 0; p < 4; p++) {
+        v64u8 first = load<v64u8>(table + p * 64);
+        v64u8 second = load<v64u8>(table + p * 64 + 32);
+        low_bytes[p] = __builtin_shuffle(first, second, even_bytes);
+        high_bytes[p] = __builtin_shuffle(first, second, even_bytes + 1);
+    }
+
+    size_t k = 0;
+    for (; k + 64 <= n; k += 64) {
+        __builtin_prefetch(row + k + LINEAR_PREFETCH_BYTES);
+        v64u8 index = load<v64u8>(row + k);
+        v64u8 low = (index & 128) ? __builtin_shuffle(low_bytes[2], low_bytes[3], index) : __builtin_shuffle(low_bytes[0], low_bytes[1], index);
+        v64u8 high = (index & 128) ? __builtin_shuffle(high_bytes[2], high_bytes[3], index) : __builtin_shuffle(high_bytes[0], high_bytes[1], index);
+        store(sums + k, load<v32u16>(sums + k) + reinterpret_cast<v32u16>(__builtin_shuffle(low, high, interleave_first)));
+        store(sums + k + 32, load<v32u16>(sums + k + 32) + reinterpret_cast<v32u16>(__builtin_shuffle(low, high, interleave_second)));
+    }
+    accumulate_row_linear_scalar(sums + k, row + k, n - k, table);
+}
+
+// AVX-512 VPOPCNTDQ counts the bits of every 64-bit lane in one instruction
+__attribute__((target("avx512f,avx512bw,avx512vpopcntdq"))) static void match_glyphs_avx512vpopcntdq(const uint64_t* masks, size_t n, const uint64_t* shapes, size_t n_glyphs,
+                                                                                                    uint8_t* glyph_classes) {
+    match_glyphs_simd<v8u64, true>(masks, n, shapes, n_glyphs, glyph_classes);
+}
+
+template <typename V>
+static ALWAYS_INLINE void sobel_row_fixed_simd(const int32_t* above, const int32_t* row, const int32_t* below, size_t n, int32_t* sx, int32_t* sy) {
+    typedef typename FixedVector<V>::Luma L;
+    const size_t lanes = sizeof(L) / sizeof(int32_t);
+    if (n < lanes + 2) {
+        sobel_row_fixed_scalar(above, row, below, n, sx, sy);
+        return;
+    }
+
+    sx[0] = sy[0] = 0;
+    size_t x = 1;
+    for (; x + lanes < n; x += lanes) {
+        L a0 = load<L>(above + x - 1), a1 = load<L>(above + x), a2 = load<L>(above + x + 1);
+        L r0 = load<L>(row + x - 1), r2 = load<L>(row + x + 1);
+        L b0 = load<L>(below + x - 1), b1 = load<L>(below + x), b2 = load<L>(below + x + 1);
+        store(sx + x, (a2 - a0) + 2 * (r2 - r0) + (b2 - b0));
+        store(sy + x, (a0 + 2 * a1 + a2) - (b0 + 2 * b1 + b2));
+    }
+
+    // Remaining columns (including the right border) with a window starting one column back,
+    // whose first column the window treats as a border and must be restored
+    size_t start = x - 1;
+    int32_t first_x = sx[start], first_y = sy[start];
+    sobel_row_fixed_scalar(above + start, row + start, below + start, n - start, sx + start, sy + start);
+    sx[start] = first_x;
+    sy[start] = first_y;
+}
+
+template <typename V>
+static ALWAYS_INLINE void sobel_row_simd(const double* above, const double* row, const double* below, size_t n, double* sx, double* sy) {
+    const size_t lanes = sizeof(V) / sizeof(double);
+    if (n < lanes + 2) {
+        sobel_row_scalar(above, row, below, n, sx, sy);
+        return;
+    }
+
+    sx[0] = sy[0] = 0.0;
+    size_t x = 1;
+    for (; x + lanes < n; x += lanes) {
+        V gx = V{}, gy = V{};
+        gx += -1. * load<V>(above + x - 1);
+        gx += 1. * load<V>(above + x + 1);
+        gx += -2. * load<V>(row + x - 1);
+        gx += 2. * load<V>(row + x + 1);
+        gx += -1. * load<V>(below + x - 1);
+        gx += 1. * load<V>(below + x + 1);
+
+        gy += 1. * load<V>(above + x - 1);
+        gy += 2. * load<V>(above + x);
+        gy += 1. * load<V>(above + x + 1);
+        gy += -1. * load<V>(below + x - 1);
+        gy += -2. * load<V>(below + x);
+        gy += -1. * load<V>(below + x + 1);
+
+        store(sx + x, gx);
+        store(sy + x, gy);
+    }
+
+    // Remaining columns (including the right border) with a window starting one column back
+    size_t start = x - 1;
+    double tail_x[sizeof(V) / sizeof(double) + 1], tail_y[sizeof(V) / sizeof(double) + 1];
+    sobel_row_scalar(above + start, row + start, below + start, n - start, tail_x, tail_y);
+    for (size_t k = 1; k < n - start; k++) {
+        sx[start + k] = tail_x[k];
+        sy[start + k] = tail_y[k];
+    }
+}
+
+// Branch-free hsv_to_rgb with value fixed at 1.0, as used by both color modes
+template <typename V>
+static ALWAYS_INLINE void full_value_hsv_to_rgb(const V& hue, const V& saturation, V& r, V& g, V& b) {
+    const V zero = V{};
+
+    V c = 1.0 * saturation;
+    V h_prime = hue / 60.0;
+
+    // fmod(h_prime, 2.0) for h_prime in [0, 6]; each subtraction is exact
+    V h_mod = h_prime >= 6.0 ? h_prime - 6.0 : (h_prime >= 4.0 ? h_prime - 4.0 : (h_prime >= 2.0 ? h_prime - 2.0 : h_prime));
+    V t = h_mod - 1.0;
+    V x = c * (1.0 - (t < 0.0 ? -t : t));
+
+    V r1 = h_prime < 1.0 ? c : (h_prime < 2.0 ? x : (h_prime < 4.0 ? zero : (h_prime < 5.0 ? x : c)));
+    V g1 = h_prime < 1.0 ? x : (h_prime < 3.0 ? c : (h_prime < 4.0 ? x : zero));
+    V b1 = h_prime < 2.0 ? zero : (h_prime < 3.0 ? x : (h_prime < 5.0 ? c : x));
+
+    V m = 1.0 - c;
+    r = r1 + m;
+    g = g1 + m;
+    b = b1 + m;
+}
+
+template <typename V, size_t Channels, ColorMode Mode>
+static ALWAYS_INLINE void shade_lanes(const V& red, const V& green, const V& blue, const uint8_t* glyph_levels, Cell* cells) {
+    typedef typename IntVector<V>::type I;
+    const size_t lanes = sizeof(V) / sizeof(double);
+    const V zero = V{};
+
+    V grayscale, r, g, b;
+    if constexpr (Channels <= 2) {
+        grayscale = red;
+        r = g = b = red;
+    } else {
+        // rgb_to_hsv
+        V max_val = red > green ? red : green;
+        max_val = max_val > blue ? max_val : blue;
+        V min_val = red < green ? red : green;
+        min_val = min_val < blue ? min_val : blue;
+
+        V chroma = max_val - min_val;
+        V saturation = (max_val < 1e-4 && max_val > -1e-4) ? zero : chroma / max_val;
+
+        // fmod((green - blue) / chroma, 6.0) is the identity here since the ratio is in [-1, 1]
+        V hue_red = 60.0 * ((green - blue) / chroma);
+        hue_red = hue_red < 0.0 ? hue_red + 360.0 : hue_red;
+        V hue_green = 60.0 * (2.0 + (blue - red) / chroma);
+        V hue_blue = 60.0 * (4.0 + (red - green) / chroma);
+        V hue = chroma < 1e-4 ? zero : (max_val == red ? hue_red : (max_val == green ? hue_green : hue_blue));
+
+        grayscale = max_val * max_val;
+
+        if constexpr (Mode == COLOR_RETRO) {
+            // Round half away from zero to the nearest multiple of 60 degrees; 360 wraps to 0
+            V q = hue / 60.0;
+            V k = q >= 5.5 ? zero : (q >= 4.5 ? zero + 5.0 : (q >= 3.5 ? zero + 4.0 : (q >= 2.5 ? zero + 3.0 : (q >= 1.5 ? zero + 2.0 : (q >= 0.5 ? zero + 1.0 : zero)))));
+            V quantized_saturation = saturation < 0.25 ? zero : zero + 1.0;
+            full_value_hsv_to_rgb(k * 60.0, quantized_saturation, r, g, b);
+        } else {
+            full_value_hsv_to_rgb(hue, saturation, r, g, b);
+        }
+    }
+
+    // get_brightness_level
+    const double n_levels = static_cast<double>(N_BRIGHTNESS_LEVELS);
+    grayscale = grayscale < 1.0 ? grayscale : zero + 1.0;
+    grayscale = 0.0 < grayscale ? grayscale : zero;
+    I level = __builtin_convertvector(grayscale * n_levels, I);
+
+    I ri = __builtin_convertvector(r * 255.0, I);
+    I gi = __builtin_convertvector(g * 255.0, I);
+    I bi = __builtin_convertvector(b * 255.0, I);
+
+    for (size_t l = 0; l < lanes; l++) {
+        long long clamped = level[l] >= static_cast<long long>(n_levels) ? static_cast<long long>(n_levels) - 1 : level[l];
+        cells[l].glyph_class = glyph_levels[clamped];
+        cells[l].r = static_cast<uint8_t>(ri[l]);
+        cells[l].g = static_cast<uint8_t>(gi[l]);
+        cells[l].b = static_cast<uint8_t>(bi[l]);
+        cells[l].edge_dir = EDGE_NONE;
+    }
+}
+
+template <typename V, size_t Channels, ColorMode Mode>
+static ALWAYS_INLINE void shade_row_simd(const double* pixels, size_t n, const uint8_t* glyph_levels, Cell* cells) {
+    const size_t lanes = sizeof(V) / sizeof(double);
+    size_t i = 0;
+    for (; i + lanes <= n; i += lanes) {
+        const double* p = &pixels[i * Channels];
+        V red = gather<V>(p, Channels);
+        V green = Channels >= 3 ? gather<V>(p + 1, Channels) : red;
+        V blue = Channels >= 3 ? gather<V>(p + 2, Channels) : red;
+        shade_lanes<V, Channels, Mode>(red, green, blue, glyph_levels, cells + i);
+    }
+    shade_row_scalar<Channels, Mode>(pixels + i * Channels, n - i, glyph_levels, cells + i);
+}
+
+#define DEFINE_SIMD_KERNELS(suffix, V, target_isa)                                                                                                     \
+    __attribute__((target(target_isa))) static void accumulate_row_##suffix(double* sums, const double* row, size_t n) {                              \
+        accumulate_row_simd<V>(sums, row, n);                                                                                                          \
+    }                                                                                                                                                  \
+    __attribute__((target(target_isa))) static void accumulate_row_u8_##suffix(uint16_t* sums, const uint8_t* row, size_t n) {                        \
+        accumulate_row_u8_simd<V>(sums, row, n);                                                                                                       \
+    }                                                                                                                                                  \
+    __attribute__((target(target_isa))) static void flush_sums_##suffix(uint32_t* sums, uint16_t* partial_sums, size_t n) {                            \
+        flush_sums_simd<V>(sums, partial_sums, n);                                                                                                     \
+    }                                                                                                                                                  \
+    __attribute__((target(target_isa))) static void accumulate_row_linear_##suffix(uint16_t* sums, const uint8_t* row, size_t n, const uint16_t* table) { \
+        accumulate_row_linear_simd<V>(sums, row, n, table);                                                                                            \
+    }                                                                                                                                                  \
+    __attribute__((target(target_isa))) static void narrow_row_u16be_##suffix(uint8_t* out, const uint8_t* samples, size_t n) {                       \
+        narrow_row_u16be_simd<V>(out, samples, n);                                                                                                     \
+    }                                                                                                                                                  \
+    __attribute__((target(target_isa))) static void match_glyphs_##suffix(const uint64_t* masks, size_t n, const uint64_t* shapes, size_t n_glyphs,   \
+                                                                          uint8_t* glyph_classes) {                                                    \
+        typedef typename FixedVector<V>::Words W;                                                                                                      \
+        match_glyphs_simd<W, false>(masks, n, shapes, n_glyphs, glyph_classes);                                                                        \
+    }                                                                                                                                                  \
+    __attribute__((target(target_isa))) static void sobel_row_fixed_##suffix(const int32_t* above, const int32_t* row, const int32_t* below, size_t n, \
+                                                                               int32_t* sx, int32_t* sy) {                                            \
+        sobel_row_fixed_simd<V>(above, row, below, n, sx, sy);                                                                                         \
+    }                                                                                                                                                  \
+    template <size_t Channels>                                                                                                                         \
+    __attribute__((target(target_isa))) static void composite_row_u8_##suffix(uint8_t* out, const uint8_t* row, size_t n, const uint8_t* background) { \
+        composite_row_u8_simd<V, Channels>(out, row, n, background);                                                                                   \
+    }                                                                                                                                                  \
+    __attribute__((target(target_isa))) static void sobel_row_##suffix(const double* above, const double* row, const double* below, size_t n,         \
+                                                                         double* sx, double* sy) {                                                    \
+        sobel_row_simd<V>(above, row, below, n, sx, sy);                                                                                               \
+    }                                                                                                                                                  \
+    template <size_t Channels>                                                                                                                         \
+    __attribute__((target(target_isa))) static void luma_row_##suffix(const double* pixels, size_t n, double* luminance) {                            \
+        luma_row_simd<V, Channels>(pixels, n, luminance);                                                                                              \
+    }                                                                                                                                                  \
+    template <size_t Channels, ColorMode Mode>                                                                                                         \
+    __attribute__((target(target_isa))) static void shade_row_##suffix(const double* pixels, size_t n, const uint8_t* glyph_levels, Cell* cells) {    \
+        shade_row_simd<V, Channels, Mode>(pixels, n, glyph_levels, cells);                                                                             \
+    }
+
+DEFINE_SIMD_KERNELS(sse2, v2d, "sse2")
+DEFINE_SIMD_KERNELS(avx2, v4d, "avx2")
+DEFINE_SIMD_KERNELS(avx512, v8d, "avx512f,avx512bw")
+
+#pragma GCC diagnostic pop
+
+static const Kernels SSE2_KERNELS = {ISA_SSE2, "sse2", accumulate_row_sse2, sobel_row_sse2, accumulate_row_u8_sse2, flush_sums_sse2, accumulate_row_linear_sse2, narrow_row_u16be_sse2, match_glyphs_sse2, sobel_row_fixed_sse2,
+                                     COMPOSITE_ROW_TABLE(composite_row_u8_sse2), LUMA_ROW_TABLE(luma_row_sse2), SHADE_ROW_TABLE(shade_row_sse2)};
+static const Kernels AVX2_KERNELS = {ISA_AVX2, "avx2", accumulate_row_avx2, sobel_row_avx2, accumulate_row_u8_avx2, flush_sums_avx2, accumulate_row_linear_avx2, narrow_row_u16be_avx2, match_glyphs_avx2, sobel_row_fixed_avx2,
+                                     COMPOSITE_ROW_TABLE(composite_row_u8_avx2), LUMA_ROW_TABLE(luma_row_avx2), SHADE_ROW_TABLE(shade_row_avx2)};
+static const Kernels AVX512_KERNELS = {ISA_AVX512, "avx512", accumulate_row_avx512, sobel_row_avx512, accumulate_row_u8_avx512, flush_sums_avx512, accumulate_row_linear_avx512, narrow_row_u16be_avx512, match_glyphs_avx512, sobel_row_fixed_avx512,
+                                     COMPOSITE_ROW_TABLE(composite_row_u8_avx512), LUMA_ROW_TABLE(luma_row_avx512), SHADE_ROW_TABLE(shade_row_avx512)};
+
+#endif  // HAVE_X86_KERNELS
+
+// ---------------------------------------------------------------------------
+// Runtime dispatch
+
+bool is_isa_supported(Isa isa) {
+#ifdef HAVE_X86_KERNELS
+    __builtin_cpu_init();
+    switch (isa) {
+        case ISA_AUTO:
+        case ISA_SCALAR:
+            return true;
+        case ISA_SSE2:
+            return __builtin_cpu_supports("sse2");
+        case ISA_AVX2:
+            return __builtin_cpu_supports("avx2");
+        case ISA_AVX512:
+            return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw");
+    }
+    return false;
+#else
+    return isa == ISA_AUTO || isa == ISA_SCALAR;
+#endif
+}
+
+Isa detect_isa() {
+    static const Isa detected = is_isa_supported(ISA_AVX512) ? ISA_AVX512 : is_isa_supported(ISA_AVX2) ? ISA_AVX2 : is_isa_supported(ISA_SSE2) ? ISA_SSE2 : ISA_SCALAR;
+    return detected;
+}
+
+const Kernels& get_kernels(Isa isa) {
+    if (isa == ISA_AUTO || !is_isa_supported(isa)) {
+        isa = detect_isa();
+    }
+
+    switch (isa) {
+#ifdef HAVE_X86_KERNELS
+        case ISA_SSE2:
+            return SSE2_KERNELS;
+        case ISA_AVX2:
+            return AVX2_KERNELS;
+        case ISA_AVX512: {
+            // VBMI adds whole-register byte shuffles, which make linear light lookups cheaper,
+            // and VPOPCNTDQ counts bits per lane, which makes shape matching cheaper
+            static const Kernels extended_kernels = [] {
+                Kernels kernels = AVX512_KERNELS;
+                if (__builtin_cpu_supports("avx512vbmi")) {
+                    kernels.accumulate_row_linear = accumulate_row_linear_avx512vbmi;
+                }
+                if (__builtin_cpu_supports("avx512vpopcntdq")) {
+                    kernels.match_glyphs = match_glyphs_avx512vpopcntdq;
+                }
+                return kernels;
+            }();
+            return extended_kernels;
+        }
+#endif
+        default:
+            return SCALAR_KERNELS;
+    }
+}
+
+const char* get_isa_name(Isa isa) {
+    switch (isa) {
+        case ISA_AUTO:
+            return "auto";
+        case ISA_SCALAR:
+            return "scalar";
+        case ISA_SSE2:
+            return "sse2";
+        case ISA_AVX2:
+            return "avx2";
+        case ISA_AVX512:
+            return "avx512";
+    }
+    return "unknown";
+}
+
+bool parse_isa(const string& name, Isa& isa) {
+    for (Isa candidate : {ISA_AUTO, ISA_SCALAR, ISA_SSE2, ISA_AVX2, ISA_AVX512}) {
+        if (name == get_isa_name(candidate)) {
+            isa = candidate;
+            return true;
+        }
+    }
+    return false;
+}
\ No newline at end of file
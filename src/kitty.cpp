@@ -0,0 +1,219 @@
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+#ifdef _WIN32
+#include <process.h>
+#else
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <termios.h>
+#include <unistd.h>
+#endif
+
+#include "../include/argparse.hpp"
+#include "../include/kitty.hpp"
+
+using namespace std;
+
+// Base64 bytes per escape in direct transfer, the protocol's limit, and the pixel bytes they hold
+constexpr size_t KITTY_CHUNK = 4096;
+constexpr size_t KITTY_CHUNK_BYTES = KITTY_CHUNK / 4 * 3;
+
+// Longest wait for the terminal to answer the shared memory query, in milliseconds
+constexpr int KITTY_QUERY_TIMEOUT = 200;
+
+static const char BASE64_DIGITS[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+// Appends `n` bytes as base64, whole groups of three bytes at a time
+static void append_base64(string& out, const uint8_t* data, size_t n) {
+    size_t start = out.size();
+    out.resize(start + (n + 2) / 3 * 4);
+    char* digits = &out[start];
+    size_t i = 0;
+    for (; i + 3 <= n; i += 3, digits += 4) {
+        uint32_t group = (uint32_t(data[i]) << 16) | (uint32_t(data[i + 1]) << 8) | data[i + 2];
+        digits[0] = BASE64_DIGITS[group >> 18];
+        digits[1] = BASE64_DIGITS[(group >> 12) & 63];
+        digits[2] = BASE64_DIGITS[(group >> 6) & 63];
+        digits[3] = BASE64_DIGITS[group & 63];
+    }
+    if (i < n) {
+        uint32_t group = (uint32_t(data[i]) << 16) | (i + 1 < n ? uint32_t(data[i + 1]) << 8 : 0);
+        digits[0] = BASE64_DIGITS[group >> 18];
+        digits[1] = BASE64_DIGITS[(group >> 12) & 63];
+        digits[2] = i + 1 < n ? BASE64_DIGITS[(group >> 6) & 63] : '=';
+        digits[3] = '=';
+    }
+}
+
+// RGBA of an image of 1 to 4 channels: gray is repeated, missing alpha is opaque
+static void copy_rgba(const ByteImage& image, uint8_t* out) {
+    size_t n = image.width * image.height;
+    const uint8_t* in = image.data;
+    switch (image.channels) {
+        case 1:
+            for (size_t i = 0; i < n; i++, out += 4) {
+                out[0] = out[1] = out[2] = in[i];
+                out[3] = 255;
+            }
+            break;
+        case 2:
+            for (size_t i = 0; i < n; i++, out += 4) {
+                out[0] = out[1] = out[2] = in[i * 2];
+                out[3] = in[i * 2 + 1];
+            }
+            break;
+        case 3:
+            for (size_t i = 0; i < n; i++, out += 4) {
+                memcpy(out, in + i * 3, 3);
+                out[3] = 255;
+            }
+            break;
+        default:
+            memcpy(out, in, n * 4);
+            break;
+    }
+}
+
+static uint32_t get_process_id() {
+#ifdef _WIN32
+    return static_cast<uint32_t>(_getpid());
+#else
+    return static_cast<uint32_t>(getpid());
+#endif
+}
+
+uint32_t get_kitty_image_id() {
+    // Ids fit 32 bits and must not be zero
+    return (get_process_id() & 0x3fffffff) | 0x40000000;
+}
+
+// Writes the RGBA pixels to a new shared memory object, which the terminal unlinks
+// once it has read it. Returns false, leaving nothing behind, if that fails.
+static bool write_shared_memory(const ByteImage& image, const string& name) {
+#ifdef _WIN32
+    (void)image;
+    (void)name;
+    return false;
+#else
+    size_t size = image.width * image.height * 4;
+    int descriptor = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (descriptor < 0) {
+        return false;
+    }
+    void* memory = MAP_FAILED;
+    if (ftruncate(descriptor, static_cast<off_t>(size)) == 0) {
+        memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, descriptor, 0);
+    }
+    close(descriptor);
+    if (memory == MAP_FAILED) {
+        shm_unlink(name.c_str());
+        return false;
+    }
+    copy_rgba(image, static_cast<uint8_t*>(memory));
+    munmap(memory, size);
+    return true;
+#endif
+}
+
+// Asks the terminal to load a 1x1 frame from shared memory without showing it, followed by a
+// device attributes request that every terminal answers. A terminal that took the frame answers
+// the query with OK before that; any other leaves the object behind, so it is unlinked here.
+static bool query_shared_memory() {
+#ifdef _WIN32
+    return false;
+#else
+    int tty = open("/dev/tty", O_RDWR | O_NOCTTY);
+    if (tty < 0) {
+        return false;
+    }
+    termios saved;
+    if (tcgetattr(tty, &saved) != 0) {
+        close(tty);
+        return false;
+    }
+    termios raw = saved;
+    raw.c_lflag &= ~(ICANON | ECHO);
+    raw.c_cc[VMIN] = 0;
+    raw.c_cc[VTIME] = 0;
+    tcsetattr(tty, TCSANOW, &raw);
+
+    string name = "/ascii-art-" + to_string(get_process_id()) + "-query";
+    uint8_t pixel[4] = {0, 0, 0, 0};
+    string answer;
+    if (write_shared_memory(ByteImage(1, 1, 4, pixel, nullptr), name)) {
+        string query = "\x1b_Ga=q,i=1,s=1,v=1,f=32,t=s,S=4;";
+        append_base64(query, reinterpret_cast<const uint8_t*>(name.data()), name.size());
+        query += "\x1b\\\x1b[c";
+        if (write(tty, query.data(), query.size()) == static_cast<ssize_t>(query.size())) {
+            // Read until the device attributes, "\x1b[?...c", or the timeout
+            pollfd readable = {tty, POLLIN, 0};
+            while (answer.find("\x1b[?") == string::npos || answer.back() != 'c') {
+                char bytes[256];
+                ssize_t n = poll(&readable, 1, KITTY_QUERY_TIMEOUT) > 0 ? read(tty, bytes, sizeof(bytes)) : 0;
+                if (n <= 0) {
+                    break;
+                }
+                answer.append(bytes, static_cast<size_t>(n));
+            }
+        }
+        shm_unlink(name.c_str());
+    }
+
+    tcsetattr(tty, TCSANOW, &saved);
+    close(tty);
+    return answer.find("\x1b_Gi=1;OK") != string::npos;
+#endif
+}
+
+KittyTransfer get_kitty_transfer() {
+    // Asked once: the answer holds for the whole run
+    static const KittyTransfer transfer = [] {
+        if (!is_output_terminal() || getenv("SSH_CONNECTION") || getenv("SSH_TTY")) {
+            return KITTY_DIRECT;
+        }
+        return query_shared_memory() ? KITTY_SHARED_MEMORY : KITTY_DIRECT;
+    }();
+    return transfer;
+}
+
+string KittyImage::encode_frame(const ByteImage& image, size_t columns, size_t rows) {
+    // Transmit and display, 32-bit RGBA, scaled to the cells, cursor left in place, no replies
+    if (image.empty() || image.channels < 1 || image.channels > 4) {
+        throw invalid_argument("Kitty images must have 1 to 4 channels");
+    }
+
+    string keys = "a=T,f=32,s=" + to_string(image.width) + ",v=" + to_string(image.height) + ",c=" + to_string(columns) + ",r=" + to_string(rows) +
+                  ",i=" + to_string(id) + ",p=1,C=1,q=2";
+    frames++;
+
+    string out;
+    if (transfer == KITTY_SHARED_MEMORY) {
+        string name = "/ascii-art-" + to_string(get_process_id()) + "-" + to_string(frames);
+        if (write_shared_memory(image, name)) {
+            out = "\x1b_G" + keys + ",t=s,S=" + to_string(image.width * image.height * 4) + ";";
+            append_base64(out, reinterpret_cast<const uint8_t*>(name.data()), name.size());
+            out += "\x1b\\";
+            return out;
+        }
+        transfer = KITTY_DIRECT;
+    }
+
+    // Chunks of whole base64 groups, each flagged with whether more follow
+    vector<uint8_t> rgba(image.width * image.height * 4);
+    copy_rgba(image, rgba.data());
+    out.reserve(keys.size() + (rgba.size() / KITTY_CHUNK_BYTES + 1) * (KITTY_CHUNK + 16));
+    for (size_t offset = 0; offset < rgba.size(); offset += KITTY_CHUNK_BYTES) {
+        size_t n = min(rgba.size() - offset, KITTY_CHUNK_BYTES);
+        bool more = offset + n < rgba.size();
+        out += offset == 0 ? "\x1b_G" + keys + ",m=" : string("\x1b_Gm=");
+        out += more ? "1;" : "0;";
+        append_base64(out, rgba.data() + offset, n);
+        out += "\x1b\\";
+    }
+    return out;
+}
\ No newline at end of file
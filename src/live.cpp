@@ -0,0 +1,104 @@
+#include <csignal>
+#include <iostream>
+
+#include "../include/argparse.hpp"
+#include "../include/image.hpp"
+#include "../include/live.hpp"
+#include "../include/print_image.hpp"
+
+using namespace std;
+
+// Switches to the alternate screen with the cursor hidden, and back on scope exit
+class AlternateScreen {
+   public:
+    AlternateScreen() { cout << "\x1b[?1049h\x1b[?25l" << flush; }
+    ~AlternateScreen() { cout << "\x1b[0m\x1b[?25h\x1b[?1049l" << flush; }
+};
+
+// Fits the image to the terminal, leaving the last row for the cursor
+static void render_frame(const SummedAreaTable& table, const AnalysisOptions& options, double character_ratio, size_t columns, size_t rows, FrameRecorder* recorder) {
+    size_t width, height, upright_width, upright_height;
+    get_oriented_dimensions(table.width, table.height, table.orientation, upright_width, upright_height);
+    get_resized_dimensions(upright_width, upright_height, columns, rows > 1 ? rows - 1 : 1, character_ratio, width, height);
+
+    CellGrid cells = analyze_cells(table, width, height, options);
+    dither_cells(options, cells);
+    cout << "\x1b[H\x1b[2J";
+    print_image(cells);
+    cout << flush;
+
+    if (recorder) {
+        recorder->resize(columns, rows);
+        recorder->record_frame(cells);
+    }
+}
+
+#ifdef _WIN32
+void run_live_view(const SummedAreaTable& table, const AnalysisOptions& options, double character_ratio, FrameRecorder* recorder) {
+    cerr << "Warning: Live view is not supported on Windows, rendering once" << endl;
+
+    size_t columns = 80, rows = 25;
+    try_get_terminal_size(columns, rows);
+    render_frame(table, options, character_ratio, columns, rows, recorder);
+}
+#else
+static volatile sig_atomic_t resize_pending = 0;
+static volatile sig_atomic_t quit_requested = 0;
+
+static void on_resize(int) {
+    resize_pending = 1;
+}
+
+static void on_quit(int) {
+    quit_requested = 1;
+}
+
+void run_live_view(const SummedAreaTable& table, const AnalysisOptions& options, double character_ratio, FrameRecorder* recorder) {
+    // Block the signals outside sigsuspend, so a resize arriving mid-frame is picked
+    // up right after it, and any number of them collapse into a single pending one
+    sigset_t watched, previous;
+    sigemptyset(&watched);
+    sigaddset(&watched, SIGWINCH);
+    sigaddset(&watched, SIGINT);
+    sigaddset(&watched, SIGTERM);
+    sigprocmask(SIG_BLOCK, &watched, &previous);
+
+    struct sigaction action = {};
+    action.sa_handler = on_resize;
+    sigaction(SIGWINCH, &action, nullptr);
+    action.sa_handler = on_quit;
+    sigaction(SIGINT, &action, nullptr);
+    sigaction(SIGTERM, &action, nullptr);
+
+    {
+        AlternateScreen screen;
+        size_t last_columns = 0, last_rows = 0;
+        resize_pending = 1;
+
+        while (!quit_requested) {
+            if (resize_pending) {
+                resize_pending = 0;
+
+                size_t columns, rows;
+                if (!try_get_terminal_size(columns, rows)) {
+                    cerr << "Warning: Cannot get terminal size, live view needs a terminal" << endl;
+                    break;
+                }
+
+                // Only size changes need a new frame
+                if (columns != last_columns || rows != last_rows) {
+                    render_frame(table, options, character_ratio, columns, rows, recorder);
+                    last_columns = columns;
+                    last_rows = rows;
+                }
+            }
+
+            if (!resize_pending && !quit_requested) {
+                sigsuspend(&previous);
+            }
+        }
+    }
+
+    sigprocmask(SIG_SETMASK, &previous, nullptr);
+}
+#endif
\ No newline at end of file
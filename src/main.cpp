@@ -1,13 +1,118 @@
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 #include <memory>
 
 #include "../include/argparse.hpp"
+#include "../include/cell_store.hpp"
+#include "../include/cells.hpp"
+#include "../include/charset.hpp"
 #include "../include/image.hpp"
+#include "../include/jpeg_header.hpp"
+#include "../include/kitty.hpp"
+#include "../include/live.hpp"
+#include "../include/export.hpp"
+#include "../include/font.hpp"
 #include "../include/print_image.hpp"
+#include "../include/profile.hpp"
+#include "../include/source.hpp"
+#include "../include/viewer.hpp"
 
 using namespace std;
 
+// Largest relative difference in aspect ratio between a thumbnail and its image for the
+// thumbnail to stand in for it; letterboxed thumbnails are rejected
+constexpr double MAX_THUMBNAIL_ASPECT_ERROR = 0.02;
+
+// Embedded EXIF thumbnail of a JPEG, turned upright, along with the upright size of the
+// full image. Reads nothing past the header segments and the thumbnail itself.
+static ByteImage load_thumbnail(const string& file_path, size_t& full_width, size_t& full_height) {
+    JpegHeader header;
+    if (!read_jpeg_header(file_path, header) || header.thumbnail_size == 0) {
+        return ByteImage();
+    }
+
+    get_oriented_dimensions(header.width, header.height, header.orientation, full_width, full_height);
+    ByteImage thumbnail = make_oriented(load_jpeg_thumbnail(file_path, header), header.orientation);
+    if (thumbnail.empty()) {
+        return ByteImage();
+    }
+
+    double full_aspect = static_cast<double>(full_width) / full_height;
+    double thumbnail_aspect = static_cast<double>(thumbnail.width) / thumbnail.height;
+    if (fabs(thumbnail_aspect / full_aspect - 1.0) > MAX_THUMBNAIL_ASPECT_ERROR) {
+        return ByteImage();
+    }
+    return thumbnail;
+}
+
+// Ends the recording, if any, reporting a failed write
+static bool finish_recording(FrameRecorder* recorder) {
+    if (recorder && !recorder->close()) {
+        cerr << "Error: Failed to write the recording!" << endl;
+        return false;
+    }
+    return true;
+}
+
+// Draws every frame of a PGM/PPM stream, as fast as they arrive, analyzing only the cells
+// each one changes. Frames repaint in place on a terminal; otherwise the last one is printed.
+static bool play_video(const Args& args, const AnalysisOptions& options, FrameRecorder* recorder, Profile& profile) {
+    unique_ptr<FrameStream> stream = FrameStream::open(args.file_path);
+    ByteImage frame = stream ? stream->read_frame() : ByteImage();
+    if (frame.empty()) {
+        cerr << "Error: Failed to load image data!" << endl;
+        return false;
+    }
+
+    // Frames repaint in place, so like --progressive they stop a row short of the terminal
+    bool on_terminal = is_output_terminal();
+    size_t max_height = args.max_height, columns, rows;
+    if (on_terminal && try_get_terminal_size(columns, rows) && rows > 1) {
+        max_height = min(max_height, rows - 1);
+    }
+
+    size_t width, height;
+    get_resized_dimensions(frame.width, frame.height, args.max_width, max_height, args.character_ratio, width, height);
+    FrameAnalyzer analyzer(width, height, options);
+    CellGrid shown;
+    size_t frames = 0, changed = 0;
+    for (; !frame.empty(); frame = stream->read_frame()) {
+        CellGrid cells = analyzer.analyze(frame);
+        changed += analyzer.get_changed_cells();
+        frames++;
+        if (options.palette != PALETTE_TRUECOLOR) {
+            dither_cells(options, cells);
+        }
+
+        if (on_terminal && !shown.empty()) {
+            repaint_image(shown, cells);
+        } else if (on_terminal) {
+            print_image(cells);
+            cout << flush;
+            profile.mark_first_output();
+        }
+        if (recorder) {
+            recorder->record_frame(cells);
+        }
+        shown = move(cells);
+    }
+    profile.end_stage("video");
+
+    if (!on_terminal) {
+        print_image(shown);
+        cout << flush;
+    }
+    if (args.profile) {
+        cerr << "Analyzed " << changed << " of " << frames * shown.cells.size() << " cells over " << frames << " frames" << endl;
+        profile.print(cerr);
+    }
+    return true;
+}
+
 int main(int argc, char* argv[]) {
+    Profile profile;
+
     // Parse arguments
     Args args = parse_args(argc, argv);
     if (args.file_path.empty()) {
@@ -15,22 +120,325 @@ int main(int argc, char* argv[]) {
     }
 
     try {
-        // Load image
-        Image original = load_image(args.file_path);
-        if (original.data.empty()) {
-            cerr << "Error: Failed to load image data!" << endl;
+        AnalysisOptions options;
+        options.edge_threshold = args.edge_threshold;
+        options.palette = args.palette;
+        options.dither = args.dither;
+        if (args.dither != DITHER_NONE && args.palette == PALETTE_TRUECOLOR) {
+            // Retro colors are dithered in the palette of the same 8 colors
+            if (args.use_retro_colors) {
+                options.palette = PALETTE_8;
+            } else {
+                cerr << "Warning: --dither has no effect without --colors" << endl;
+            }
+        }
+        // Palettes are quantized after the analysis, from its truecolor cells
+        options.color_mode = args.use_retro_colors && options.palette == PALETTE_TRUECOLOR ? COLOR_RETRO : COLOR_TRUECOLOR;
+        options.isa = args.isa;
+        options.threads = args.threads;
+        options.memory_budget = args.memory_budget;
+        copy_n(args.background, 3, options.background);
+        options.linear_light = args.linear_light;
+
+        // Shapes are matched against every printable ASCII character by default
+        options.shape_matching = args.shapes;
+        if (args.shapes && args.charset.empty()) {
+            for (char c = ' '; c <= '~'; c++) {
+                args.charset.push_back(c);
+            }
+        }
+
+        // Custom glyph ramp, measured against the built-in font
+        Charset charset;
+        if (!args.charset.empty()) {
+            bool loaded = args.charset_cache.empty() ? make_charset(args.charset, charset) : load_charset(args.charset, args.charset_cache, charset);
+            if (!loaded) {
+                return 1;
+            }
+            options.charset = &charset;
+        } else if (!args.charset_cache.empty()) {
+            cerr << "Warning: --charset-cache has no effect without --charset" << endl;
+        }
+
+        // The interactive modes and video draw on the terminal
+        if ((args.viewer || args.live_view || args.video) && (args.format != FORMAT_ANSI || !args.outputs.empty())) {
+            cerr << "Warning: --format and --output have no effect with --view, --live or --video" << endl;
+        } else if (!args.outputs.empty() && args.format != FORMAT_ANSI) {
+            cerr << "Warning: --format has no effect with --output" << endl;
+        }
+
+        // Targets are written at once, so no two may share a file
+        for (size_t i = 0; i < args.outputs.size(); i++) {
+            for (size_t j = 0; j < i; j++) {
+                if (args.outputs[i].path == args.outputs[j].path) {
+                    cerr << "Error: More than one output writes to '" << args.outputs[i].path << "'!" << endl;
+                    return 1;
+                }
+            }
+        }
+
+        // Frames are recorded as they are drawn, in a cast the size of the terminal if there is one
+        unique_ptr<FrameRecorder> recorder;
+        if (!args.record_path.empty()) {
+            size_t columns = 0, rows = 0;
+            try_get_terminal_size(columns, rows);
+            recorder = open_frame_recorder(args.record_path, columns, rows);
+            if (!recorder) {
+                cerr << "Error: Failed to open '" << args.record_path << "' for recording!" << endl;
+                return 1;
+            }
+        }
+        FrameRecorder* recording = recorder.get();
+
+        // A .acells recording replays its stored cells, with no decoding or analysis
+        CellStore store;
+        CellGrid coarse, cells;
+        if (is_cell_store_path(args.file_path)) {
+            if (!store.open(args.file_path) || store.empty()) {
+                cerr << "Error: Failed to read cells from '" << args.file_path << "'!" << endl;
+                return 1;
+            }
+            if (args.viewer || args.live_view) {
+                cerr << "Warning: --view and --live have no effect on stored cells" << endl;
+                args.viewer = args.live_view = false;
+            }
+
+            // Played at its pace on a terminal or into a recording, unless one frame is asked for
+            if (args.frame < 0 && args.format == FORMAT_ANSI && args.outputs.empty() && (is_output_terminal() || recording)) {
+                play_cell_store(store, recording);
+                return finish_recording(recording) ? 0 : 1;
+            }
+            if (args.frame >= static_cast<long>(store.size())) {
+                cerr << "Error: --frame " << args.frame << " is past the recording's last frame, " << store.size() - 1 << "!" << endl;
+                return 1;
+            }
+            cells = store.get_frame(args.frame < 0 ? store.size() - 1 : static_cast<size_t>(args.frame));
+            profile.end_stage("seek");
+        } else if (args.frame >= 0) {
+            cerr << "Warning: --frame only selects frames of .acells recordings" << endl;
+        }
+
+        if (args.video) {
+            if (args.viewer || args.live_view || args.shapes) {
+                cerr << "Warning: --view, --live and --shapes have no effect with --video" << endl;
+            }
+            bool played = play_video(args, options, recording, profile);
+            return finish_recording(recording) && played ? 0 : 1;
+        }
+
+        if (args.viewer) {
+            unique_ptr<RowSource> source = open_row_source(args.file_path);
+            int orientation = source ? source->orientation : 1;
+            ByteImage original = read_byte_image(move(source));
+            if (original.empty()) {
+                cerr << "Error: Failed to load image data!" << endl;
+                return 1;
+            }
+
+            // The pyramid and tiles work on upright, opaque pixels
+            original = make_oriented(make_composited(original, options), orientation);
+            run_viewer(original, options, args.character_ratio, recording);
+            return finish_recording(recording) ? 0 : 1;
+        }
+
+        if (args.live_view) {
+            if (args.shapes) {
+                cerr << "Warning: --shapes needs the pixels, which --live does not keep; matching brightness only" << endl;
+            }
+
+            // Keep only the summed-area table, from which every resize re-renders
+            SummedAreaTable table;
+            {
+                unique_ptr<RowSource> source = open_row_source(args.file_path);
+                if (source) {
+                    table = build_summed_area_table(*source, options);
+                }
+            }
+            if (table.empty()) {
+                cerr << "Error: Failed to load image data!" << endl;
+                return 1;
+            }
+
+            run_live_view(table, options, args.character_ratio, recording);
+            return finish_recording(recording) ? 0 : 1;
+        }
+
+        // Progressive output repaints in place, which needs a terminal and the whole frame on screen
+        bool progressive = args.progressive && store.empty() && (args.format == FORMAT_ANSI || args.format == FORMAT_KITTY) && args.outputs.empty() && is_output_terminal();
+        if (progressive) {
+            size_t columns, rows;
+            if (try_get_terminal_size(columns, rows) && rows > 1) {
+                args.max_height = min(args.max_height, rows - 1);
+            }
+        }
+
+        // Sixel and kitty draw the image itself, so its pixels stay in memory, upright, next to the cells
+        bool wants_pixels = args.outputs.empty() && is_pixel_format(args.format);
+        for (const OutputTarget& target : args.outputs) {
+            wants_pixels = wants_pixels || is_pixel_format(target.format);
+        }
+        if (wants_pixels && !store.empty()) {
+            cerr << "Error: Stored cells keep no pixels for sixel or kitty output!" << endl;
             return 1;
         }
 
-        // Resize image
-        Image resized = make_resized(original, args.max_width, args.max_height, args.character_ratio);
-        if (resized.data.empty()) {
-            cerr << "Error: Failed to resize image!" << endl;
+        // Kitty frames of one run share an image id, so the full frame replaces the coarse one
+        KittyImage kitty(get_kitty_image_id(), progressive && args.format == FORMAT_KITTY ? get_kitty_transfer() : KITTY_DIRECT);
+
+        ByteImage upright;
+        size_t width, height;
+        // Thumbnails are read from the file, ahead of the image: stdin cannot be read twice
+        if (cells.empty() && ((args.use_thumbnail && args.use_fixed_point) || progressive) && !is_stdin_path(args.file_path)) {
+            size_t full_width, full_height;
+            ByteImage thumbnail = load_thumbnail(args.file_path, full_width, full_height);
+            if (!thumbnail.empty()) {
+                get_resized_dimensions(full_width, full_height, args.max_width, args.max_height, args.character_ratio, width, height);
+
+                if (args.use_thumbnail && args.use_fixed_point && !args.shapes && !wants_pixels && width <= thumbnail.width && height <= thumbnail.height) {
+                    // The thumbnail has a pixel for every cell: no need to decode the image
+                    cells = analyze_cells(thumbnail, width, height, options);
+                } else if (progressive) {
+                    // Coarse frame of at most one cell per thumbnail pixel, repeated up to the full size
+                    coarse = make_scaled_cells(analyze_cells(thumbnail, min(width, thumbnail.width), min(height, thumbnail.height), options), width, height);
+                    if (args.format == FORMAT_KITTY) {
+                        // The thumbnail's pixels, stretched over the cells the full frame will cover
+                        cout << kitty.encode_frame(make_box_resized(thumbnail, width * FONT_WIDTH, height * FONT_HEIGHT), width, height) << string(height, '\n');
+                    } else {
+                        dither_cells(options, coarse);
+                        print_image(coarse);
+                    }
+                    if (recording) {
+                        recording->record_frame(coarse);
+                    }
+                    cout << flush;
+                    profile.mark_first_output();
+                }
+            }
+            profile.end_stage("thumbnail");
+        }
+
+        // Unless the thumbnail sufficed, load the image and analyze every character cell in one pass over it
+        if (cells.empty() && args.use_fixed_point) {
+            // Streams the file when its format allows, so only the working set is resident
+            unique_ptr<RowSource> source = open_row_source(args.file_path);
+            if (!source) {
+                cerr << "Error: Failed to load image data!" << endl;
+                return 1;
+            }
+
+            profile.end_stage("open");
+
+            get_resized_dimensions(source->upright_width(), source->upright_height(), args.max_width, args.max_height, args.character_ratio, width, height);
+            if (args.shapes || wants_pixels) {
+                // Shapes are sampled from the pixels, so the image stays in memory, upright
+                int orientation = source->orientation;
+                upright = make_oriented(read_byte_image(move(source)), orientation);
+                cells = analyze_cells(upright, width, height, options);
+                if (args.shapes) {
+                    match_shapes(upright, options, cells);
+                }
+            } else {
+                // Streamed sources decode while they are analyzed
+                cells = analyze_cells(*source, width, height, options);
+            }
+            profile.end_stage("analyze");
+        } else if (cells.empty()) {
+            // Same decoders as the fixed-point path, then the whole image as doubles
+            unique_ptr<RowSource> source = open_row_source(args.file_path);
+            int orientation = source ? source->orientation : 1;
+            ByteImage bytes = read_byte_image(move(source));
+            if (bytes.empty()) {
+                cerr << "Error: Failed to load image data!" << endl;
+                return 1;
+            }
+
+            // The reference path turns the image upright with a full copy
+            bytes = make_oriented(bytes, orientation);
+            Image original = make_double_image(bytes);
+            profile.end_stage("decode");
+
+            get_resized_dimensions(original.width, original.height, args.max_width, args.max_height, args.character_ratio, width, height);
+            cells = analyze_cells(original, width, height, options);
+            if (args.shapes) {
+                match_shapes(bytes, options, cells);
+            }
+            if (wants_pixels) {
+                upright = bytes;
+            }
+            profile.end_stage("analyze");
+        }
+
+        if (cells.empty()) {
+            cerr << "Error: Failed to analyze image!" << endl;
             return 1;
         }
 
-        // Print the ASCII art
-        print_image(resized, args.edge_threshold, args.use_retro_colors);
+        // Palettes are quantized from the finished truecolor cells
+        if (options.palette != PALETTE_TRUECOLOR && store.empty()) {
+            dither_cells(options, cells);
+            profile.end_stage("dither");
+        }
+
+        // The pixels cover the same area as the cells, at the font's pixels per cell
+        ByteImage pixels;
+        if (wants_pixels) {
+            pixels = make_box_resized(make_composited(upright, options), cells.width * FONT_WIDTH, cells.height * FONT_HEIGHT);
+            upright = ByteImage();
+            profile.end_stage("resize");
+        }
+
+        // Print the ASCII art, or only what differs from the coarse frame
+        if (!coarse.empty() && coarse.width == cells.width && coarse.height == cells.height && args.format == FORMAT_KITTY) {
+            // Back to the top of the coarse frame, which the full one replaces under the same id
+            cout << "\x1b[" << cells.height << "F" << kitty.encode_frame(pixels, cells.width, cells.height) << "\x1b[" << cells.height << "E" << flush;
+            profile.end_stage("repaint");
+        } else if (!coarse.empty() && coarse.width == cells.width && coarse.height == cells.height) {
+            size_t changed = repaint_image(coarse, cells);
+            profile.end_stage("repaint");
+            if (args.profile) {
+                cerr << "Repainted " << changed << " of " << cells.cells.size() << " cells" << endl;
+            }
+        } else if (!args.outputs.empty()) {
+            // Every emitter reads the same cells, each on its own thread
+            vector<string> failed = write_outputs(cells, pixels, args.outputs, args.threads);
+            for (const string& path : failed) {
+                cerr << "Error: Failed to write '" << path << "'!" << endl;
+            }
+            profile.end_stage("export");
+            if (!failed.empty()) {
+                return 1;
+            }
+        } else if (args.format == FORMAT_ANSI) {
+            print_image(cells);
+            cout << flush;
+            profile.mark_first_output();
+            profile.end_stage("print");
+        } else {
+            OutputBuffer out(stdout);
+            if (is_pixel_format(args.format)) {
+                write_pixels(cells, pixels, args.format, out, args.threads, args.format == FORMAT_KITTY ? get_kitty_transfer() : KITTY_DIRECT);
+            } else {
+                write_cells(cells, args.format, out);
+            }
+            if (!out.flush()) {
+                cerr << "Error: Failed to write the output!" << endl;
+                return 1;
+            }
+            profile.mark_first_output();
+            profile.end_stage("export");
+        }
+
+        // The recording ends on the finished frame, as only its changes when it follows the coarse one
+        if (recording) {
+            recording->record_frame(cells);
+            if (!finish_recording(recording)) {
+                return 1;
+            }
+        }
+
+        if (args.profile) {
+            profile.print(cerr);
+        }
 
     } catch (const exception& e) {
         cerr << "Error: " << e.what() << endl;
@@ -0,0 +1,278 @@
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+#include "../include/png.hpp"
+
+using namespace std;
+
+// Deflate limits: the window matches may reach back over, and the match lengths
+constexpr size_t DEFLATE_WINDOW = 32768;
+constexpr size_t MIN_MATCH = 4;
+constexpr size_t MAX_MATCH = 258;
+constexpr size_t MAX_STORED_BLOCK = 65535;
+
+// Positions are hashed by their first MIN_MATCH bytes into this many slots
+constexpr size_t HASH_BITS = 15;
+
+static const uint32_t* get_crc_table() {
+    static const vector<uint32_t> table = [] {
+        vector<uint32_t> entries(256);
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t crc = i;
+            for (int k = 0; k < 8; k++) {
+                crc = crc & 1 ? 0xedb88320u ^ (crc >> 1) : crc >> 1;
+            }
+            entries[i] = crc;
+        }
+        return entries;
+    }();
+    return table.data();
+}
+
+static uint32_t get_crc32(const uint8_t* data, size_t n, uint32_t crc = 0) {
+    const uint32_t* table = get_crc_table();
+    crc = ~crc;
+    for (size_t i = 0; i < n; i++) {
+        crc = table[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+static uint32_t get_adler32(const uint8_t* data, size_t n) {
+    uint32_t a = 1, b = 0;
+    while (n > 0) {
+        // The largest run of bytes whose sums cannot overflow 32 bits before the modulo
+        size_t run = min(n, static_cast<size_t>(5552));
+        for (size_t i = 0; i < run; i++) {
+            a += data[i];
+            b += a;
+        }
+        a %= 65521;
+        b %= 65521;
+        data += run;
+        n -= run;
+    }
+    return (b << 16) | a;
+}
+
+static void put_u32_be(vector<uint8_t>& out, uint32_t value) {
+    out.insert(out.end(), {uint8_t(value >> 24), uint8_t(value >> 16), uint8_t(value >> 8), uint8_t(value)});
+}
+
+// Deflate bit stream: codes go in least significant bit first
+class BitWriter {
+   public:
+    explicit BitWriter(vector<uint8_t>& out) : out(out), bits(0), n_bits(0) {}
+
+    void put(uint32_t value, size_t n) {
+        bits |= static_cast<uint64_t>(value) << n_bits;
+        n_bits += n;
+        while (n_bits >= 8) {
+            out.push_back(static_cast<uint8_t>(bits));
+            bits >>= 8;
+            n_bits -= 8;
+        }
+    }
+
+    // Pads to a byte boundary
+    void align() {
+        if (n_bits > 0) {
+            put(0, 8 - n_bits);
+        }
+    }
+
+   private:
+    vector<uint8_t>& out;
+    uint64_t bits;
+    size_t n_bits;
+};
+
+// Fixed Huffman codes of the literal/length alphabet, bit-reversed for the stream
+struct FixedCodes {
+    uint16_t codes[288];
+    uint8_t lengths[288];
+    // Length 3-258 as its symbol, extra bits and their value
+    uint16_t length_symbols[MAX_MATCH + 1];
+    uint8_t length_extra_bits[MAX_MATCH + 1];
+    uint16_t length_extra[MAX_MATCH + 1];
+    uint8_t distance_codes[30];  // Bit-reversed 5-bit distance codes
+};
+
+static uint32_t reverse_bits(uint32_t value, size_t n) {
+    uint32_t reversed = 0;
+    for (size_t i = 0; i < n; i++) {
+        reversed = (reversed << 1) | ((value >> i) & 1);
+    }
+    return reversed;
+}
+
+static const FixedCodes& get_fixed_codes() {
+    static const FixedCodes table = [] {
+        FixedCodes entries;
+        for (uint32_t symbol = 0; symbol < 288; symbol++) {
+            uint32_t code, length;
+            if (symbol < 144) {
+                code = 0x30 + symbol;
+                length = 8;
+            } else if (symbol < 256) {
+                code = 0x190 + symbol - 144;
+                length = 9;
+            } else if (symbol < 280) {
+                code = symbol - 256;
+                length = 7;
+            } else {
+                code = 0xc0 + symbol - 280;
+                length = 8;
+            }
+            entries.codes[symbol] = static_cast<uint16_t>(reverse_bits(code, length));
+            entries.lengths[symbol] = static_cast<uint8_t>(length);
+        }
+
+        // Length symbols 257-284 cover 3-257 in groups of 4 << extra bits; 285 is 258 alone
+        uint32_t symbol = 257, base = 3;
+        for (uint32_t extra_bits = 0; symbol < 285; extra_bits += symbol >= 265 ? 1 : 0) {
+            for (uint32_t k = 0; k < 4 && symbol < 285; k++, symbol++) {
+                for (uint32_t extra = 0; extra < (1u << extra_bits); extra++) {
+                    entries.length_symbols[base + extra] = static_cast<uint16_t>(symbol);
+                    entries.length_extra_bits[base + extra] = static_cast<uint8_t>(extra_bits);
+                    entries.length_extra[base + extra] = static_cast<uint16_t>(extra);
+                }
+                base += 1u << extra_bits;
+            }
+        }
+        entries.length_symbols[MAX_MATCH] = 285;
+        entries.length_extra_bits[MAX_MATCH] = 0;
+        entries.length_extra[MAX_MATCH] = 0;
+
+        for (uint32_t code = 0; code < 30; code++) {
+            entries.distance_codes[code] = static_cast<uint8_t>(reverse_bits(code, 5));
+        }
+        return entries;
+    }();
+    return table;
+}
+
+static void put_symbol(BitWriter& writer, const FixedCodes& codes, uint32_t symbol) {
+    writer.put(codes.codes[symbol], codes.lengths[symbol]);
+}
+
+// Distances 1-4 have a code each; above that, code 2n or 2n + 1 covers the distances
+// whose d - 1 has its top bit at n, split by the next bit, with n - 1 extra bits
+static void put_distance(BitWriter& writer, const FixedCodes& codes, uint32_t distance) {
+    uint32_t d = distance - 1;
+    if (d < 4) {
+        writer.put(codes.distance_codes[d], 5);
+        return;
+    }
+    uint32_t top = 31 - __builtin_clz(d);
+    uint32_t code = 2 * top + ((d >> (top - 1)) & 1);
+    writer.put(codes.distance_codes[code], 5);
+    writer.put(d & ((1u << (top - 1)) - 1), top - 1);
+}
+
+static uint32_t read_u32(const uint8_t* data) {
+    uint32_t value;
+    memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+// One final block with fixed Huffman codes, matched greedily against the most recent
+// position with the same first bytes. Every position of a literal is hashed; matched
+// ones are skipped, which is what keeps runs of background cheap.
+static void deflate_fast(const uint8_t* data, size_t n, vector<uint8_t>& out) {
+    const FixedCodes& codes = get_fixed_codes();
+    BitWriter writer(out);
+    writer.put(1, 1);  // Final block
+    writer.put(1, 2);  // Fixed Huffman codes
+
+    // Positions plus one, so zero is an empty slot
+    vector<uint32_t> heads(size_t(1) << HASH_BITS, 0);
+    size_t i = 0;
+    while (i + MIN_MATCH <= n) {
+        uint32_t head = read_u32(data + i);
+        uint32_t hash = (head * 2654435761u) >> (32 - HASH_BITS);
+        size_t candidate = heads[hash];
+        heads[hash] = static_cast<uint32_t>(i + 1);
+
+        if (candidate > 0 && i - (candidate - 1) <= DEFLATE_WINDOW && read_u32(data + candidate - 1) == head) {
+            const uint8_t* match = data + candidate - 1;
+            size_t limit = min(MAX_MATCH, n - i);
+            size_t length = MIN_MATCH;
+            while (length < limit && match[length] == data[i + length]) {
+                length++;
+            }
+
+            put_symbol(writer, codes, codes.length_symbols[length]);
+            writer.put(codes.length_extra[length], codes.length_extra_bits[length]);
+            put_distance(writer, codes, static_cast<uint32_t>(data + i - match));
+            i += length;
+        } else {
+            put_symbol(writer, codes, data[i]);
+            i++;
+        }
+    }
+    for (; i < n; i++) {
+        put_symbol(writer, codes, data[i]);
+    }
+
+    put_symbol(writer, codes, 256);  // End of block
+    writer.align();
+}
+
+static void deflate_stored(const uint8_t* data, size_t n, vector<uint8_t>& out) {
+    size_t offset = 0;
+    do {
+        size_t length = min(n - offset, MAX_STORED_BLOCK);
+        out.push_back(offset + length == n ? 1 : 0);  // Final flag, stored type, padding
+        out.insert(out.end(), {uint8_t(length), uint8_t(length >> 8), uint8_t(~length), uint8_t(~length >> 8)});
+        out.insert(out.end(), data + offset, data + offset + length);
+        offset += length;
+    } while (offset < n);
+}
+
+static void put_chunk(vector<uint8_t>& out, const char* type, const uint8_t* data, size_t n) {
+    put_u32_be(out, static_cast<uint32_t>(n));
+    size_t start = out.size();
+    out.insert(out.end(), type, type + 4);
+    out.insert(out.end(), data, data + n);
+    put_u32_be(out, get_crc32(&out[start], n + 4));
+}
+
+vector<uint8_t> encode_png(const ByteImage& image, PngCompression compression) {
+    static const uint8_t COLOR_TYPES[] = {0, 4, 2, 6};
+    if (image.empty() || image.channels < 1 || image.channels > 4) {
+        throw invalid_argument("PNG images must have 1 to 4 channels");
+    }
+
+    // Scanlines, each after a filter type byte of 0 (none)
+    size_t row_bytes = image.width * image.channels;
+    vector<uint8_t> scanlines(image.height * (row_bytes + 1));
+    for (size_t y = 0; y < image.height; y++) {
+        scanlines[y * (row_bytes + 1)] = 0;
+        memcpy(&scanlines[y * (row_bytes + 1) + 1], image.row(y), row_bytes);
+    }
+
+    // zlib stream: header with a 32K window and no dictionary, deflate data, Adler-32
+    vector<uint8_t> stream = {0x78, 0x01};
+    if (compression == PNG_FAST) {
+        deflate_fast(scanlines.data(), scanlines.size(), stream);
+    }
+    size_t stored_size = 2 + scanlines.size() + 5 * (scanlines.size() / MAX_STORED_BLOCK + 1);
+    if (compression == PNG_STORED || stream.size() > stored_size) {
+        stream.resize(2);
+        deflate_stored(scanlines.data(), scanlines.size(), stream);
+    }
+    put_u32_be(stream, get_adler32(scanlines.data(), scanlines.size()));
+
+    vector<uint8_t> png = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'};
+    vector<uint8_t> header;
+    put_u32_be(header, static_cast<uint32_t>(image.width));
+    put_u32_be(header, static_cast<uint32_t>(image.height));
+    header.insert(header.end(), {8, COLOR_TYPES[image.channels - 1], 0, 0, 0});  // Bit depth, color type, deflate, no filter, no interlace
+    put_chunk(png, "IHDR", header.data(), header.size());
+    put_chunk(png, "IDAT", stream.data(), stream.size());
+    put_chunk(png, "IEND", nullptr, 0);
+    return png;
+}
\ No newline at end of file
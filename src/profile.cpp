@@ -0,0 +1,35 @@
+#include <iomanip>
+
+#include "../include/profile.hpp"
+
+using namespace std;
+
+Profile::Profile() : start(Clock::now()), stage_start(start), first_output_ms(-1.0) {}
+
+double Profile::get_elapsed_ms(Clock::time_point since) const {
+    chrono::duration<double, milli> elapsed = Clock::now() - since;
+    return elapsed.count();
+}
+
+void Profile::end_stage(const string& name) {
+    Clock::time_point now = Clock::now();
+    stages.emplace_back(name, chrono::duration<double, milli>(now - stage_start).count());
+    stage_start = now;
+}
+
+void Profile::mark_first_output() {
+    if (first_output_ms < 0) {
+        first_output_ms = get_elapsed_ms(start);
+    }
+}
+
+void Profile::print(ostream& out) const {
+    out << "Profile:\n" << fixed << setprecision(2);
+    for (const auto& stage : stages) {
+        out << "  " << left << setw(16) << stage.first << right << setw(10) << stage.second << " ms\n";
+    }
+    if (first_output_ms >= 0) {
+        out << "  " << left << setw(16) << "first output" << right << setw(10) << first_output_ms << " ms\n";
+    }
+    out << "  " << left << setw(16) << "total" << right << setw(10) << get_elapsed_ms(start) << " ms\n";
+}
\ No newline at end of file
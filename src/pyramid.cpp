@@ -0,0 +1,86 @@
+#include <algorithm>
+
+#include "../include/color.hpp"
+#include "../include/pyramid.hpp"
+
+using namespace std;
+
+// Averages 2x2 blocks of `source` into rows [y1, y2) of the next level. Blocks on an odd
+// right or bottom edge average the pixels they have. With `linear_light` the average is
+// taken in linear light; alpha is always averaged as it is.
+static void halve_rows(const ByteImage& source, uint8_t* target, size_t target_width, size_t y1, size_t y2, bool linear_light) {
+    size_t channels = source.channels;
+    size_t n_colors = linear_light ? (channels == 2 || channels == 4 ? channels - 1 : channels) : 0;
+    const uint16_t* linear_table = get_linear_table();
+    const uint16_t* srgb_table = get_srgb_table();
+    for (size_t y = y1; y < y2; y++) {
+        const uint8_t* top = source.row(2 * y);
+        const uint8_t* bottom = 2 * y + 1 < source.height ? source.row(2 * y + 1) : top;
+        uint8_t* out = target + y * target_width * channels;
+
+        for (size_t x = 0; x < target_width; x++) {
+            size_t left = 2 * x * channels;
+            size_t right = 2 * x + 1 < source.width ? left + channels : left;
+            for (size_t c = 0; c < n_colors; c++) {
+                unsigned sum = linear_table[top[left + c]] + linear_table[top[right + c]] + linear_table[bottom[left + c]] + linear_table[bottom[right + c]];
+                out[x * channels + c] = static_cast<uint8_t>((srgb_table[(sum + 2) / 4] + 128) >> 8);
+            }
+            for (size_t c = n_colors; c < channels; c++) {
+                unsigned sum = top[left + c] + top[right + c] + bottom[left + c] + bottom[right + c];
+                out[x * channels + c] = static_cast<uint8_t>((sum + 2) / 4);
+            }
+        }
+    }
+}
+
+Pyramid::Pyramid(const ByteImage& image, size_t threads, bool linear_light)
+    : ready(1), cancelled(false), threads(threads ? threads : max(1u, thread::hardware_concurrency())), linear_light(linear_light) {
+    // Allocate every level up front so finished ones never move
+    images.push_back(image);
+    size_t width = image.width, height = image.height;
+    while (width > 1 || height > 1) {
+        width = (width + 1) / 2;
+        height = (height + 1) / 2;
+        buffers.emplace_back(width * height * image.channels);
+        images.emplace_back(width, height, image.channels, buffers.back().data(), nullptr);
+    }
+
+    builder = thread(&Pyramid::build, this);
+}
+
+Pyramid::~Pyramid() {
+    cancelled = true;
+    wait();
+}
+
+void Pyramid::wait() {
+    if (builder.joinable()) {
+        builder.join();
+    }
+}
+
+const ByteImage& Pyramid::get_level(size_t level, size_t& level_used) const {
+    level_used = min(level, levels_ready() - 1);
+    return images[level_used];
+}
+
+void Pyramid::build() {
+    for (size_t level = 1; level < images.size() && !cancelled; level++) {
+        const ByteImage& source = images[level - 1];
+        ByteImage& target = images[level];
+        uint8_t* pixels = buffers[level - 1].data();
+
+        // Split the level's rows between workers
+        size_t workers = max(static_cast<size_t>(1), min(threads, target.height / 64));
+        vector<thread> pool;
+        for (size_t worker = 1; worker < workers; worker++) {
+            pool.emplace_back(halve_rows, cref(source), pixels, target.width, (worker * target.height) / workers, ((worker + 1) * target.height) / workers, linear_light);
+        }
+        halve_rows(source, pixels, target.width, 0, target.height / workers, linear_light);
+        for (thread& t : pool) {
+            t.join();
+        }
+
+        ready.store(level + 1, memory_order_release);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,21 @@
+#include "../include/cast.hpp"
+#include "../include/cell_store.hpp"
+#include "../include/recorder.hpp"
+
+using namespace std;
+
+unique_ptr<FrameRecorder> open_frame_recorder(const string& path, size_t columns, size_t rows) {
+    if (is_cell_store_path(path)) {
+        auto store = make_unique<CellStoreWriter>();
+        if (!store->open(path)) {
+            return nullptr;
+        }
+        return store;
+    }
+
+    auto cast = make_unique<CastRecorder>();
+    if (!cast->open(path, columns, rows)) {
+        return nullptr;
+    }
+    return cast;
+}
\ No newline at end of file
@@ -0,0 +1,265 @@
+#include <algorithm>
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "../include/sixel.hpp"
+
+using namespace std;
+
+// Rows of pixels in a sixel band, one per bit of a sixel character
+constexpr size_t SIXEL_BAND_ROWS = 6;
+
+// Runs of a character at least this long are written as "!<count><character>"
+constexpr size_t SIXEL_MIN_REPEAT = 4;
+
+// Bits the palette table keeps of each channel
+constexpr size_t LUT_BITS = 5;
+
+// RGB of a pixel of 1 to 4 channels; gray is repeated, alpha ignored
+static inline void get_rgb(const uint8_t* pixel, size_t channels, uint8_t* rgb) {
+    if (channels < 3) {
+        rgb[0] = rgb[1] = rgb[2] = pixel[0];
+    } else {
+        rgb[0] = pixel[0];
+        rgb[1] = pixel[1];
+        rgb[2] = pixel[2];
+    }
+}
+
+static inline size_t get_lut_index(const uint8_t* rgb) {
+    constexpr size_t SHIFT = 8 - LUT_BITS;
+    return (size_t(rgb[0] >> SHIFT) << (2 * LUT_BITS)) | (size_t(rgb[1] >> SHIFT) << LUT_BITS) | (rgb[2] >> SHIFT);
+}
+
+static inline size_t get_lut_channel(size_t index, size_t c) {
+    return (index >> ((2 - c) * LUT_BITS)) & ((size_t(1) << LUT_BITS) - 1);
+}
+
+// Occupied table entries [begin, end) of a median cut box, and their extent per channel
+struct ColorBox {
+    size_t begin, end;
+    uint64_t count;
+    size_t low[3], high[3];
+
+    // Constructor with default values
+    ColorBox() : begin(0), end(0), count(0), low{0, 0, 0}, high{0, 0, 0} {}
+};
+
+static ColorBox make_color_box(const vector<uint16_t>& indices, const vector<uint32_t>& counts, size_t begin, size_t end) {
+    ColorBox box;
+    box.begin = begin;
+    box.end = end;
+    box.low[0] = box.low[1] = box.low[2] = size_t(1) << LUT_BITS;
+    for (size_t i = begin; i < end; i++) {
+        box.count += counts[indices[i]];
+        for (size_t c = 0; c < 3; c++) {
+            size_t value = get_lut_channel(indices[i], c);
+            box.low[c] = min(box.low[c], value);
+            box.high[c] = max(box.high[c], value);
+        }
+    }
+    return box;
+}
+
+static size_t get_longest_axis(const ColorBox& box) {
+    size_t axis = 0;
+    for (size_t c = 1; c < 3; c++) {
+        if (box.high[c] - box.low[c] > box.high[axis] - box.low[axis]) {
+            axis = c;
+        }
+    }
+    return axis;
+}
+
+SixelPalette make_sixel_palette(const ByteImage& image, size_t max_colors) {
+    if (image.empty() || image.channels < 1 || image.channels > 4) {
+        throw invalid_argument("Sixel images must have 1 to 4 channels");
+    }
+    max_colors = max(static_cast<size_t>(1), min(max_colors, SIXEL_MAX_COLORS));
+
+    // Histogram of the table's colors, with the exact sums of the pixels in each
+    size_t n_entries = size_t(1) << (3 * LUT_BITS);
+    vector<uint32_t> counts(n_entries, 0);
+    vector<uint64_t> sums(n_entries * 3, 0);
+    for (size_t y = 0; y < image.height; y++) {
+        const uint8_t* row = image.row(y);
+        for (size_t x = 0; x < image.width; x++) {
+            uint8_t rgb[3];
+            get_rgb(row + x * image.channels, image.channels, rgb);
+            size_t index = get_lut_index(rgb);
+            counts[index]++;
+            sums[index * 3] += rgb[0];
+            sums[index * 3 + 1] += rgb[1];
+            sums[index * 3 + 2] += rgb[2];
+        }
+    }
+
+    vector<uint16_t> indices;
+    for (size_t i = 0; i < n_entries; i++) {
+        if (counts[i] > 0) {
+            indices.push_back(static_cast<uint16_t>(i));
+        }
+    }
+
+    // Split the box whose pixels spread the most, count times extent, until none can be
+    vector<ColorBox> boxes = {make_color_box(indices, counts, 0, indices.size())};
+    while (boxes.size() < max_colors) {
+        size_t best = boxes.size();
+        uint64_t best_score = 0;
+        for (size_t i = 0; i < boxes.size(); i++) {
+            const ColorBox& box = boxes[i];
+            size_t axis = get_longest_axis(box);
+            uint64_t score = box.count * (box.high[axis] - box.low[axis]);
+            if (box.end - box.begin > 1 && score > best_score) {
+                best = i;
+                best_score = score;
+            }
+        }
+        if (best == boxes.size()) {
+            break;
+        }
+
+        ColorBox box = boxes[best];
+        size_t axis = get_longest_axis(box);
+        sort(indices.begin() + box.begin, indices.begin() + box.end, [axis](uint16_t a, uint16_t b) {
+            size_t va = get_lut_channel(a, axis), vb = get_lut_channel(b, axis);
+            return va != vb ? va < vb : a < b;
+        });
+
+        // First entry past half the pixels, leaving at least one entry on each side
+        size_t split = box.begin;
+        for (uint64_t below = 0; split < box.end - 1 && (below += counts[indices[split]]) * 2 < box.count;) {
+            split++;
+        }
+        split = min(max(split + 1, box.begin + 1), box.end - 1);
+
+        boxes[best] = make_color_box(indices, counts, box.begin, split);
+        boxes.push_back(make_color_box(indices, counts, split, box.end));
+    }
+
+    // Each entry is the mean of its pixels, and the table maps its colors to it
+    SixelPalette palette;
+    palette.colors.resize(boxes.size() * 3);
+    palette.lut.assign(n_entries, 0);
+    for (size_t b = 0; b < boxes.size(); b++) {
+        uint64_t total[3] = {0, 0, 0};
+        for (size_t i = boxes[b].begin; i < boxes[b].end; i++) {
+            palette.lut[indices[i]] = static_cast<uint8_t>(b);
+            for (size_t c = 0; c < 3; c++) {
+                total[c] += sums[indices[i] * 3 + c];
+            }
+        }
+        for (size_t c = 0; c < 3; c++) {
+            palette.colors[b * 3 + c] = boxes[b].count ? static_cast<uint8_t>((total[c] + boxes[b].count / 2) / boxes[b].count) : 0;
+        }
+    }
+    return palette;
+}
+
+// Appends `n` of a sixel character, as a repeat when that is shorter
+static void append_run(string& out, char sixel, size_t n) {
+    if (n >= SIXEL_MIN_REPEAT) {
+        out += '!';
+        out += to_string(n);
+        out += sixel;
+    } else {
+        out.append(n, sixel);
+    }
+}
+
+// One band: every color in it, in palette order, as a row of sixels over the band.
+// `bits` holds a row of sixels per palette entry and is left zeroed for the next band.
+static void encode_band(const ByteImage& image, const SixelPalette& palette, size_t y0, vector<uint8_t>& bits, vector<char>& used, string& out) {
+    size_t width = image.width;
+    size_t rows = min(SIXEL_BAND_ROWS, image.height - y0);
+    for (size_t r = 0; r < rows; r++) {
+        const uint8_t* row = image.row(y0 + r);
+        for (size_t x = 0; x < width; x++) {
+            uint8_t rgb[3];
+            get_rgb(row + x * image.channels, image.channels, rgb);
+            size_t entry = palette.lut[get_lut_index(rgb)];
+            bits[entry * width + x] |= static_cast<uint8_t>(1 << r);
+            used[entry] = 1;
+        }
+    }
+
+    bool first = true;
+    for (size_t entry = 0; entry < palette.size(); entry++) {
+        if (!used[entry]) {
+            continue;
+        }
+        used[entry] = 0;
+
+        // Columns past the last one the color covers are left out
+        uint8_t* sixels = &bits[entry * width];
+        size_t end = width;
+        while (end > 0 && sixels[end - 1] == 0) {
+            end--;
+        }
+
+        if (!first) {
+            out += '$';  // Back to the start of the band
+        }
+        first = false;
+        out += '#';
+        out += to_string(entry);
+        for (size_t x = 0; x < end;) {
+            size_t run = x + 1;
+            while (run < end && sixels[run] == sixels[x]) {
+                run++;
+            }
+            append_run(out, static_cast<char>('?' + sixels[x]), run - x);
+            x = run;
+        }
+        fill(sixels, sixels + width, 0);
+    }
+}
+
+string encode_sixel(const ByteImage& image, size_t threads) {
+    SixelPalette palette = make_sixel_palette(image);
+
+    // Bands are independent, so each worker takes the next one and encodes it into its own string
+    size_t n_bands = (image.height + SIXEL_BAND_ROWS - 1) / SIXEL_BAND_ROWS;
+    vector<string> bands(n_bands);
+    atomic<size_t> next_band(0);
+    auto worker = [&] {
+        vector<uint8_t> bits(palette.size() * image.width, 0);
+        vector<char> used(palette.size(), 0);
+        for (size_t band; (band = next_band.fetch_add(1)) < n_bands;) {
+            encode_band(image, palette, band * SIXEL_BAND_ROWS, bits, used, bands[band]);
+        }
+    };
+
+    size_t n_threads = threads ? threads : max(1u, thread::hardware_concurrency());
+    n_threads = max(static_cast<size_t>(1), min(n_threads, n_bands));
+    vector<thread> pool;
+    for (size_t i = 1; i < n_threads; i++) {
+        pool.emplace_back(worker);
+    }
+    worker();
+    for (thread& t : pool) {
+        t.join();
+    }
+
+    // DCS with square pixels, raster attributes, the palette in percent, then the bands
+    string out = "\x1bP0;1;0q\"1;1;" + to_string(image.width) + ";" + to_string(image.height);
+    for (size_t entry = 0; entry < palette.size(); entry++) {
+        out += "#" + to_string(entry) + ";2";
+        for (size_t c = 0; c < 3; c++) {
+            out += ";" + to_string((palette.colors[entry * 3 + c] * 100 + 127) / 255);
+        }
+    }
+    size_t size = out.size();
+    for (const string& band : bands) {
+        size += band.size() + 1;
+    }
+    out.reserve(size + 3);
+    for (size_t band = 0; band < n_bands; band++) {
+        out += bands[band];
+        out += band + 1 < n_bands ? "-" : "";
+    }
+    out += "\x1b\\\n";
+    return out;
+}
\ No newline at end of file
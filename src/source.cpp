@@ -0,0 +1,609 @@
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "../include/jpeg_header.hpp"
+#include "../include/kernels.hpp"
+#include "../include/source.hpp"
+
+using namespace std;
+
+// QOI stream layout
+constexpr size_t QOI_HEADER_SIZE = 14;
+constexpr size_t QOI_PADDING = 8;
+constexpr uint8_t QOI_OP_RGB = 0xfe;
+constexpr uint8_t QOI_OP_RGBA = 0xff;
+// Largest image the QOI specification has decoders accept
+constexpr size_t QOI_MAX_PIXELS = 400000000;
+// Longest chunk, and the bytes of a stream read into the window at a time
+constexpr size_t QOI_MAX_CHUNK_SIZE = 5;
+constexpr size_t QOI_WINDOW_SIZE = 64 << 10;
+
+// Bytes a stream is read in while it is collected for a decoder that needs the whole file
+constexpr size_t STREAM_READ_SIZE = 64 << 10;
+
+// Largest width or height, and header number, a PGM/PPM or Farbfeld raster may have
+constexpr size_t MAX_RASTER_SIDE = 0x7fffffff;
+
+// Formats with a streaming decoder, told apart by their first bytes
+enum StreamFormat {
+    FORMAT_PNM,
+    FORMAT_FARBFELD,
+    FORMAT_QOI,
+    FORMAT_OTHER
+};
+
+// Reads only as many bytes as it takes to tell the format of a stream: 2 for PGM/PPM,
+// 4 for QOI and 16 for Farbfeld, whose header ends there. All bytes read are left in `head`.
+static StreamFormat read_stream_format(FILE* stream, vector<uint8_t>& head) {
+    auto read_head = [&](size_t size) {
+        size_t read = head.size();
+        head.resize(size);
+        head.resize(read + fread(head.data() + read, 1, size - read, stream));
+        return head.size() == size;
+    };
+
+    if (!read_head(2)) {
+        return FORMAT_OTHER;
+    }
+    if (head[0] == 'P' && (head[1] == '5' || head[1] == '6')) {
+        return FORMAT_PNM;
+    }
+    if (!read_head(4)) {
+        return FORMAT_OTHER;
+    }
+    if (memcmp(head.data(), "qoif", 4) == 0) {
+        return FORMAT_QOI;
+    }
+    if (!read_head(16)) {
+        return FORMAT_OTHER;
+    }
+    return memcmp(head.data(), "farbfeld", 8) == 0 ? FORMAT_FARBFELD : FORMAT_OTHER;
+}
+
+// Streams are closed by the sources reading them, except for stdin
+static void close_stream(FILE* stream) {
+    if (stream && stream != stdin) {
+        fclose(stream);
+    }
+}
+
+static uint32_t read_big_endian_32(const uint8_t* bytes) {
+    return (static_cast<uint32_t>(bytes[0]) << 24) | (bytes[1] << 16) | (bytes[2] << 8) | bytes[3];
+}
+
+MappedFile::~MappedFile() {
+    if (!data) {
+        return;
+    }
+#ifdef _WIN32
+    UnmapViewOfFile(data);
+#else
+    munmap(const_cast<uint8_t*>(data), size);
+#endif
+}
+
+shared_ptr<const MappedFile> MappedFile::open(const string& file_path) {
+    shared_ptr<MappedFile> file(new MappedFile());
+
+#ifdef _WIN32
+    HANDLE handle = CreateFileA(file_path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (handle == INVALID_HANDLE_VALUE) {
+        return nullptr;
+    }
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(handle, &size) || size.QuadPart == 0 || GetFileType(handle) != FILE_TYPE_DISK) {
+        CloseHandle(handle);
+        return nullptr;
+    }
+
+    // The view keeps the mapping, and the mapping the file, open
+    HANDLE mapping = CreateFileMappingA(handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(handle);
+    if (!mapping) {
+        return nullptr;
+    }
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping);
+    if (!view) {
+        return nullptr;
+    }
+    file->size = static_cast<size_t>(size.QuadPart);
+#else
+    int descriptor = ::open(file_path.c_str(), O_RDONLY);
+    if (descriptor < 0) {
+        return nullptr;
+    }
+    struct stat status;
+    if (fstat(descriptor, &status) != 0 || !S_ISREG(status.st_mode) || status.st_size == 0) {
+        close(descriptor);
+        return nullptr;
+    }
+
+    // The mapping keeps the file open
+    void* view = mmap(nullptr, static_cast<size_t>(status.st_size), PROT_READ, MAP_PRIVATE, descriptor, 0);
+    close(descriptor);
+    if (view == MAP_FAILED) {
+        return nullptr;
+    }
+    file->size = static_cast<size_t>(status.st_size);
+
+    // Rows are mostly read front to back: have the system read ahead aggressively
+    madvise(view, file->size, MADV_SEQUENTIAL);
+#endif
+
+    file->data = static_cast<const uint8_t*>(view);
+    return file;
+}
+
+ImageRowSource::ImageRowSource(const ByteImage& image, int orientation) : image(image) {
+    width = image.width;
+    height = image.height;
+    channels = image.channels;
+    this->orientation = orientation;
+}
+
+const uint8_t* ImageRowSource::read_rows(size_t y, size_t count, uint8_t* buffer) {
+    (void)buffer;
+    if (y + count > height) {
+        return nullptr;
+    }
+    return image.row(y);
+}
+
+RawRowSource::~RawRowSource() {
+    close_stream(file);
+}
+
+// Reads the next whitespace-separated header number, skipping comments
+static bool read_pnm_number(FILE* file, size_t& value) {
+    int c = fgetc(file);
+    while (c != EOF && (isspace(c) || c == '#')) {
+        if (c == '#') {
+            while (c != EOF && c != '\n') {
+                c = fgetc(file);
+            }
+        }
+        c = fgetc(file);
+    }
+
+    if (c == EOF || !isdigit(c)) {
+        return false;
+    }
+
+    value = 0;
+    while (c != EOF && isdigit(c)) {
+        value = value * 10 + static_cast<size_t>(c - '0');
+        if (value > MAX_RASTER_SIDE) {
+            return false;
+        }
+        c = fgetc(file);
+    }
+
+    // Exactly one whitespace character separates the header from the raster
+    return c != EOF && isspace(c);
+}
+
+// Whether a raster of `pixel_bytes` per pixel has sides within MAX_RASTER_SIDE and a size that fits in size_t
+static bool is_raster_size_valid(size_t width, size_t height, size_t pixel_bytes) {
+    if (width == 0 || height == 0 || width > MAX_RASTER_SIDE || height > MAX_RASTER_SIDE) {
+        return false;
+    }
+    return width <= SIZE_MAX / pixel_bytes / height;
+}
+
+unique_ptr<RawRowSource> RawRowSource::open(FILE* stream, const vector<uint8_t>& head, const string& file_path) {
+    unique_ptr<RawRowSource> source(new RawRowSource());
+    source->file = stream;
+    FILE* file = stream;
+
+    if (head.size() == 2 && head[0] == 'P' && (head[1] == '5' || head[1] == '6')) {
+        size_t max_value;
+        if (!read_pnm_number(file, source->width) || !read_pnm_number(file, source->height) || !read_pnm_number(file, max_value)) {
+            return nullptr;
+        }
+        if (max_value == 0 || max_value > 65535) {
+            return nullptr;
+        }
+        source->channels = head[1] == '5' ? 1 : 3;
+        source->max_value = static_cast<unsigned>(max_value);
+    } else if (head.size() == 16 && memcmp(head.data(), "farbfeld", 8) == 0) {
+        // Big-endian 32-bit width and height, then 16-bit big-endian RGBA
+        source->width = read_big_endian_32(head.data() + 8);
+        source->height = read_big_endian_32(head.data() + 12);
+        source->channels = 4;
+        source->max_value = 65535;
+    } else {
+        return nullptr;
+    }
+    size_t raw_row_bytes = source->channels * (source->max_value > 255 ? 2 : 1);
+    if (!is_raster_size_valid(source->width, source->height, raw_row_bytes)) {
+        return nullptr;
+    }
+    raw_row_bytes *= source->width;
+
+    // Map the file if it holds the whole raster, otherwise keep reading the stream
+    shared_ptr<const MappedFile> mapping = file_path.empty() ? nullptr : MappedFile::open(file_path);
+    long raster_offset = mapping ? ftell(file) : -1;
+    if (raster_offset >= 0 && mapping->size >= static_cast<size_t>(raster_offset) && (mapping->size - raster_offset) / raw_row_bytes >= source->height) {
+        source->mapping = move(mapping);
+        source->raster_offset = static_cast<size_t>(raster_offset);
+        fclose(file);
+        source->file = nullptr;
+    }
+    return source;
+}
+
+// Rescales samples of other depths to 8 bits; samples above 255 are big-endian 16-bit
+static void rescale_samples(const uint8_t* raw, size_t samples, unsigned max_value, uint8_t* out) {
+    if (max_value == 65535) {
+        get_kernels(ISA_AUTO).narrow_row_u16be(out, raw, samples);
+    } else if (max_value > 255) {
+        for (size_t i = 0; i < samples; i++) {
+            unsigned value = (raw[2 * i] << 8) | raw[2 * i + 1];
+            out[i] = static_cast<uint8_t>((min(value, max_value) * 255 + max_value / 2) / max_value);
+        }
+    } else {
+        for (size_t i = 0; i < samples; i++) {
+            out[i] = static_cast<uint8_t>((min<unsigned>(raw[i], max_value) * 255 + max_value / 2) / max_value);
+        }
+    }
+}
+
+const uint8_t* RawRowSource::read_rows(size_t y, size_t count, uint8_t* buffer) {
+    if (y + count > height) {
+        return nullptr;
+    }
+
+    size_t raw_row_bytes = row_bytes() * (max_value > 255 ? 2 : 1);
+    if (mapping) {
+        // 8-bit rows are used in place
+        const uint8_t* raw = mapping->data + raster_offset + y * raw_row_bytes;
+        if (max_value == 255) {
+            return raw;
+        }
+        rescale_samples(raw, count * row_bytes(), max_value, buffer);
+        return buffer;
+    }
+
+    if (y != next_row) {
+        return nullptr;
+    }
+
+    size_t samples = count * row_bytes();
+    if (max_value == 255) {
+        if (fread(buffer, 1, samples, file) != samples) {
+            return nullptr;
+        }
+    } else {
+        vector<uint8_t> raw(raw_row_bytes);
+        for (size_t r = 0; r < count; r++) {
+            if (fread(raw.data(), 1, raw.size(), file) != raw.size()) {
+                return nullptr;
+            }
+            rescale_samples(raw.data(), row_bytes(), max_value, buffer + r * row_bytes());
+        }
+    }
+
+    next_row += count;
+    return buffer;
+}
+
+QoiRowSource::~QoiRowSource() {
+    close_stream(file);
+}
+
+unique_ptr<QoiRowSource> QoiRowSource::open(FILE* stream, const vector<uint8_t>& head, const string& file_path) {
+    unique_ptr<QoiRowSource> source(new QoiRowSource());
+    shared_ptr<const MappedFile> mapping = file_path.empty() ? nullptr : MappedFile::open(file_path);
+    if (mapping) {
+        // The end padding holds the last chunk's bytes
+        close_stream(stream);
+        if (mapping->size < QOI_HEADER_SIZE + QOI_PADDING) {
+            return nullptr;
+        }
+        source->mapping = move(mapping);
+        source->bytes = source->mapping->data;
+        source->end = source->mapping->size - QOI_PADDING;
+    } else {
+        // The window has a chunk's worth of slack past its end, so a truncated stream reads no further
+        source->file = stream;
+        source->window.assign(QOI_WINDOW_SIZE + QOI_MAX_CHUNK_SIZE, 0);
+        copy(head.begin(), head.end(), source->window.begin());
+        source->bytes = source->window.data();
+        source->filled = head.size();
+        size_t at = 0;
+        if (!source->refill(at) || source->filled < QOI_HEADER_SIZE) {
+            return nullptr;
+        }
+    }
+
+    const uint8_t* header = source->bytes;
+    if (memcmp(header, "qoif", 4) != 0) {
+        return nullptr;
+    }
+    source->width = read_big_endian_32(header + 4);
+    source->height = read_big_endian_32(header + 8);
+    source->channels = header[12];
+    if ((source->channels != 3 && source->channels != 4) || !is_raster_size_valid(source->width, source->height, source->channels) ||
+        source->width * source->height > QOI_MAX_PIXELS) {
+        return nullptr;
+    }
+
+    source->position = QOI_HEADER_SIZE;
+    source->pixel[3] = 255;
+    return source;
+}
+
+// Moves the undecoded bytes from `at` to the front of the window and reads the stream
+// behind them. Until the stream ends, chunks may only start where all of their bytes are in.
+bool QoiRowSource::refill(size_t& at) {
+    // A chunk of a truncated stream may have run into the slack
+    if (!file || at > filled) {
+        return false;
+    }
+
+    size_t kept = filled - at;
+    memmove(window.data(), window.data() + at, kept);
+    filled = kept + fread(window.data() + kept, 1, QOI_WINDOW_SIZE - kept, file);
+    at = 0;
+
+    bool ended = filled < QOI_WINDOW_SIZE;
+    end = ended ? filled : filled - (QOI_MAX_CHUNK_SIZE - 1);
+    return at < end;
+}
+
+// Decodes `pixels` pixels of Channels bytes each into `out`. The state is held in locals
+// while decoding: every store through `out` could otherwise alias it and force reloads.
+template <size_t Channels>
+bool QoiRowSource::decode(uint8_t* out, size_t pixels) {
+    const uint8_t* data = bytes;
+    size_t limit = end;
+    size_t at = position;
+    uint8_t r = pixel[0], g = pixel[1], b = pixel[2], a = pixel[3];
+
+    auto write = [&](size_t repeats) {
+        for (size_t k = 0; k < repeats; k++) {
+            out[0] = r;
+            out[1] = g;
+            out[2] = b;
+            if constexpr (Channels == 4) {
+                out[3] = a;
+            }
+            out += Channels;
+        }
+        pixels -= repeats;
+    };
+    auto remember = [&]() {
+        uint8_t* slot = index[(r * 3 + g * 5 + b * 7 + a * 11) % 64];
+        slot[0] = r;
+        slot[1] = g;
+        slot[2] = b;
+        slot[3] = a;
+    };
+
+    // Finish a run left over from the previous rows
+    size_t repeats = min(run, pixels);
+    write(repeats);
+    run -= repeats;
+
+    // Chunks never start at or past `end`, so none reads past the bytes that are loaded
+    while (pixels > 0) {
+        if (at >= limit) {
+            if (!refill(at)) {
+                return false;
+            }
+            limit = end;
+        }
+
+        uint8_t op = data[at++];
+        if (op == QOI_OP_RGB) {
+            r = data[at];
+            g = data[at + 1];
+            b = data[at + 2];
+            at += 3;
+        } else if (op == QOI_OP_RGBA) {
+            r = data[at];
+            g = data[at + 1];
+            b = data[at + 2];
+            a = data[at + 3];
+            at += 4;
+        } else {
+            switch (op >> 6) {
+                case 0:  // Index into previously seen pixels
+                    r = index[op][0];
+                    g = index[op][1];
+                    b = index[op][2];
+                    a = index[op][3];
+                    write(1);
+                    continue;
+                case 1:  // Small difference to the previous pixel
+                    r += ((op >> 4) & 3) - 2;
+                    g += ((op >> 2) & 3) - 2;
+                    b += (op & 3) - 2;
+                    break;
+                case 2: {  // Green difference, and red and blue relative to it
+                    int green = (op & 63) - 32;
+                    uint8_t next = data[at++];
+                    r += green - 8 + (next >> 4);
+                    g += green;
+                    b += green - 8 + (next & 15);
+                    break;
+                }
+                default: {  // Run of the previous pixel, possibly past these rows
+                    size_t length = (op & 63) + 1;
+                    repeats = min(length, pixels);
+                    remember();
+                    write(repeats);
+                    run = length - repeats;
+                    continue;
+                }
+            }
+        }
+        remember();
+        write(1);
+    }
+
+    position = at;
+    pixel[0] = r;
+    pixel[1] = g;
+    pixel[2] = b;
+    pixel[3] = a;
+    return true;
+}
+
+const uint8_t* QoiRowSource::read_rows(size_t y, size_t count, uint8_t* buffer) {
+    if (y != next_row || y + count > height) {
+        return nullptr;
+    }
+
+    bool decoded = channels == 4 ? decode<4>(buffer, count * width) : decode<3>(buffer, count * width);
+    if (!decoded) {
+        return nullptr;
+    }
+
+    next_row += count;
+    return buffer;
+}
+
+bool is_stdin_path(const string& file_path) {
+    return file_path == "-";
+}
+
+unique_ptr<RowSource> open_row_source(const string& file_path) {
+    bool from_stdin = is_stdin_path(file_path);
+    FILE* stream = from_stdin ? stdin : fopen(file_path.c_str(), "rb");
+    if (!stream) {
+        cerr << "Error: Failed to open '" << file_path << "'!" << endl;
+        return nullptr;
+    }
+#ifdef _WIN32
+    if (from_stdin) {
+        _setmode(_fileno(stdin), _O_BINARY);
+    }
+#endif
+
+    // Streaming decoders carry on from the bytes read to tell the format; files are also mapped
+    vector<uint8_t> head;
+    string mapped_path = from_stdin ? string() : file_path;
+    switch (read_stream_format(stream, head)) {
+        case FORMAT_PNM:
+        case FORMAT_FARBFELD:
+            return RawRowSource::open(stream, head, mapped_path);
+        case FORMAT_QOI:
+            return QoiRowSource::open(stream, head, mapped_path);
+        default:
+            break;
+    }
+
+    if (!from_stdin) {
+        close_stream(stream);
+        ByteImage image = load_byte_image(file_path);
+        if (image.empty()) {
+            return nullptr;
+        }
+        return unique_ptr<RowSource>(new ImageRowSource(image, read_jpeg_orientation(file_path)));
+    }
+
+    // Other formats are decoded from memory once the stream ends: collect it in a buffer that doubles as it fills
+    vector<uint8_t> bytes = move(head);
+    size_t size = bytes.size();
+    while (true) {
+        if (bytes.size() - size < STREAM_READ_SIZE) {
+            bytes.resize(max(2 * bytes.size(), size + STREAM_READ_SIZE));
+        }
+        size_t read = fread(bytes.data() + size, 1, bytes.size() - size, stdin);
+        if (read == 0) {
+            break;
+        }
+        size += read;
+    }
+
+    ByteImage image = load_byte_image_from_memory(bytes.data(), size);
+    if (image.empty()) {
+        cerr << "Error: Failed to decode image from stdin!" << endl;
+        return nullptr;
+    }
+    return unique_ptr<RowSource>(new ImageRowSource(image, read_jpeg_orientation(bytes.data(), size)));
+}
+
+FrameStream::~FrameStream() {
+    close_stream(file);
+}
+
+unique_ptr<FrameStream> FrameStream::open(const string& file_path) {
+    bool from_stdin = is_stdin_path(file_path);
+    unique_ptr<FrameStream> stream(new FrameStream());
+    stream->file = from_stdin ? stdin : fopen(file_path.c_str(), "rb");
+    if (!stream->file) {
+        cerr << "Error: Failed to open '" << file_path << "'!" << endl;
+        return nullptr;
+    }
+#ifdef _WIN32
+    if (from_stdin) {
+        _setmode(_fileno(stdin), _O_BINARY);
+    }
+#endif
+    return stream;
+}
+
+ByteImage FrameStream::read_frame() {
+    uint8_t magic[2];
+    size_t width, height, max_value;
+    if (fread(magic, 1, 2, file) != 2 || magic[0] != 'P' || (magic[1] != '5' && magic[1] != '6')) {
+        return ByteImage();
+    }
+    if (!read_pnm_number(file, width) || !read_pnm_number(file, height) || !read_pnm_number(file, max_value)) {
+        return ByteImage();
+    }
+    size_t channels = magic[1] == '5' ? 1 : 3;
+    if (max_value == 0 || max_value > 65535 || !is_raster_size_valid(width, height, channels * (max_value > 255 ? 2 : 1))) {
+        return ByteImage();
+    }
+
+    size_t samples = width * height * channels;
+    auto pixels = make_shared<vector<uint8_t>>(samples);
+    if (max_value == 255) {
+        if (fread(pixels->data(), 1, samples, file) != samples) {
+            return ByteImage();
+        }
+    } else {
+        vector<uint8_t> raw(samples * (max_value > 255 ? 2 : 1));
+        if (fread(raw.data(), 1, raw.size(), file) != raw.size()) {
+            return ByteImage();
+        }
+        rescale_samples(raw.data(), samples, static_cast<unsigned>(max_value), pixels->data());
+    }
+    return ByteImage(width, height, channels, pixels->data(), pixels);
+}
+
+ByteImage read_byte_image(unique_ptr<RowSource> source) {
+    if (!source) {
+        return ByteImage();
+    }
+
+    shared_ptr<RowSource> owner(move(source));
+    if (!owner->is_sequential()) {
+        const uint8_t* data = owner->read_rows(0, owner->height, nullptr);
+        return data ? ByteImage(owner->width, owner->height, owner->channels, data, owner) : ByteImage();
+    }
+
+    auto pixels = make_shared<vector<uint8_t>>(owner->height * owner->row_bytes());
+    if (!owner->read_rows(0, owner->height, pixels->data())) {
+        return ByteImage();
+    }
+    return ByteImage(owner->width, owner->height, owner->channels, pixels->data(), pixels);
+}
\ No newline at end of file
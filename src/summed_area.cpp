@@ -0,0 +1,67 @@
+#include <algorithm>
+#include <vector>
+
+#include "../include/kernels.hpp"
+#include "../include/summed_area.hpp"
+
+using namespace std;
+
+// Rows fetched per read from sequential sources
+constexpr size_t ROWS_PER_READ = 64;
+
+SummedAreaTable build_summed_area_table(RowSource& source, const AnalysisOptions& options) {
+    SummedAreaTable table;
+    table.width = source.width;
+    table.height = source.height;
+    table.channels = source.channels;
+    table.orientation = source.orientation;
+    size_t channels = source.channels;
+    size_t stride = (source.width + 1) * channels;
+    table.sums.assign((source.height + 1) * stride, 0);
+
+    vector<uint8_t> buffer(source.is_sequential() ? ROWS_PER_READ * source.row_bytes() : 0);
+    vector<uint32_t> row_sums(channels);
+
+    // Sums are linear in the pixels, so alpha is composited once here rather than per box
+    uint8_t background[MAX_CHANNELS];
+    get_background_pixel(options, channels, background);
+    vector<uint8_t> composited(has_alpha(channels) ? source.row_bytes() : 0);
+    const Kernels& kernels = get_kernels(options.isa);
+
+    // Value each 8-bit sample adds to the sums
+    table.linear_light = options.linear_light;
+    const uint16_t* linear_table = get_linear_table();
+    uint32_t values[256];
+    for (size_t i = 0; i < 256; i++) {
+        values[i] = options.linear_light ? linear_table[i] : static_cast<uint32_t>(i);
+    }
+
+    for (size_t y = 0; y < source.height; y += ROWS_PER_READ) {
+        size_t count = min(ROWS_PER_READ, source.height - y);
+        const uint8_t* rows = source.read_rows(y, count, buffer.data());
+        if (!rows) {
+            return SummedAreaTable();
+        }
+
+        for (size_t r = 0; r < count; r++) {
+            const uint8_t* pixels = rows + r * source.row_bytes();
+            if (has_alpha(channels)) {
+                kernels.composite_row_u8[channels / 2 - 1](composited.data(), pixels, source.width, background);
+                pixels = composited.data();
+            }
+            const uint32_t* above = &table.sums[(y + r) * stride];
+            uint32_t* sums = &table.sums[(y + r + 1) * stride];
+
+            // Running sum along the row plus the table row above
+            fill(row_sums.begin(), row_sums.end(), 0);
+            for (size_t x = 0; x < source.width; x++) {
+                for (size_t c = 0; c < channels; c++) {
+                    row_sums[c] += values[pixels[x * channels + c]];
+                    sums[(x + 1) * channels + c] = above[(x + 1) * channels + c] + row_sums[c];
+                }
+            }
+        }
+    }
+
+    return table;
+}
\ No newline at end of file
@@ -0,0 +1,386 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <csignal>
+#include <cstdio>
+#include <iostream>
+#include <list>
+#include <unordered_map>
+
+#ifndef _WIN32
+#include <sys/select.h>
+#include <termios.h>
+#include <unistd.h>
+#endif
+
+#include "../include/argparse.hpp"
+#include "../include/print_image.hpp"
+#include "../include/pyramid.hpp"
+#include "../include/viewer.hpp"
+
+using namespace std;
+
+// Cells per cached tile, and tiles kept (about 2.5 KB each)
+constexpr size_t TILE_WIDTH = 32;
+constexpr size_t TILE_HEIGHT = 16;
+constexpr size_t TILE_CACHE_CAPACITY = 1024;
+
+// Pyramid levels stay this many zoom steps finer than the cells, so each cell still
+// averages a 4-pixel-wide box of the level it is read from
+constexpr size_t LEVEL_OVERSAMPLING = 2;
+
+struct TileKey {
+    size_t zoom;
+    size_t level;
+    size_t x, y;
+
+    bool operator==(const TileKey& other) const { return zoom == other.zoom && level == other.level && x == other.x && y == other.y; }
+};
+
+struct TileKeyHash {
+    size_t operator()(const TileKey& key) const { return ((key.zoom * 64 + key.level) * 1000003 + key.x) * 1000003 + key.y; }
+};
+
+// Least recently used cache of rendered tiles
+class TileCache {
+   public:
+    explicit TileCache(size_t capacity) : capacity(capacity) {}
+
+    // Returns nullptr on a miss; a hit becomes the most recently used tile
+    const CellGrid* find(const TileKey& key) {
+        auto found = index.find(key);
+        if (found == index.end()) {
+            return nullptr;
+        }
+        entries.splice(entries.begin(), entries, found->second);
+        return &found->second->second;
+    }
+
+    const CellGrid& insert(const TileKey& key, CellGrid&& tile) {
+        if (entries.size() >= capacity) {
+            index.erase(entries.back().first);
+            entries.pop_back();
+        }
+        entries.emplace_front(key, move(tile));
+        index[key] = entries.begin();
+        return entries.front().second;
+    }
+
+   private:
+    size_t capacity;
+    list<pair<TileKey, CellGrid>> entries;  // Most recently used first
+    unordered_map<TileKey, list<pair<TileKey, CellGrid>>::iterator, TileKeyHash> index;
+};
+
+// Zoom step z shows 2^z full-resolution pixels per cell column
+struct ViewState {
+    size_t zoom;
+    size_t max_zoom;
+    double center_x, center_y;  // Full-resolution pixels
+};
+
+class Viewer {
+   public:
+    Viewer(const ByteImage& image, const AnalysisOptions& options, double character_ratio, FrameRecorder* recorder)
+        : image(image), options(options), character_ratio(character_ratio), recorder(recorder), pyramid(image, options.threads, options.linear_light), tiles(TILE_CACHE_CAPACITY) {}
+
+    // Fits the whole image in the terminal and centers it
+    void reset(size_t columns, size_t rows) {
+        this->columns = columns;
+        this->rows = rows > 1 ? rows - 1 : 1;
+
+        state.max_zoom = 0;
+        while ((image.width >> state.max_zoom) > this->columns || (image.height >> state.max_zoom) / character_ratio > this->rows) {
+            state.max_zoom++;
+        }
+        state.zoom = state.max_zoom;
+        state.center_x = image.width / 2.0;
+        state.center_y = image.height / 2.0;
+    }
+
+    void resize(size_t columns, size_t rows) {
+        ViewState previous = state;
+        reset(columns, rows);
+        state.zoom = min(previous.zoom, state.max_zoom);
+        state.center_x = previous.center_x;
+        state.center_y = previous.center_y;
+    }
+
+    // Moves by a quarter of the view in cells
+    void pan(int dx, int dy) {
+        double scale = static_cast<double>(size_t(1) << state.zoom);
+        state.center_x = clamp(state.center_x + dx * max(1.0, columns / 4.0) * scale, 0.0, static_cast<double>(image.width));
+        state.center_y = clamp(state.center_y + dy * max(1.0, rows / 4.0) * scale * character_ratio, 0.0, static_cast<double>(image.height));
+    }
+
+    void zoom(int steps) {
+        int zoom = static_cast<int>(state.zoom) + steps;
+        state.zoom = static_cast<size_t>(clamp(zoom, 0, static_cast<int>(state.max_zoom)));
+    }
+
+    // Whether a pyramid level finished since the last frame could sharpen it
+    bool wants_refresh() const { return drawn_level < wanted_level() && pyramid.levels_ready() > drawn_level + 1; }
+
+    void draw(bool clear) {
+        auto start = chrono::steady_clock::now();
+
+        // Cell size in pixels of the pyramid level the cells are read from
+        size_t level;
+        const ByteImage& source = pyramid.get_level(wanted_level(), level);
+        size_t cell_width = size_t(1) << (state.zoom - level);
+        size_t cell_height = max(static_cast<size_t>(1), static_cast<size_t>(lround(cell_width * character_ratio)));
+
+        // Lattice position of the top-left cell, keeping the view inside the image
+        size_t lattice_width = (source.width + cell_width - 1) / cell_width;
+        size_t lattice_height = (source.height + cell_height - 1) / cell_height;
+        double level_scale = static_cast<double>(size_t(1) << level);
+        size_t x0 = get_origin(state.center_x / level_scale / cell_width, lattice_width, columns);
+        size_t y0 = get_origin(state.center_y / level_scale / cell_height, lattice_height, rows);
+
+        CellGrid frame;
+        frame.width = min(columns, lattice_width);
+        frame.height = min(rows, lattice_height);
+        frame.has_edges = options.edge_threshold < 4.0;
+        frame.charset = options.charset;
+        frame.cells.resize(frame.width * frame.height);
+
+        // Copy each visible tile into the frame, rendering the ones not cached
+        for (size_t ty = y0 / TILE_HEIGHT; ty * TILE_HEIGHT < y0 + frame.height; ty++) {
+            for (size_t tx = x0 / TILE_WIDTH; tx * TILE_WIDTH < x0 + frame.width; tx++) {
+                TileKey key = {state.zoom, level, tx, ty};
+                const CellGrid* tile = tiles.find(key);
+                if (!tile) {
+                    CellWindow window;
+                    window.x = tx * TILE_WIDTH;
+                    window.y = ty * TILE_HEIGHT;
+                    window.width = TILE_WIDTH;
+                    window.height = TILE_HEIGHT;
+                    window.cell_width = cell_width;
+                    window.cell_height = cell_height;
+                    CellGrid cells = analyze_window(source, window, options);
+                    if (options.shape_matching) {
+                        match_shapes(source, window, options, cells);
+                    }
+                    tile = &tiles.insert(key, move(cells));
+                }
+
+                for (size_t j = 0; j < TILE_HEIGHT; j++) {
+                    size_t y = ty * TILE_HEIGHT + j;
+                    if (y < y0 || y >= y0 + frame.height) {
+                        continue;
+                    }
+                    for (size_t i = 0; i < TILE_WIDTH; i++) {
+                        size_t x = tx * TILE_WIDTH + i;
+                        if (x >= x0 && x < x0 + frame.width) {
+                            frame.cells[(y - y0) * frame.width + (x - x0)] = tile->at(i, j);
+                        }
+                    }
+                }
+            }
+        }
+        // Frames are dithered whole, so the pattern runs across tile borders
+        dither_cells(options, frame);
+        chrono::duration<double, milli> elapsed = chrono::steady_clock::now() - start;
+        drawn_level = level;
+
+        // A smaller frame would leave the previous one showing around it
+        clear = clear || frame.width != drawn_width || frame.height != drawn_height;
+        drawn_width = frame.width;
+        drawn_height = frame.height;
+
+        cout << (clear ? "\x1b[H\x1b[2J" : "\x1b[H");
+        print_image(frame);
+        if (recorder) {
+            recorder->resize(columns, rows + 1);
+            recorder->record_frame(frame);
+        }
+
+        // Status line in the last row
+        char status[160];
+        snprintf(status, sizeof(status), " 1:%zu  level %zu/%zu  %.1f ms  arrows/hjkl pan  +/- zoom  0 fit  q quit", size_t(1) << state.zoom, level, pyramid.levels() - 1,
+                 elapsed.count());
+        cout << "\x1b[" << rows + 1 << ";1H\x1b[7m" << string(status).substr(0, columns) << "\x1b[0m\x1b[K" << flush;
+    }
+
+   private:
+    const ByteImage& image;
+    AnalysisOptions options;
+    double character_ratio;
+    FrameRecorder* recorder;
+    Pyramid pyramid;
+    TileCache tiles;
+    ViewState state;
+    size_t columns = 0, rows = 0;
+    size_t drawn_level = 0;
+    size_t drawn_width = 0, drawn_height = 0;
+
+    size_t wanted_level() const { return min(state.zoom > LEVEL_OVERSAMPLING ? state.zoom - LEVEL_OVERSAMPLING : 0, pyramid.levels() - 1); }
+
+    // First visible cell of `count` around `center`, clamped to the lattice
+    static size_t get_origin(double center, size_t lattice_size, size_t count) {
+        if (lattice_size <= count) {
+            return 0;
+        }
+        double origin = center - count / 2.0;
+        return static_cast<size_t>(clamp(origin, 0.0, static_cast<double>(lattice_size - count)));
+    }
+};
+
+#ifdef _WIN32
+void run_viewer(const ByteImage& image, const AnalysisOptions& options, double character_ratio, FrameRecorder* recorder) {
+    cerr << "Warning: The viewer is not supported on Windows, rendering once" << endl;
+
+    size_t columns = 80, rows = 25;
+    try_get_terminal_size(columns, rows);
+    Viewer viewer(image, options, character_ratio, recorder);
+    viewer.reset(columns, rows);
+    viewer.draw(false);
+    cout << endl;
+}
+#else
+static volatile sig_atomic_t resize_pending = 0;
+static volatile sig_atomic_t quit_requested = 0;
+
+static void on_resize(int) {
+    resize_pending = 1;
+}
+
+static void on_quit(int) {
+    quit_requested = 1;
+}
+
+// Puts stdin in unbuffered no-echo mode and the output on the alternate screen,
+// restoring both on scope exit
+class RawTerminal {
+   public:
+    RawTerminal() {
+        tcgetattr(STDIN_FILENO, &saved);
+        termios raw = saved;
+        raw.c_lflag &= ~(ICANON | ECHO);
+        raw.c_cc[VMIN] = 1;
+        raw.c_cc[VTIME] = 0;
+        tcsetattr(STDIN_FILENO, TCSANOW, &raw);
+        cout << "\x1b[?1049h\x1b[?25l" << flush;
+    }
+
+    ~RawTerminal() {
+        cout << "\x1b[0m\x1b[?25h\x1b[?1049l" << flush;
+        tcsetattr(STDIN_FILENO, TCSANOW, &saved);
+    }
+
+   private:
+    termios saved;
+};
+
+void run_viewer(const ByteImage& image, const AnalysisOptions& options, double character_ratio, FrameRecorder* recorder) {
+    size_t columns, rows;
+    if (!try_get_terminal_size(columns, rows)) {
+        cerr << "Error: The viewer needs a terminal" << endl;
+        return;
+    }
+
+    // Once stdin has delivered the image, keys come from the terminal itself
+    if (!isatty(STDIN_FILENO) && !freopen("/dev/tty", "r", stdin)) {
+        cerr << "Error: The viewer needs a terminal to read keys from" << endl;
+        return;
+    }
+
+    // Signals are only delivered inside pselect, so none is lost between checks
+    sigset_t watched, previous;
+    sigemptyset(&watched);
+    sigaddset(&watched, SIGWINCH);
+    sigaddset(&watched, SIGINT);
+    sigaddset(&watched, SIGTERM);
+    sigprocmask(SIG_BLOCK, &watched, &previous);
+
+    struct sigaction action = {};
+    action.sa_handler = on_resize;
+    sigaction(SIGWINCH, &action, nullptr);
+    action.sa_handler = on_quit;
+    sigaction(SIGINT, &action, nullptr);
+    sigaction(SIGTERM, &action, nullptr);
+
+    {
+        Viewer viewer(image, options, character_ratio, recorder);
+        viewer.reset(columns, rows);
+        RawTerminal terminal;
+        viewer.draw(true);
+
+        while (!quit_requested) {
+            // Poll while the pyramid is still building, to sharpen the view as levels land
+            fd_set inputs;
+            FD_ZERO(&inputs);
+            FD_SET(STDIN_FILENO, &inputs);
+            timespec timeout = {0, 100000000};
+            int ready = pselect(STDIN_FILENO + 1, &inputs, nullptr, nullptr, &timeout, &previous);
+
+            bool redraw = false, clear = false;
+            if (resize_pending) {
+                resize_pending = 0;
+                if (try_get_terminal_size(columns, rows)) {
+                    viewer.resize(columns, rows);
+                    redraw = clear = true;
+                }
+            }
+
+            if (ready > 0) {
+                // Handle every key that arrived, then draw once
+                char keys[64];
+                ssize_t count = read(STDIN_FILENO, keys, sizeof(keys));
+                if (count <= 0) {
+                    break;
+                }
+
+                for (ssize_t k = 0; k < count; k++) {
+                    char key = keys[k];
+                    if (key == '\x1b' && k + 2 < count && keys[k + 1] == '[') {
+                        // Arrow keys: ESC [ A-D
+                        key = "kjlh"[clamp(keys[k + 2] - 'A', 0, 3)];
+                        k += 2;
+                    }
+
+                    switch (key) {
+                        case 'h':
+                        case 'a':
+                            viewer.pan(-1, 0);
+                            break;
+                        case 'l':
+                        case 'd':
+                            viewer.pan(1, 0);
+                            break;
+                        case 'k':
+                        case 'w':
+                            viewer.pan(0, -1);
+                            break;
+                        case 'j':
+                        case 's':
+                            viewer.pan(0, 1);
+                            break;
+                        case '+':
+                        case '=':
+                            viewer.zoom(-1);
+                            break;
+                        case '-':
+                        case '_':
+                            viewer.zoom(1);
+                            break;
+                        case '0':
+                            viewer.reset(columns, rows);
+                            break;
+                        case 'q':
+                            quit_requested = 1;
+                            break;
+                    }
+                }
+                redraw = true;
+            }
+
+            if (!quit_requested && (redraw || viewer.wants_refresh())) {
+                viewer.draw(clear);
+            }
+        }
+    }
+
+    sigprocmask(SIG_SETMASK, &previous, nullptr);
+}
+#endif
\ No newline at end of file